@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -129,7 +130,44 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // the parser has no INCLUDE clause, so included columns are given as an option: WITH (include = 'v, w')
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols;
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      if (strcmp(option->defname, "include") != 0) {
+        throw NotImplementedException(fmt::format("index option {} is not supported", option->defname));
+      }
+      if (option->arg == nullptr || option->arg->type != duckdb_libpgquery::T_PGString) {
+        throw bustub::Exception("include expects a string of column names");
+      }
+      auto names = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str;
+      for (const auto &name : StringUtil::Split(StringUtil::Strip(names, ' '), ',')) {
+        auto column_ref = ResolveColumn(*table, std::vector{name});
+        include_cols.emplace_back(std::make_unique<BoundColumnRef>(dynamic_cast<const BoundColumnRef &>(*column_ref)));
+      }
+    }
+  }
+
+  // USING HASH builds a hash index and USING ART an in-memory radix tree; without a USING clause the parser reports its
+  // default method "btree"
+  auto index_type = IndexType::BPlusTreeIndex;
+  if (stmt->accessMethod != nullptr) {
+    auto method = StringUtil::Lower(stmt->accessMethod);
+    if (method == "hash") {
+      index_type = IndexType::HashTableIndex;
+    } else if (method == "art") {
+      index_type = IndexType::ArtIndex;
+    } else if (method != "btree") {
+      throw NotImplementedException(fmt::format("index method {} is not supported", method));
+    }
+  }
+  if (index_type == IndexType::HashTableIndex && !include_cols.empty()) {
+    throw NotImplementedException("hash indexes cannot store included columns");
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), stmt->unique,
+                                          std::move(include_cols), index_type);
 }
 
 }  // namespace bustub
@@ -46,36 +46,24 @@ BufferPoolManagerInstance::~BufferPoolManagerInstance() {
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
   std::scoped_lock<std::mutex> locker(latch_);
 
-  if (!free_list_.empty()) {
-    auto frame_id = free_list_.front();
-    *page_id = AllocatePage();
-    page_table_->Insert(*page_id, frame_id);
-    free_list_.pop_front();
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-    pages_[frame_id].pin_count_++;
-    pages_[frame_id].page_id_ = *page_id;
-    return &pages_[frame_id];
-  }
-
   frame_id_t frame_id;
-  if (!replacer_->Evict(&frame_id)) {
+  if (!AcquireFrame(&frame_id)) {
     *page_id = INVALID_PAGE_ID;
     return nullptr;
   }
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-  }
-  auto remove_page_id = pages_[frame_id].GetPageId();
-  page_table_->Remove(remove_page_id);
   *page_id = AllocatePage();
-  pages_[frame_id].page_id_ = *page_id;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_++;
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  page_table_->Insert(*page_id, frame_id);
-  return &pages_[frame_id];
+  return PinNewPage(frame_id, *page_id);
+}
+
+auto BufferPoolManagerInstance::NewPgInExtentImp(page_id_t page_id) -> Page * {
+  std::scoped_lock<std::mutex> locker(latch_);
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID && page_id < next_page_id_, "Page id was not reserved!");
+
+  frame_id_t frame_id;
+  if (!AcquireFrame(&frame_id)) {
+    return nullptr;
+  }
+  return PinNewPage(frame_id, page_id);
 }
 
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
@@ -89,18 +77,8 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
     return pages_ + frame_id;
   }
 
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (!replacer_->Evict(&frame_id)) {
-      return nullptr;
-    }
-    if (pages_[frame_id].IsDirty()) {
-      // LOG_INFO("#page %d data=%s", pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-    }
-    page_table_->Remove(pages_[frame_id].GetPageId());
+  if (!AcquireFrame(&frame_id)) {
+    return nullptr;
   }
 
   pages_[frame_id].page_id_ = page_id;
@@ -169,10 +147,7 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
       return false;
     }
 
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-    }
-
+    // the page is gone, so its unwritten changes are dropped instead of flushed
     page_table_->Remove(page_id);
     replacer_->Remove(frame_id);
 
@@ -190,4 +165,38 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
 
 auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
 
+auto BufferPoolManagerInstance::AllocateExtentImp(size_t num_pages, IOObject owner) -> page_id_t {
+  auto first_page_id = next_page_id_.fetch_add(static_cast<page_id_t>(num_pages));
+  disk_manager_->RegisterExtent(first_page_id, num_pages, owner);
+  return first_page_id;
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id) -> bool {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+
+  if (!replacer_->Evict(frame_id)) {
+    return false;
+  }
+  if (pages_[*frame_id].IsDirty()) {
+    disk_manager_->WritePage(pages_[*frame_id].GetPageId(), pages_[*frame_id].GetData());
+  }
+  page_table_->Remove(pages_[*frame_id].GetPageId());
+  return true;
+}
+
+auto BufferPoolManagerInstance::PinNewPage(frame_id_t frame_id, page_id_t page_id) -> Page * {
+  pages_[frame_id].ResetMemory();
+  pages_[frame_id].page_id_ = page_id;
+  pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].pin_count_ = 1;
+  replacer_->RecordAccess(frame_id);
+  replacer_->SetEvictable(frame_id, false);
+  page_table_->Insert(page_id, frame_id);
+  return pages_ + frame_id;
+}
+
 }  // namespace bustub
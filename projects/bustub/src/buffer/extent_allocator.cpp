@@ -0,0 +1,38 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.cpp
+//
+// Identification: src/buffer/extent_allocator.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/extent_allocator.h"
+
+namespace bustub {
+
+ExtentAllocator::ExtentAllocator(BufferPoolManager *buffer_pool_manager, size_t extent_size, IOObject owner)
+    : buffer_pool_manager_(buffer_pool_manager), extent_size_(extent_size), owner_(owner) {}
+
+auto ExtentAllocator::NewPage(page_id_t *page_id) -> Page * {
+  std::scoped_lock<std::mutex> locker(latch_);
+
+  if (next_page_id_ == extent_end_) {
+    next_page_id_ = buffer_pool_manager_->AllocateExtent(extent_size_, owner_);
+    extent_end_ = next_page_id_ + static_cast<page_id_t>(extent_size_);
+  }
+
+  auto *page = buffer_pool_manager_->NewPageInExtent(next_page_id_);
+  if (page == nullptr) {
+    // keep the id for the next attempt
+    *page_id = INVALID_PAGE_ID;
+    return nullptr;
+  }
+  *page_id = next_page_id_++;
+  return page;
+}
+
+}  // namespace bustub
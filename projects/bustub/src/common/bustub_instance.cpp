@@ -2,6 +2,8 @@
 #include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
@@ -41,6 +43,15 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
+void BustubInstance::ReserveHeaderPage() {
+  // Page 0 is the header page in which B+ tree indexes record their root page ids; keep table heaps off it.
+  if (buffer_pool_manager_ != nullptr) {
+    page_id_t header_page_id;
+    buffer_pool_manager_->NewPage(&header_page_id);
+    buffer_pool_manager_->UnpinPage(header_page_id, true);
+  }
+}
+
 BustubInstance::BustubInstance(const std::string &db_file_name) {
   enable_logging = false;
 
@@ -59,6 +70,8 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
     buffer_pool_manager_ = nullptr;
   }
 
+  ReserveHeaderPage();
+
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
   txn_manager_ = new TransactionManager(lock_manager_, log_manager_);
@@ -91,6 +104,8 @@ BustubInstance::BustubInstance() {
     buffer_pool_manager_ = nullptr;
   }
 
+  ReserveHeaderPage();
+
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
   txn_manager_ = new TransactionManager(lock_manager_, log_manager_);
@@ -132,20 +147,89 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.WriteHeaderCell("index_oid");
   writer.WriteHeaderCell("index_name");
   writer.WriteHeaderCell("index_cols");
+  writer.WriteHeaderCell("index_type");
+  writer.WriteHeaderCell("height");
+  writer.WriteHeaderCell("pages_per_level");
+  writer.WriteHeaderCell("entries");
+  writer.WriteHeaderCell("fill_factor");
+  writer.WriteHeaderCell("keys_per_leaf");
+  writer.WriteHeaderCell("splits");
+  writer.WriteHeaderCell("merges");
+  writer.WriteHeaderCell("redistributions");
   writer.EndHeader();
   for (const auto &table_name : table_names) {
     for (const auto *index_info : catalog_->GetTableIndexes(table_name)) {
+      auto stats = index_info->index_->GetStats();
       writer.BeginRow();
       writer.WriteCell(table_name);
       writer.WriteCell(fmt::format("{}", index_info->index_oid_));
       writer.WriteCell(index_info->name_);
       writer.WriteCell(index_info->key_schema_.ToString());
+      writer.WriteCell(IndexTypeToString(index_info->index_type_));
+      // cells of statistics an index does not keep, or that do not apply to it, stay empty
+      bool is_paged = stats.has_value() && stats->is_paged_;
+      writer.WriteCell(is_paged ? fmt::format("{}", stats->height_) : "");
+      // page counts from the root down to the leaves
+      writer.WriteCell(is_paged ? fmt::format("{}", fmt::join(stats->pages_per_level_, "/")) : "");
+      writer.WriteCell(stats.has_value() ? fmt::format("{}", stats->num_entries_) : "");
+      writer.WriteCell(is_paged ? fmt::format("{:.2f}", stats->fill_factor_) : "");
+      writer.WriteCell(is_paged ? fmt::format("{:.1f}", stats->keys_per_leaf_) : "");
+      writer.WriteCell(is_paged ? fmt::format("{}", stats->num_splits_) : "");
+      writer.WriteCell(is_paged ? fmt::format("{}", stats->num_merges_) : "");
+      writer.WriteCell(is_paged ? fmt::format("{}", stats->num_redistributions_) : "");
       writer.EndRow();
     }
   }
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayIOStats(ResultWriter &writer) {
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("type");
+  writer.WriteHeaderCell("oid");
+  writer.WriteHeaderCell("name");
+  writer.WriteHeaderCell("reads");
+  writer.WriteHeaderCell("writes");
+  writer.WriteHeaderCell("bytes_read");
+  writer.WriteHeaderCell("bytes_written");
+  writer.WriteHeaderCell("p50_us");
+  writer.WriteHeaderCell("p99_us");
+  writer.WriteHeaderCell("latency_histogram");
+  writer.EndHeader();
+  for (const auto &[object, stats] : disk_manager_->GetIOStats()) {
+    std::string name;
+    if (object.type_ == IOObjectType::TABLE) {
+      const auto *table_info = catalog_->GetTable(object.oid_);
+      name = table_info == Catalog::NULL_TABLE_INFO ? "" : table_info->name_;
+    } else if (object.type_ == IOObjectType::INDEX) {
+      const auto *index_info = catalog_->GetIndex(object.oid_);
+      name = index_info == Catalog::NULL_INDEX_INFO ? "" : index_info->name_;
+    }
+    // non-empty buckets only, each one labelled with its exclusive upper bound
+    std::vector<std::string> buckets;
+    for (size_t i = 0; i < IOStats::NUM_LATENCY_BUCKETS; i++) {
+      if (stats.latency_histogram_[i] != 0) {
+        buckets.push_back(fmt::format("<{}us:{}", uint64_t{1} << (i + 1), stats.latency_histogram_[i]));
+      }
+    }
+    bool has_oid = object.type_ == IOObjectType::TABLE || object.type_ == IOObjectType::INDEX;
+    writer.BeginRow();
+    writer.WriteCell(object.TypeName());
+    writer.WriteCell(has_oid ? fmt::format("{}", object.oid_) : "");
+    writer.WriteCell(name);
+    writer.WriteCell(fmt::format("{}", stats.reads_));
+    writer.WriteCell(fmt::format("{}", stats.writes_));
+    writer.WriteCell(fmt::format("{}", stats.bytes_read_));
+    writer.WriteCell(fmt::format("{}", stats.bytes_written_));
+    writer.WriteCell(fmt::format("{}", stats.LatencyPercentile(0.5)));
+    writer.WriteCell(fmt::format("{}", stats.LatencyPercentile(0.99)));
+    writer.WriteCell(fmt::format("{}", fmt::join(buckets, " ")));
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -158,7 +242,8 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
   std::string help = R"(Welcome to the BusTub shell!
 
 \dt: show all tables
-\di: show all indices
+\di: show all indices with their structure statistics
+\io: show disk I/O per table, index, log and temporary pages
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -191,6 +276,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\io") {
+      CmdDisplayIOStats(writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
@@ -225,22 +314,65 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         const auto &index_stmt = dynamic_cast<const IndexStatement &>(*statement);
 
         std::vector<uint32_t> col_ids;
+        size_t key_size = 0;
         for (const auto &col : index_stmt.cols_) {
           auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
           col_ids.push_back(idx);
-          if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-            throw NotImplementedException("only support creating index on integer column");
-          }
-        }
-        if (col_ids.size() != 1) {
-          throw NotImplementedException("only support creating index with exactly one column");
+          key_size += GenericKeyColumnSize(index_stmt.table_->schema_.GetColumn(idx));
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
+        std::vector<uint32_t> include_ids;
+        size_t payload_size = 0;
+        for (const auto &col : index_stmt.include_cols_) {
+          auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
+          include_ids.push_back(idx);
+          payload_size += GenericKeyColumnSize(index_stmt.table_->schema_.GetColumn(idx));
+        }
+
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-            txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+        IndexInfo *info;
+        bool integer_key = col_ids.size() == 1 && key_schema.GetColumn(0).GetType() == TypeId::INTEGER;
+        // a hash index keeps the duplicates of a key itself, so its keys never hold a RID
+        bool key_only = index_stmt.is_unique_ || index_stmt.index_type_ == IndexType::HashTableIndex;
+        if (integer_key && include_ids.empty() && key_only) {
+          info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+              txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
+              INTEGER_SIZE, IntegerHashFunctionType{}, index_stmt.is_unique_, {}, index_stmt.index_type_);
+        } else if (integer_key && include_ids.empty()) {
+          // the key also holds the RID of each entry, so that duplicate values can be indexed
+          info = catalog_->CreateIndex<NonUniqueIntegerKeyType, IntegerValueType, NonUniqueIntegerComparatorType>(
+              txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
+              NON_UNIQUE_INTEGER_SIZE, NonUniqueIntegerHashFunctionType{}, false, {}, index_stmt.index_type_);
+        } else {
+          // varchar and composite keys, and keys followed by included columns: pick the smallest key that has room for
+          // all of them. Keys from 32 bytes up are prefix-compressed in their pages, so short values in a wide key cost
+          // little more than their own bytes
+          auto create_index = [&](auto key_size) {
+            using KeyType = GenericKey<decltype(key_size)::value>;
+            return catalog_->CreateIndex<KeyType, RID, GenericComparator<decltype(key_size)::value>>(
+                txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
+                decltype(key_size)::value, HashFunction<KeyType>{}, index_stmt.is_unique_, include_ids,
+                index_stmt.index_type_);
+          };
+          size_t entry_size = key_size + (key_only ? 0 : GenericKey<16>::RID_SIZE) + payload_size;
+          if (entry_size <= 8) {
+            info = create_index(std::integral_constant<size_t, 8>{});
+          } else if (entry_size <= 16) {
+            info = create_index(std::integral_constant<size_t, 16>{});
+          } else if (entry_size <= 32) {
+            info = create_index(std::integral_constant<size_t, 32>{});
+          } else if (entry_size <= 64) {
+            info = create_index(std::integral_constant<size_t, 64>{});
+          } else if (entry_size <= 128) {
+            info = create_index(std::integral_constant<size_t, 128>{});
+          } else if (entry_size <= INDEX_KEY_MAX_SIZE) {
+            info = create_index(std::integral_constant<size_t, INDEX_KEY_MAX_SIZE>{});
+          } else {
+            throw NotImplementedException(
+                fmt::format("index entries of {} bytes exceed the {} byte limit", entry_size, INDEX_KEY_MAX_SIZE));
+          }
+        }
         l.unlock();
 
         if (info == nullptr) {
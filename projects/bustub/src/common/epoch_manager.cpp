@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.cpp
+//
+// Identification: src/common/epoch_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/epoch_manager.h"
+
+#include <utility>
+
+namespace bustub {
+
+namespace {
+// Threads take reader slots round robin, so that few of them share one
+std::atomic<size_t> next_reader_slot{0};
+}  // namespace
+
+auto EpochManager::Enter() -> Guard {
+  thread_local size_t slot = next_reader_slot.fetch_add(1);
+  ReaderSlot &reader_slot = slots_[slot % NUM_READER_SLOTS];
+  while (true) {
+    uint64_t epoch = epoch_.load();
+    std::atomic<uint64_t> &counter = reader_slot.active_[epoch % 2];
+    counter.fetch_add(1);
+    // A reader counted under an epoch that has already moved on could be missed by the writer that moved it
+    if (epoch_.load() == epoch) {
+      return Guard(&counter);
+    }
+    counter.fetch_sub(1);
+  }
+}
+
+void EpochManager::Retire(std::shared_ptr<const void> object) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  retired_[epoch_.load() % 2].push_back(std::move(object));
+  TryAdvance();
+}
+
+auto EpochManager::NumRetired() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return retired_[0].size() + retired_[1].size();
+}
+
+void EpochManager::TryAdvance() {
+  // Readers that entered the previous epoch may have reached what was retired in it. Readers that entered the
+  // current epoch started after those objects were unlinked
+  uint64_t epoch = epoch_.load();
+  size_t previous = (epoch + 1) % 2;
+  for (const auto &reader_slot : slots_) {
+    if (reader_slot.active_[previous].load() != 0) {
+      return;
+    }
+  }
+  retired_[previous].clear();
+  epoch_.store(epoch + 1);
+}
+
+}  // namespace bustub
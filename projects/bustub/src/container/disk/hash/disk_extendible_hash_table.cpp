@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,9 +26,23 @@ namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                         const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+                                         const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                                         IOObject io_owner)
+    : buffer_pool_manager_(buffer_pool_manager),
+      extent_allocator_(buffer_pool_manager, EXTENT_SIZE, io_owner),
+      comparator_(comparator),
+      hash_fn_(std::move(hash_fn)) {
+  /* 初始时全局深度为0，目录只有一个槽位，指向唯一的一个空桶 */
+  auto dir_page = reinterpret_cast<HashTableDirectoryPage *>(extent_allocator_.NewPage(&directory_page_id_)->GetData());
+  dir_page->SetPageId(directory_page_id_);
+  page_id_t bucket_page_id;
+  auto bucket_page =
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(extent_allocator_.NewPage(&bucket_page_id)->GetData());
+  bucket_page->SetOverflowPageId(INVALID_PAGE_ID);
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 }
 
 /*****************************************************************************
@@ -46,22 +62,147 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+}
+
+/*****************************************************************************
+ * OVERFLOW CHAINS
+ *****************************************************************************/
+/* 溢出页只由桶页上的锁保护：调用者持有桶页的锁，或者独占了整个表 */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainGetValue(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key,
+                                    std::vector<ValueType> *result) -> bool {
+  bool found = bucket_page->GetValue(key, comparator_, result);
+  for (page_id_t page_id = bucket_page->GetOverflowPageId(); page_id != INVALID_PAGE_ID;) {
+    HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(page_id);
+    found = overflow_page->GetValue(key, comparator_, result) || found;
+    page_id_t next_page_id = overflow_page->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainInsert(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, const ValueType &value,
+                                  bool *full) -> bool {
+  *full = false;
+  if (bucket_page->GetOverflowPageId() == INVALID_PAGE_ID && !bucket_page->IsFull()) {
+    return bucket_page->Insert(key, value, comparator_);
+  }
+  /* 桶页满了或者有溢出页时，键值对可能在链上任何一页，先查重再找有空位的页 */
+  std::vector<ValueType> values;
+  ChainGetValue(bucket_page, key, &values);
+  if (std::find(values.begin(), values.end(), value) != values.end()) {
+    return false;
+  }
+  if (bucket_page->Insert(key, value, comparator_)) {
+    return true;
+  }
+  for (page_id_t page_id = bucket_page->GetOverflowPageId(); page_id != INVALID_PAGE_ID;) {
+    HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(page_id);
+    bool inserted = overflow_page->Insert(key, value, comparator_);
+    page_id_t next_page_id = overflow_page->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      return true;
+    }
+    page_id = next_page_id;
+  }
+  *full = true;
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::AppendToChain(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, const ValueType &value) {
+  /* 键值对已知不重复，所以页面的Insert失败只可能是页满了 */
+  HASH_TABLE_BUCKET_TYPE *page = bucket_page;
+  page_id_t page_id = INVALID_PAGE_ID;
+  while (!page->Insert(key, value, comparator_)) {
+    page_id_t next_page_id = page->GetOverflowPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      auto overflow_page =
+          reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(extent_allocator_.NewPage(&next_page_id)->GetData());
+      overflow_page->SetOverflowPageId(INVALID_PAGE_ID);
+      page->SetOverflowPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(next_page_id, true);
+    }
+    if (page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    page_id = next_page_id;
+    page = FetchBucketPage(page_id);
+  }
+  if (page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainHasSingleKey(HASH_TABLE_BUCKET_TYPE *bucket_page) -> bool {
+  std::optional<KeyType> first_key;
+  auto same_key = [&](HASH_TABLE_BUCKET_TYPE *page) {
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && page->IsOccupied(i); i++) {
+      if (!page->IsReadable(i)) {
+        continue;
+      }
+      if (!first_key.has_value()) {
+        first_key = page->KeyAt(i);
+      } else if (comparator_(*first_key, page->KeyAt(i)) != 0) {
+        return false;
+      }
+    }
+    return true;
+  };
+  bool single_key = same_key(bucket_page);
+  for (page_id_t page_id = bucket_page->GetOverflowPageId(); single_key && page_id != INVALID_PAGE_ID;) {
+    HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(page_id);
+    single_key = same_key(overflow_page);
+    page_id_t next_page_id = overflow_page->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return single_key;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DropEmptyOverflowPages(HASH_TABLE_BUCKET_TYPE *bucket_page) {
+  HASH_TABLE_BUCKET_TYPE *prev_page = bucket_page;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (page_id_t page_id = bucket_page->GetOverflowPageId(); page_id != INVALID_PAGE_ID;) {
+    HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(page_id);
+    page_id_t next_page_id = overflow_page->GetOverflowPageId();
+    if (overflow_page->IsEmpty()) {
+      prev_page->SetOverflowPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    } else {
+      if (prev_page_id != INVALID_PAGE_ID) {
+        buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      }
+      prev_page = overflow_page;
+      prev_page_id = page_id;
+    }
+    page_id = next_page_id;
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  }
 }
 
 /*****************************************************************************
@@ -69,7 +210,19 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  /* 点查询只访问目录页和一个桶页：目录加共享锁，桶页加读锁 */
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->RLatch();
+  auto bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool found = ChainGetValue(bucket_page, key, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +230,93 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  /* 目录加共享锁，只对key所在的桶页加写锁，不同桶上的插入可以并行 */
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool full;
+  bool inserted = ChainInsert(bucket_page, key, value, &full);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  /* 桶满时放开共享锁，在独占目录的情况下分裂后再插入 */
+  if (full) {
+    inserted = SplitInsert(transaction, key, value);
+  }
+  return inserted;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  /* 独占目录，其他操作都被挡在外面，桶页无需再加锁。放开共享锁期间别的线程可能已经分裂过这个桶，所以先重新检查。
+   * 一次分裂可能把所有条目都留在原桶里，所以循环分裂直到key所在的桶有空位 */
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+    bool full;
+    bool inserted = ChainInsert(bucket_page, key, value, &full);
+    if (!full) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+      table_latch_.WUnlock();
+      return inserted;
+    }
+
+    /* 条目全是同一个key时分裂分不开它们，目录已经占满一个页面时无法再翻倍：这两种情况都给桶挂溢出页 */
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    bool directory_full = local_depth == dir_page->GetGlobalDepth() && dir_page->Size() * 2 > DIRECTORY_ARRAY_SIZE;
+    if (directory_full || ChainHasSingleKey(bucket_page)) {
+      AppendToChain(bucket_page, key, value);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+      table_latch_.WUnlock();
+      return true;
+    }
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+
+    /* 哈希值第local_depth位为1的条目和目录槽位移到新桶，溢出链上的条目也一样 */
+    page_id_t image_page_id;
+    auto image_page =
+        reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(extent_allocator_.NewPage(&image_page_id)->GetData());
+    image_page->SetOverflowPageId(INVALID_PAGE_ID);
+    uint32_t high_bit = 1U << local_depth;
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      if (dir_page->GetBucketPageId(i) == bucket_page_id) {
+        dir_page->IncrLocalDepth(i);
+        if ((i & high_bit) != 0) {
+          dir_page->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    auto move_entries = [&](HASH_TABLE_BUCKET_TYPE *page) {
+      for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && page->IsOccupied(i); i++) {
+        if (page->IsReadable(i) && (Hash(page->KeyAt(i)) & high_bit) != 0) {
+          AppendToChain(image_page, page->KeyAt(i), page->ValueAt(i));
+          page->RemoveAt(i);
+        }
+      }
+    };
+    move_entries(bucket_page);
+    for (page_id_t page_id = bucket_page->GetOverflowPageId(); page_id != INVALID_PAGE_ID;) {
+      HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(page_id);
+      move_entries(overflow_page);
+      page_id_t next_page_id = overflow_page->GetOverflowPageId();
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      page_id = next_page_id;
+    }
+    DropEmptyOverflowPages(bucket_page);
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
 }
 
 /*****************************************************************************
@@ -90,14 +324,75 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = bucket_page->Remove(key, value, comparator_);
+  /* 不在桶页上就到溢出链上找，删空的溢出页随即摘掉 */
+  for (page_id_t page_id = bucket_page->GetOverflowPageId(); !removed && page_id != INVALID_PAGE_ID;) {
+    HASH_TABLE_BUCKET_TYPE *overflow_page = FetchBucketPage(page_id);
+    removed = overflow_page->Remove(key, value, comparator_);
+    page_id_t next_page_id = overflow_page->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, removed);
+    if (removed) {
+      DropEmptyOverflowPages(bucket_page);
+    }
+    page_id = next_page_id;
+  }
+  bool empty = bucket_page->IsEmpty() && bucket_page->GetOverflowPageId() == INVALID_PAGE_ID;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  if (removed && empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  /* 独占目录后重新检查桶是否为空，期间可能有插入。合并后的桶可能也是空的，可以继续和它的分裂镜像合并 */
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+    bool empty = bucket_page->IsEmpty() && bucket_page->GetOverflowPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (!empty || local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+
+    /* 指向空桶和分裂镜像的目录槽位都改为指向分裂镜像，局部深度减一 */
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      page_id_t page_id = dir_page->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        dir_page->SetBucketPageId(i, image_page_id);
+        dir_page->DecrLocalDepth(i);
+      }
+    }
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    while (dir_page->CanShrink()) {
+      dir_page->DecrGlobalDepth();
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
@@ -134,5 +429,7 @@ template class DiskExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>
 template class DiskExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class DiskExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class DiskExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+template class DiskExtendibleHashTable<GenericKey<128>, RID, GenericComparator<128>>;
+template class DiskExtendibleHashTable<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
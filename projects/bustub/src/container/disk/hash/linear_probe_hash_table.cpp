@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,22 +27,150 @@ namespace bustub {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
-                                      HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+                                      HashFunction<KeyType> hash_fn, size_t migrate_slots)
+    : migrate_slots_(migrate_slots),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      hash_fn_(std::move(hash_fn)) {
+  /* 槽位数向上取整到整数个块页 */
+  size_t num_blocks = std::clamp<size_t>((num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1, HEADER_ARRAY_SIZE);
+  header_page_id_ = CreateTable(num_blocks);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchHeaderPage(page_id_t header_page_id) -> HashTableHeaderPage * {
+  return reinterpret_cast<HashTableHeaderPage *>(buffer_pool_manager_->FetchPage(header_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE * {
+  return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->FetchPage(block_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::CreateTable(size_t num_blocks) -> page_id_t {
+  /* 新页面的内容全为0，即所有槽位都没有被占用过 */
+  page_id_t header_page_id;
+  auto header_page = reinterpret_cast<HashTableHeaderPage *>(buffer_pool_manager_->NewPage(&header_page_id)->GetData());
+  header_page->SetPageId(header_page_id);
+  header_page->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    buffer_pool_manager_->NewPage(&block_page_id);
+    header_page->AddBlockPageId(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteTable(page_id_t header_page_id) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id);
+  for (size_t i = 0; i < header_page->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(header_page->GetBlockPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  buffer_pool_manager_->DeletePage(header_page_id);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+auto HASH_TABLE_TYPE::Probe(page_id_t header_page_id, const KeyType &key, bool is_dirty, Visitor &&visit) -> bool {
+  /* 探测序列可能跨越多个块页，只有换到下一个块页时才重新fetch */
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id);
+  size_t size = header_page->GetSize();
+  size_t slot = hash_fn_.GetHash(key) % size;
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  HASH_TABLE_BLOCK_TYPE *block_page = nullptr;
+  bool hit = false;
+  for (size_t probed = 0; probed < size; probed++, slot = (slot + 1) % size) {
+    page_id_t slot_page_id = header_page->GetBlockPageId(slot / BLOCK_ARRAY_SIZE);
+    if (slot_page_id != block_page_id) {
+      if (block_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(block_page_id, is_dirty);
+      }
+      block_page_id = slot_page_id;
+      block_page = FetchBlockPage(block_page_id);
+    }
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    bool occupied = block_page->IsOccupied(offset);
+    hit = visit(block_page, offset);
+    /* 从未被占用过的槽位是探测序列的终点，墓碑则不是 */
+    if (hit || !occupied) {
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(block_page_id, is_dirty);
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return hit;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ProbeInsert(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool {
+  return Probe(header_page_id, key, true, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset) {
+    return block_page->Insert(offset, key, value);
+  });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ProbeFind(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool {
+  return Probe(header_page_id, key, false, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset) {
+    return block_page->IsReadable(offset) && comparator_(key, block_page->KeyAt(offset)) == 0 &&
+           block_page->ValueAt(offset) == value;
+  });
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  /* 扩容期间还没迁移的条目留在旧表里，新旧两张表都要查，已迁移的条目在旧表中是墓碑，不会重复 */
+  table_latch_.RLock();
+  size_t num_found = result->size();
+  auto collect = [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset) {
+    if (block_page->IsReadable(offset) && comparator_(key, block_page->KeyAt(offset)) == 0) {
+      result->push_back(block_page->ValueAt(offset));
+    }
+    return false;
+  };
+  Probe(header_page_id_, key, false, collect);
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    Probe(old_header_page_id_, key, false, collect);
+  }
+  table_latch_.RUnlock();
+  return result->size() > num_found;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.WLock();
+  MigrateSlots(migrate_slots_);
+  if (ProbeFind(header_page_id_, key, value) ||
+      (old_header_page_id_ != INVALID_PAGE_ID && ProbeFind(old_header_page_id_, key, value))) {
+    table_latch_.WUnlock();
+    return false;
+  }
+  /* 墓碑同样会拉长探测序列，所以按被占用的槽位数而不是条目数决定何时扩容 */
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  if ((num_occupied_ + 1) * 2 > size) {
+    StartResize(size);
+  }
+  bool inserted = ProbeInsert(header_page_id_, key, value);
+  if (inserted) {
+    num_occupied_++;
+  }
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -48,21 +178,107 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.WLock();
+  MigrateSlots(migrate_slots_);
+  auto remove = [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset) {
+    if (block_page->IsReadable(offset) && comparator_(key, block_page->KeyAt(offset)) == 0 &&
+        block_page->ValueAt(offset) == value) {
+      block_page->Remove(offset);
+      return true;
+    }
+    return false;
+  };
+  bool removed = Probe(header_page_id_, key, true, remove) ||
+                 (old_header_page_id_ != INVALID_PAGE_ID && Probe(old_header_page_id_, key, true, remove));
+  table_latch_.WUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  StartResize(initial_size);
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::StartResize(size_t initial_size) {
+  /* 同一时刻最多只有新旧两张表，上一次扩容还没迁移完就先一次性迁移完 */
+  MigrateSlots(std::numeric_limits<size_t>::max());
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    return;
+  }
+  size_t num_blocks = std::min<size_t>((2 * initial_size + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, HEADER_ARRAY_SIZE);
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t num_old_blocks = header_page->NumBlocks();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  if (num_blocks <= num_old_blocks) {
+    return;
+  }
+  old_header_page_id_ = header_page_id_;
+  header_page_id_ = CreateTable(num_blocks);
+  migrate_next_ = 0;
+  num_occupied_ = 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MigrateSlots(size_t num_slots) {
+  if (old_header_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  /* 迁移走的条目在旧表里留下墓碑，旧表中其他key的探测序列仍然完整 */
+  HashTableHeaderPage *old_header_page = FetchHeaderPage(old_header_page_id_);
+  size_t old_size = old_header_page->GetSize();
+  size_t end = migrate_next_ + std::min(num_slots, old_size - migrate_next_);
+  bool new_table_full = false;
+  while (migrate_next_ < end && !new_table_full) {
+    size_t block_index = migrate_next_ / BLOCK_ARRAY_SIZE;
+    page_id_t block_page_id = old_header_page->GetBlockPageId(block_index);
+    HASH_TABLE_BLOCK_TYPE *block_page = FetchBlockPage(block_page_id);
+    for (; migrate_next_ < end && migrate_next_ / BLOCK_ARRAY_SIZE == block_index; migrate_next_++) {
+      slot_offset_t offset = migrate_next_ % BLOCK_ARRAY_SIZE;
+      if (!block_page->IsReadable(offset)) {
+        continue;
+      }
+      /* 新表大小受头页面容量限制时，迁移期间的插入可能把它填满，剩下的条目只能留在旧表里 */
+      if (!ProbeInsert(header_page_id_, block_page->KeyAt(offset), block_page->ValueAt(offset))) {
+        new_table_full = true;
+        break;
+      }
+      num_occupied_++;
+      block_page->Remove(offset);
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  if (migrate_next_ == old_size) {
+    DeleteTable(old_header_page_id_);
+    old_header_page_id_ = INVALID_PAGE_ID;
+  }
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+  table_latch_.RLock();
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::IsResizing() -> bool {
+  table_latch_.RLock();
+  bool resizing = old_header_page_id_ != INVALID_PAGE_ID;
+  table_latch_.RUnlock();
+  return resizing;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
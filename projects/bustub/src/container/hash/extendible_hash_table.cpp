@@ -14,8 +14,13 @@
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <thread>  // NOLINT
 #include <utility>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "container/hash/extendible_hash_table.h"
 #include "include/common/logger.h"
 #include "storage/page/page.h"
@@ -23,219 +28,220 @@
 namespace bustub {
 
 template <typename K, typename V>
-ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)
-    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {
-  auto init_bucket = std::make_shared<Bucket>(bucket_size);
-  this->dir_.push_back(init_bucket);
-  // LOG_INFO("#dir size = %lu", this->dir_.size());
+ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size) : bucket_size_(bucket_size) {
+  buckets_.push_back(std::make_unique<Bucket>(bucket_size));
+  directories_.push_back(std::make_unique<Directory>(0));
+  directories_.back()->slots_[0].store(buckets_.back().get());
+  dir_.store(directories_.back().get());
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
-  int mask = (1 << global_depth_) - 1;
+auto ExtendibleHashTable<K, V>::IndexOf(const K &key, const Directory *dir) -> size_t {
+  size_t mask = dir->Size() - 1;
   return std::hash<K>()(key) & mask;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
-  std::scoped_lock<std::recursive_mutex> lock(latch_);
-  return GetGlobalDepthInternal();
+auto ExtendibleHashTable<K, V>::FingerprintOf(const K &key) -> uint8_t {
+  // std::hash is the identity for integers, so scramble it before taking the high bits
+  return static_cast<uint8_t>((static_cast<uint64_t>(std::hash<K>()(key)) * 0x9E3779B97F4A7C15ULL) >> 56);
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetGlobalDepthInternal() const -> int {
-  return global_depth_;
+auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return dir_.load()->global_depth_;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {
-  std::scoped_lock<std::recursive_mutex> lock(latch_);
-  return GetLocalDepthInternal(dir_index);
-}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetLocalDepthInternal(int dir_index) const -> int {
-  return dir_[dir_index]->GetDepth();
+  std::scoped_lock<std::mutex> lock(latch_);
+  return dir_.load()->slots_[dir_index].load()->GetDepth();
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {
-  std::scoped_lock<std::recursive_mutex> lock(latch_);
-  return GetNumBucketsInternal();
-}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
-  return num_buckets_;
-}
-
-template <typename K, typename V>
-void ExtendibleHashTable<K, V>::IncrementGlobalDepth() {
-  global_depth_++;
+  std::scoped_lock<std::mutex> lock(latch_);
+  return static_cast<int>(buckets_.size());
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetDirectoryNum() const -> int {
-  return dir_.size();
+  std::scoped_lock<std::mutex> lock(latch_);
+  return static_cast<int>(dir_.load()->Size());
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void {
-  auto items = bucket->GetItems();
-  for (auto &item : items) {
-    auto index = IndexOf(item.first);
-    dir_[index]->Insert(item.first, item.second);
+auto ExtendibleHashTable<K, V>::LatchBucket(const K &key, bool exclusive) -> Bucket * {
+  while (true) {
+    uint64_t version = version_.load();
+    if (version % 2 == 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    Directory *dir = dir_.load();
+    Bucket *bucket = dir->slots_[IndexOf(key, dir)].load();
+    exclusive ? bucket->GetLatch().WLock() : bucket->GetLatch().RLock();
+    // A split of this bucket needs its latch, so if no split touched the directory up to now, none will until it is
+    // unlatched
+    if (version_.load() == version) {
+      return bucket;
+    }
+    exclusive ? bucket->GetLatch().WUnlock() : bucket->GetLatch().RUnlock();
   }
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::RehashDirectoryPointers(std::shared_ptr<Bucket> first, std::shared_ptr<Bucket> second,
-                                                        size_t index, int local_depth, int global_depth) -> void {
-  size_t distance = 1 << (global_depth_ - 1);
-  if (local_depth == global_depth) {
-    dir_[index] = first;
-    dir_[index + distance] = second;
-    for (size_t i = 0; i < distance; i++) {
-      if (dir_[i + distance] == nullptr) {
-        dir_[i + distance] = dir_[i];
-      }
-    }
+void ExtendibleHashTable<K, V>::SplitBucket(const K &key) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Only splits change the directory and they hold latch_, so it can be read directly. Another split may have made
+  // room for the key while latch_ was not held
+  Directory *dir = dir_.load();
+  Bucket *bucket = dir->slots_[IndexOf(key, dir)].load();
+  bucket->GetLatch().WLock();
+  if (!bucket->IsFull()) {
+    bucket->GetLatch().WUnlock();
     return;
   }
-  std::shared_ptr<Bucket> old_bucket = dir_[index];
-  size_t dir_size = GetDirectoryNum();
-  for (size_t i = 0; i < dir_size; i++) {
-    if (dir_[i] == old_bucket) {
-      auto specified_bit = GetSpecifiedBit(i, local_depth);
-      if (specified_bit == 0) {
-        dir_[i] = first;
-      } else {
-        dir_[i] = second;
-      }
+
+  version_.fetch_add(1);
+  int local_depth = bucket->GetDepth();
+  if (local_depth == dir->global_depth_) {
+    directories_.push_back(std::make_unique<Directory>(dir->global_depth_ + 1));
+    Directory *new_dir = directories_.back().get();
+    for (size_t i = 0; i < new_dir->Size(); i++) {
+      new_dir->slots_[i].store(dir->slots_[i % dir->Size()].load());
     }
+    dir_.store(new_dir);
+    dir = new_dir;
   }
-}
 
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetSpecifiedBit(size_t n, int k) -> int {
-  return (n >> k) & 1;
-}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::SplitAndRehash(std::shared_ptr<Bucket> bucket, size_t index, int local_depth,
-                                               int global_depth) -> void {
-  // create two new bucket and increment local depth.
-  auto new_first_bucket = std::make_shared<Bucket>(bucket_size_, local_depth + 1);
-  auto new_second_bucket = std::make_shared<Bucket>(bucket_size_, local_depth + 1);
-  RehashDirectoryPointers(new_first_bucket, new_second_bucket, index, local_depth, global_depth);
-  RedistributeBucket(bucket);
+  // The entries and directory slots whose hash has bit local_depth set move to the new bucket
+  buckets_.push_back(std::make_unique<Bucket>(bucket_size_, local_depth + 1));
+  Bucket *image = buckets_.back().get();
+  bucket->IncrementDepth();
+  // The slots of the bucket share their low local_depth bits, so only every 2^(local_depth+1)-th slot is visited
+  size_t high_bit = size_t{1} << local_depth;
+  for (size_t i = (IndexOf(key, dir) & (high_bit - 1)) | high_bit; i < dir->Size(); i += 2 * high_bit) {
+    dir->slots_[i].store(image);
+  }
+  auto &items = bucket->GetItems();
+  for (size_t i = 0; i < items.size();) {
+    if ((std::hash<K>()(items[i].first) & high_bit) != 0) {
+      image->Insert(items[i].first, items[i].second);
+      bucket->Remove(items[i].first);
+    } else {
+      i++;
+    }
+  }
+  version_.fetch_add(1);
+  bucket->GetLatch().WUnlock();
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
-  // UNREACHABLE("not implemented");
-  std::scoped_lock<std::recursive_mutex> lock(latch_);
-  auto directory_index = IndexOf(key);
-  std::shared_ptr<Bucket> index_bucket = dir_[directory_index];
-  if (index_bucket != nullptr) {
-    return index_bucket->Find(key, value);
-  }
-  return false;
+  Bucket *bucket = LatchBucket(key, false);
+  bool found = bucket->Find(key, value);
+  bucket->GetLatch().RUnlock();
+  return found;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
-  // UNREACHABLE("not implemented");
-  std::scoped_lock<std::recursive_mutex> lock(latch_);
-  auto directory_index = IndexOf(key);
-  std::shared_ptr<Bucket> index_bucket = dir_[directory_index];
-  if (index_bucket != nullptr) {
-    return index_bucket->Remove(key);
-  }
-  return false;
+  Bucket *bucket = LatchBucket(key, true);
+  bool removed = bucket->Remove(key);
+  bucket->GetLatch().WUnlock();
+  return removed;
 }
 
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
-  // UNREACHABLE("not implemented");
-  std::scoped_lock<std::recursive_mutex> lock(latch_);
-  auto dir_index = IndexOf(key);
-  auto indexed_bucket = dir_[dir_index];
-  auto inserted = indexed_bucket->Insert(key, value);
-  if (inserted) {
-    return;
-  }
-
-  auto global_depth = GetGlobalDepthInternal();
-  auto local_depth = GetLocalDepthInternal(dir_index);
-  if (local_depth == global_depth) {
-    IncrementGlobalDepth();
-    // double directory size.
-    dir_.resize(dir_.size() * 2);
-    // create two new bucket.
-    SplitAndRehash(indexed_bucket, dir_index, local_depth, global_depth);
-  }
-
-  if (local_depth < global_depth) {
-    // create two new bucket and increment local depth.
-    SplitAndRehash(indexed_bucket, dir_index, local_depth, global_depth);
+  // A split may leave every entry on one side, so keep splitting until the key fits
+  while (true) {
+    Bucket *bucket = LatchBucket(key, true);
+    bool inserted = bucket->Insert(key, value);
+    bucket->GetLatch().WUnlock();
+    if (inserted) {
+      return;
+    }
+    SplitBucket(key);
   }
-
-  num_buckets_++;
-  // latch_.unlock();
-  Insert(key, value);
 }
 
 //===--------------------------------------------------------------------===//
 // Bucket
 //===--------------------------------------------------------------------===//
 template <typename K, typename V>
-ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {}
+ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth)
+    : size_(array_size), depth_(depth), fingerprints_((array_size + 15) / 16 * 16) {
+  items_.reserve(array_size);
+}
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
-  // UNREACHABLE("not implemented");
-  for (auto &i : this->list_) {
-    if (i.first == key) {
-      value = i.second;
-      return true;
+auto ExtendibleHashTable<K, V>::Bucket::IndexOf(const K &key, uint8_t fingerprint) const -> int {
+#if defined(__SSE2__)
+  // Compare 16 fingerprints at once, and only the keys whose fingerprint matches
+  __m128i needle = _mm_set1_epi8(static_cast<char>(fingerprint));
+  for (size_t base = 0; base < items_.size(); base += 16) {
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints_.data() + base));
+    auto matches = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, needle)));
+    if (items_.size() - base < 16) {
+      matches &= (1U << (items_.size() - base)) - 1;
     }
+    for (; matches != 0; matches &= matches - 1) {
+      size_t i = base + __builtin_ctz(matches);
+      if (items_[i].first == key) {
+        return static_cast<int>(i);
+      }
+    }
+  }
+#else
+  for (size_t i = 0; i < items_.size(); i++) {
+    if (fingerprints_[i] == fingerprint && items_[i].first == key) {
+      return static_cast<int>(i);
+    }
+  }
+#endif
+  return -1;
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
+  int i = IndexOf(key, FingerprintOf(key));
+  if (i == -1) {
+    return false;
   }
-  return false;
+  value = items_[i].second;
+  return true;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
-  // UNREACHABLE("not implemented");
-  for (auto i = this->list_.begin(); i != this->list_.end(); i++) {
-    if (i->first == key) {
-      this->list_.erase(i);
-      return true;
-    }
+  int i = IndexOf(key, FingerprintOf(key));
+  if (i == -1) {
+    return false;
   }
-  return false;
+  // Keep the entries contiguous by moving the last one into the hole
+  fingerprints_[i] = fingerprints_[items_.size() - 1];
+  items_[i] = std::move(items_.back());
+  items_.pop_back();
+  return true;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
-  // UNREACHABLE("not implemented");
-  if (!IsFull()) {
-    for (auto it = list_.begin(); it != list_.end(); it++) {
-      if (it->first == key) {
-        it->second = value;
-        return true;
-      }
-    }
-    list_.push_back(std::make_pair(key, value));
+  uint8_t fingerprint = FingerprintOf(key);
+  int i = IndexOf(key, fingerprint);
+  if (i != -1) {
+    items_[i].second = value;
     return true;
   }
-  for (auto it = list_.begin(); it != list_.end(); it++) {
-    if (it->first == key) {
-      it->second = value;
-      break;
-    }
+  if (IsFull()) {
+    return false;
   }
-  return false;
+  fingerprints_[items_.size()] = fingerprint;
+  items_.emplace_back(key, value);
+  return true;
 }
 
 template class ExtendibleHashTable<page_id_t, Page *>;
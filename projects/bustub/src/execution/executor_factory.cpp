@@ -50,8 +50,9 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan.get()));
     }
 
-    // Create a new index scan executor
-    case PlanType::IndexScan: {
+    // Create a new index scan executor, an index-only scan is executed by the same executor
+    case PlanType::IndexScan:
+    case PlanType::IndexOnlyScan: {
       return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan.get()));
     }
 
@@ -11,12 +11,178 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include "common/config.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+IndexScanExecutor::~IndexScanExecutor() { StopWorkers(); }
+
+void IndexScanExecutor::Init() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  auto *index_info = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info->table_name_);
+
+  // the bounds are constants, cast to the type of the key column
+  const auto &key_schema = index_info->key_schema_;
+  auto make_key = [&key_schema](const AbstractExpressionRef &bound) {
+    Value value = bound->Evaluate(nullptr, key_schema).CastAs(key_schema.GetColumn(0).GetType());
+    return Tuple({value}, &key_schema);
+  };
+  IndexRange range;
+  if (plan_->lower_bound_ != nullptr) {
+    range.lower_ = make_key(plan_->lower_bound_);
+    range.lower_inclusive_ = plan_->lower_inclusive_;
+  }
+  if (plan_->upper_bound_ != nullptr) {
+    range.upper_ = make_key(plan_->upper_bound_);
+    range.upper_inclusive_ = plan_->upper_inclusive_;
+  }
+  range.reverse_ = plan_->IsReverse();
+
+  // an entry holds the key columns followed by the included columns
+  index_only_ = plan_->GetType() == PlanType::IndexOnlyScan;
+  if (index_only_) {
+    const auto *metadata = index_info->index_->GetMetadata();
+    entry_schema_ = metadata->GetEntrySchema();
+    entry_columns_.assign(table_info_->schema_.GetColumnCount(), std::nullopt);
+    const auto &include_attrs = metadata->GetIncludeAttrs();
+    for (uint32_t i = 0; i < include_attrs.size(); i++) {
+      entry_columns_[include_attrs[i]] = metadata->GetIndexColumnCount() + i;
+    }
+    for (uint32_t i = 0; i < metadata->GetKeyAttrs().size(); i++) {
+      entry_columns_[metadata->GetKeyAttrs()[i]] = i;
+    }
+  }
+
+  StopWorkers();
+  scan_ = nullptr;
+  batch_ = Batch();
+  cursor_ = 0;
+  auto *txn = exec_ctx_->GetTransaction();
+  if (plan_->parallelism_ <= 1 || range.reverse_) {
+    scan_ = index_info->index_->ScanRange(range, txn);
+    return;
+  }
+  auto scans = index_info->index_->ScanRangePartitioned(range, plan_->parallelism_, txn);
+  if (scans.size() == 1) {
+    scan_ = std::move(scans[0]);
+    return;
+  }
+  stopped_ = false;
+  for (auto &scan : scans) {
+    auto &partition = partitions_.emplace_back(std::make_unique<Partition>());
+    partition->scan_ = std::move(scan);
+  }
+  for (auto &partition : partitions_) {
+    partition->worker_ = std::thread(&IndexScanExecutor::RunWorker, this, partition.get());
+  }
+}
+
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (cursor_ == batch_.first.size()) {
+    batch_.first.clear();
+    batch_.second.clear();
+    cursor_ = 0;
+    if (scan_ != nullptr) {
+      if (!FetchBatch(scan_.get(), &batch_)) {
+        return false;
+      }
+      continue;
+    }
+
+    // take the next batch of the current sub-range, move on to the next sub-range once it is exhausted
+    if (partition_cursor_ == partitions_.size()) {
+      return false;
+    }
+    auto &partition = *partitions_[partition_cursor_];
+    std::unique_lock lock(partition.mutex_);
+    partition.cv_.wait(lock, [&partition] { return !partition.batches_.empty() || partition.done_; });
+    if (partition.batches_.empty()) {
+      partition_cursor_++;
+      continue;
+    }
+    batch_ = std::move(partition.batches_.front());
+    partition.batches_.pop_front();
+    partition.cv_.notify_all();
+  }
+
+  *rid = batch_.first[cursor_];
+  *tuple = std::move(batch_.second[cursor_]);
+  cursor_++;
+  return true;
+}
+
+auto IndexScanExecutor::FetchBatch(IndexRangeScan *scan, Batch *batch) -> bool {
+  std::vector<RID> rids;
+  std::vector<Tuple> entries;
+  // a batch whose tuples have all been deleted since it was read yields nothing, read on
+  while (batch->first.empty()) {
+    rids.clear();
+    entries.clear();
+    if (!scan->NextBatch(&rids, index_only_ ? &entries : nullptr)) {
+      return false;
+    }
+    for (size_t i = 0; i < rids.size(); i++) {
+      if (index_only_) {
+        batch->first.push_back(rids[i]);
+        batch->second.push_back(MakeIndexOnlyTuple(entries[i]));
+        continue;
+      }
+      // skip entries whose tuple has been deleted since the batch was read
+      Tuple tuple;
+      if (table_info_->table_->GetTuple(rids[i], &tuple, exec_ctx_->GetTransaction())) {
+        batch->first.push_back(rids[i]);
+        batch->second.push_back(std::move(tuple));
+      }
+    }
+  }
+  return true;
+}
+
+void IndexScanExecutor::RunWorker(Partition *partition) {
+  while (!stopped_) {
+    Batch batch;
+    bool fetched = FetchBatch(partition->scan_.get(), &batch);
+    std::unique_lock lock(partition->mutex_);
+    if (!fetched) {
+      break;
+    }
+    partition->cv_.wait(lock, [this, partition] {
+      return stopped_ || partition->batches_.size() < INDEX_SCAN_QUEUED_BATCHES;
+    });
+    partition->batches_.push_back(std::move(batch));
+    partition->cv_.notify_all();
+  }
+  std::scoped_lock lock(partition->mutex_);
+  partition->done_ = true;
+  partition->cv_.notify_all();
+}
 
-void IndexScanExecutor::Init() { throw NotImplementedException("IndexScanExecutor is not implemented"); }
+void IndexScanExecutor::StopWorkers() {
+  stopped_ = true;
+  for (auto &partition : partitions_) {
+    {
+      std::scoped_lock lock(partition->mutex_);
+      partition->cv_.notify_all();
+    }
+    partition->worker_.join();
+  }
+  partitions_.clear();
+  partition_cursor_ = 0;
+}
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto IndexScanExecutor::MakeIndexOnlyTuple(const Tuple &entry) const -> Tuple {
+  std::vector<Value> values;
+  values.reserve(entry_columns_.size());
+  for (uint32_t i = 0; i < entry_columns_.size(); i++) {
+    values.push_back(entry_columns_[i].has_value()
+                         ? entry.GetValue(entry_schema_, *entry_columns_[i])
+                         : ValueFactory::GetNullValueByType(table_info_->schema_.GetColumn(i).GetType()));
+  }
+  return Tuple(values, &GetOutputSchema());
+}
 
 }  // namespace bustub
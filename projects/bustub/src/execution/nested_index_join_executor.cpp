@@ -12,19 +12,100 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include "common/config.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestIndexJoinExecutor::Init() { throw NotImplementedException("NestIndexJoinExecutor is not implemented"); }
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  auto *catalog = exec_ctx_->GetCatalog();
+  inner_table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  results_.clear();
+  cursor_ = 0;
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (cursor_ == results_.size()) {
+    results_.clear();
+    cursor_ = 0;
+    if (!JoinNextBatch()) {
+      return false;
+    }
+  }
+  *tuple = std::move(results_[cursor_++]);
+  return true;
+}
+
+auto NestIndexJoinExecutor::JoinNextBatch() -> bool {
+  const auto &outer_schema = child_executor_->GetOutputSchema();
+  const auto &key_schema = index_info_->key_schema_;
+  std::vector<Tuple> outer_tuples;
+  // a NULL join key matches nothing, so only the non-NULL keys are looked up
+  std::vector<Tuple> keys;
+  std::vector<size_t> key_owners;
+  Tuple outer_tuple;
+  RID outer_rid;
+  while (outer_tuples.size() < static_cast<size_t>(INDEX_JOIN_BATCH_SIZE) &&
+         child_executor_->Next(&outer_tuple, &outer_rid)) {
+    Value key = plan_->KeyPredicate()->Evaluate(&outer_tuple, outer_schema);
+    if (!key.IsNull()) {
+      keys.emplace_back(std::vector<Value>{key.CastAs(key_schema.GetColumn(0).GetType())}, &key_schema);
+      key_owners.push_back(outer_tuples.size());
+    }
+    outer_tuples.push_back(outer_tuple);
+  }
+  if (outer_tuples.empty()) {
+    return false;
+  }
+
+  std::vector<std::vector<RID>> key_rids;
+  index_info_->index_->ScanKeys(keys, &key_rids, exec_ctx_->GetTransaction());
+  std::vector<std::vector<RID>> inner_rids(outer_tuples.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    inner_rids[key_owners[i]] = std::move(key_rids[i]);
+  }
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  const auto &inner_schema = plan_->InnerTableSchema();
+  for (size_t i = 0; i < outer_tuples.size(); i++) {
+    std::vector<Value> outer_values;
+    outer_values.reserve(outer_schema.GetColumnCount());
+    for (uint32_t col = 0; col < outer_schema.GetColumnCount(); col++) {
+      outer_values.push_back(outer_tuples[i].GetValue(&outer_schema, col));
+    }
+    bool matched = false;
+    for (const auto &inner_rid : inner_rids[i]) {
+      // skip entries whose tuple has been deleted since they were looked up
+      Tuple inner_tuple;
+      if (!inner_table_info_->table_->GetTuple(inner_rid, &inner_tuple, exec_ctx_->GetTransaction())) {
+        continue;
+      }
+      matched = true;
+      auto values = outer_values;
+      for (uint32_t col = 0; col < inner_schema.GetColumnCount(); col++) {
+        values.push_back(inner_tuple.GetValue(&inner_schema, col));
+      }
+      results_.emplace_back(values, &GetOutputSchema());
+    }
+    if (!matched && plan_->GetJoinType() == JoinType::LEFT) {
+      auto values = outer_values;
+      for (uint32_t col = 0; col < inner_schema.GetColumnCount(); col++) {
+        values.push_back(ValueFactory::GetNullValueByType(inner_schema.GetColumn(col).GetType()));
+      }
+      results_.emplace_back(values, &GetOutputSchema());
+    }
+  }
+  return true;
+}
 
 }  // namespace bustub
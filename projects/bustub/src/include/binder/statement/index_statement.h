@@ -15,13 +15,16 @@
 #include "binder/expressions/bound_column_ref.h"
 #include "binder/table_ref/bound_base_table_ref.h"
 #include "catalog/column.h"
+#include "storage/index/index.h"
 
 namespace bustub {
 
 class IndexStatement : public BoundStatement {
  public:
   explicit IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                          std::vector<std::unique_ptr<BoundColumnRef>> cols);
+                          std::vector<std::unique_ptr<BoundColumnRef>> cols, bool is_unique,
+                          std::vector<std::unique_ptr<BoundColumnRef>> include_cols = {},
+                          IndexType index_type = IndexType::BPlusTreeIndex);
 
   /** Name of the index */
   std::string index_name_;
@@ -32,6 +35,15 @@ class IndexStatement : public BoundStatement {
   /** Name of the columns */
   std::vector<std::unique_ptr<BoundColumnRef>> cols_;
 
+  /** Whether it is a UNIQUE index */
+  bool is_unique_;
+
+  /** Name of the columns stored in the index but not part of the key */
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols_;
+
+  /** Data structure of the index, from the USING clause */
+  IndexType index_type_;
+
   auto ToString() const -> std::string override;
 };
 
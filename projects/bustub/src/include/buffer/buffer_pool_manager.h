@@ -84,6 +84,24 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Reserve a run of contiguous page ids on disk for a single table or index. None of the pages is brought into the
+   * buffer pool; each one is created on demand with NewPageInExtent.
+   * @param num_pages number of pages in the extent
+   * @param owner the object that I/O on the extent is attributed to
+   * @return the id of the first page of the extent
+   */
+  auto AllocateExtent(size_t num_pages, IOObject owner = {}) -> page_id_t {
+    return AllocateExtentImp(num_pages, owner);
+  }
+
+  /**
+   * Creates a new page in the buffer pool for a page id previously reserved with AllocateExtent.
+   * @param page_id a reserved page id that has not been created yet
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageInExtent(page_id_t page_id) -> Page * { return NewPgInExtentImp(page_id); }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
@@ -130,6 +148,21 @@ class BufferPoolManager {
    */
   virtual auto NewPgImp(page_id_t *page_id) -> Page * = 0;
 
+  /**
+   * Reserves a run of contiguous page ids on disk.
+   * @param num_pages number of pages in the extent
+   * @param owner the object that I/O on the extent is attributed to
+   * @return the id of the first page of the extent
+   */
+  virtual auto AllocateExtentImp(size_t num_pages, IOObject owner) -> page_id_t = 0;
+
+  /**
+   * Creates a new page in the buffer pool for a reserved page id.
+   * @param page_id id of the page to create
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgInExtentImp(page_id_t page_id) -> Page * = 0;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -72,6 +72,24 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * @brief Reserve `num_pages` consecutive page ids by advancing next_page_id_ past them, and register the extent
+   * with the disk manager so that I/O on it is attributed to `owner`.
+   *
+   * @param num_pages number of pages in the extent
+   * @param owner the object that I/O on the extent is attributed to
+   * @return the id of the first page of the extent
+   */
+  auto AllocateExtentImp(size_t num_pages, IOObject owner) -> page_id_t override;
+
+  /**
+   * @brief Same as NewPgImp(), except that the id of the new page was already reserved by AllocateExtentImp().
+   *
+   * @param page_id id of the page to create
+   * @return nullptr if all frames are pinned, otherwise pointer to new page
+   */
+  auto NewPgInExtentImp(page_id_t page_id) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -177,6 +195,23 @@ class BufferPoolManagerInstance : public BufferPoolManager {
     // This is a no-nop right now without a more complex data structure to track deallocated pages
   }
 
+  /**
+   * @brief Pick a frame from the free list, or else evict one from the replacer, writing the victim back if it is
+   * dirty and removing it from the page table. Caller should acquire the latch before calling this function.
+   * @param[out] frame_id the free frame
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Place a new, zeroed and pinned page with the given id in the frame. Caller should acquire the latch before
+   * calling this function.
+   * @param frame_id a frame returned by AcquireFrame()
+   * @param page_id id of the new page
+   * @return pointer to the new page
+   */
+  auto PinNewPage(frame_id_t frame_id, page_id_t page_id) -> Page *;
+
   // TODO(student): You may add additional private members and helper functions
 };
 }  // namespace bustub
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.h
+//
+// Identification: src/include/buffer/extent_allocator.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ExtentAllocator hands out the pages of a single table heap or index. Instead of taking the next global page id for
+ * every new page, it reserves `extent_size` contiguous page ids from the buffer pool manager at a time and allocates
+ * from that run, so the pages of one object stay adjacent on disk even when several objects grow concurrently.
+ */
+class ExtentAllocator {
+ public:
+  /**
+   * @param buffer_pool_manager the buffer pool manager that reserves the extents and creates the pages
+   * @param extent_size number of pages reserved at a time
+   * @param owner the object that I/O on the reserved pages is attributed to
+   */
+  explicit ExtentAllocator(BufferPoolManager *buffer_pool_manager, size_t extent_size = EXTENT_SIZE,
+                           IOObject owner = {});
+
+  /**
+   * Create a new page in the buffer pool from the current extent, reserving a new extent when the current one is
+   * used up. The page is pinned, just like with BufferPoolManager::NewPage.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id) -> Page *;
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  const size_t extent_size_;
+  const IOObject owner_;
+  std::mutex latch_;
+  /** Next unused page id of the current extent. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** One past the last page id of the current extent. */
+  page_id_t extent_end_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
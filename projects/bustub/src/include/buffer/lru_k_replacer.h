@@ -155,7 +155,7 @@ class LRUKReplacer {
 
     inline auto SetIterator(std::list<frame_id_t>::iterator iter) -> void { iter_ = iter; }
 
-    inline auto GetTimestampList() -> std::list<size_t> { return timestamp_list_; }
+    inline auto GetTimestampList() const -> const std::list<size_t> & { return timestamp_list_; }
 
     inline auto SetTimestampList(std::list<size_t> timestamp_list) -> void {
       timestamp_list_ = std::move(timestamp_list);
@@ -21,6 +21,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/art_index.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
@@ -70,15 +71,17 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param index_type The data structure of the index
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, IndexType index_type = IndexType::BPlusTreeIndex)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        index_type_{index_type} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -91,6 +94,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The data structure of the index; only B+ tree indexes are ordered */
+  const IndexType index_type_;
 };
 
 /**
@@ -129,6 +134,9 @@ class Catalog {
       return NULL_TABLE_INFO;
     }
 
+    // Fetch the table OID for the new table, the table heap attributes its I/O to it
+    const auto table_oid = next_table_oid_.fetch_add(1);
+
     // Construct the table heap
     std::unique_ptr<TableHeap> table = nullptr;
 
@@ -136,12 +144,9 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn, IOObject::Table(table_oid));
     }
 
-    // Fetch the table OID for the new table
-    const auto table_oid = next_table_oid_.fetch_add(1);
-
     // Construct the table information
     auto meta = std::make_unique<TableInfo>(schema, table_name, std::move(table), table_oid);
     auto *tmp = meta.get();
@@ -196,12 +201,21 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param is_unique Whether the index holds at most one entry per key; a non-unique B+ tree index needs room for a
+   * RID at the end of KeyType
+   * @param include_attrs Columns whose values are stored in the index entries without being part of the key, so that
+   * queries reading only them never visit the table heap; they also need room at the end of KeyType
+   * @param index_type The data structure of the index; a hash index keeps the duplicates of a key itself, so KeyType
+   * needs no room for a RID, and it cannot have included columns. An ART index lives in memory only and is filled
+   * from the table heap here, like every index is when it is created
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, bool is_unique = true,
+                   const std::vector<uint32_t> &include_attrs = {}, IndexType index_type = IndexType::BPlusTreeIndex)
+      -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -218,29 +232,52 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique, include_attrs);
 
-    // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
+    // Get the next OID for the new index, the index attributes its I/O to it
+    const auto index_oid = next_index_oid_.fetch_add(1);
 
-    // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    // Construct the index of the requested type, take ownership of metadata
+    std::unique_ptr<Index> index;
+    switch (index_type) {
+      case IndexType::BPlusTreeIndex:
+        index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                     IOObject::Index(index_oid));
+        break;
+      case IndexType::HashTableIndex:
+        index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(
+            std::move(meta), bpm_, hash_function, IOObject::Index(index_oid));
+        break;
+      case IndexType::ArtIndex:
+        index = std::make_unique<ArtIndex<KeyType, ValueType, KeyComparator>>(std::move(meta));
+        break;
+    }
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, building it in bulk instead of one insert per tuple. Each entry
+    // carries the key columns followed by the included columns.
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    const auto *entry_schema = index->GetMetadata()->GetEntrySchema();
+    std::vector<uint32_t> entry_attrs = key_attrs;
+    entry_attrs.insert(entry_attrs.end(), include_attrs.begin(), include_attrs.end());
+    auto tuple = heap->Begin(txn);
+    if (tuple != heap->End()) {
+      index->BulkLoad(
+          [&](Tuple *key, RID *rid) {
+            if (tuple == heap->End()) {
+              return false;
+            }
+            *key = tuple->KeyFromTuple(schema, *entry_schema, entry_attrs);
+            *rid = tuple->GetRid();
+            ++tuple;
+            return true;
+          },
+          txn);
     }
 
-    // Get the next OID for the new index
-    const auto index_oid = next_index_oid_.fetch_add(1);
-
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, index_type);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -298,7 +335,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
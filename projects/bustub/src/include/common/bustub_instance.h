@@ -269,8 +269,11 @@ class BustubInstance {
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
+  void CmdDisplayIOStats(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
+  /** Allocate page 0 as the header page before anything else can claim it. */
+  void ReserveHeaderPage();
   std::unordered_map<std::string, std::string> session_variables_;
 };
 
@@ -36,6 +36,19 @@ static constexpr int BUFFER_POOL_SIZE = 10;
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int EXTENT_SIZE = 64;      // number of contiguous pages reserved by a table or index at a time
+
+static constexpr int SORT_BUFFER_PAGES = 256;         // pages of entries an external sort keeps in memory per run
+static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;  // fraction of each B+ tree page filled by a bulk load
+static constexpr int INDEX_PREFETCH_LEAVES = 8;       // upcoming leaves an index scan reads ahead of itself
+static constexpr int INDEX_SCAN_BATCH_SIZE = 1024;    // entries an index scan collects per descent of the tree
+static constexpr int INDEX_SCAN_PARALLELISM = 4;      // workers of a parallel index scan
+static constexpr int INDEX_PARTITION_MIN_LEAVES = 4;  // fewest leaves a partition of a parallel index scan spans
+static constexpr int INDEX_SCAN_QUEUED_BATCHES = 4;   // batches a parallel index scan worker runs ahead of its reader
+static constexpr int INDEX_JOIN_BATCH_SIZE = 256;     // outer tuples an index join looks up in the index at once
+static constexpr int SLOTTED_KEY_MIN_SIZE = 32;       // B+ tree keys this wide are stored prefix-compressed in slots
+static constexpr int INDEX_KEY_MAX_SIZE = 256;        // widest key an index created through SQL can have
+static constexpr int HASH_TABLE_MIGRATE_SLOTS = 64;   // slots a linear probe hash table resize migrates per operation
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
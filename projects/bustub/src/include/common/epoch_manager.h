@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.h
+//
+// Identification: src/include/common/epoch_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * EpochManager implements epoch-based reclamation for structures whose readers take no latch, such as a copy-on-write
+ * tree that writers replace by publishing a new root.
+ *
+ * A reader enters the current epoch before it loads anything from the structure and leaves it when it is done. A
+ * writer retires what it unlinked instead of destroying it. Retired objects are destroyed once every reader that
+ * entered an epoch in which they were still reachable has left. Readers announce themselves on counters striped over
+ * cache lines, so that they do not all contend on one.
+ */
+class EpochManager {
+ public:
+  /** Keeps the epoch it entered alive until it is destroyed. */
+  class Guard {
+   public:
+    explicit Guard(std::atomic<uint64_t> *counter) : counter_(counter) {}
+    Guard(Guard &&other) noexcept : counter_(other.counter_) { other.counter_ = nullptr; }
+    ~Guard() { Leave(); }
+    DISALLOW_COPY(Guard);
+    auto operator=(Guard &&other) noexcept -> Guard & {
+      if (this != &other) {
+        Leave();
+        counter_ = other.counter_;
+        other.counter_ = nullptr;
+      }
+      return *this;
+    }
+
+   private:
+    void Leave() {
+      if (counter_ != nullptr) {
+        counter_->fetch_sub(1);
+        counter_ = nullptr;
+      }
+    }
+
+    std::atomic<uint64_t> *counter_;
+  };
+
+  EpochManager() = default;
+  ~EpochManager() = default;
+  DISALLOW_COPY_AND_MOVE(EpochManager);
+
+  /**
+   * @brief Enter the current epoch. Retries if a writer advances the epoch meanwhile, but never blocks.
+   * @return a guard that leaves the epoch when it is destroyed
+   */
+  auto Enter() -> Guard;
+
+  /**
+   * @brief Hand over an object that writers unlinked from the structure. It is destroyed once no reader that could
+   * still reach it remains, at the latest when the manager is destroyed.
+   * @param object the unlinked object
+   */
+  void Retire(std::shared_ptr<const void> object);
+
+  /** @return the number of retired objects that are not destroyed yet */
+  auto NumRetired() -> size_t;
+
+ private:
+  static constexpr size_t NUM_READER_SLOTS = 64;
+
+  /** Readers active in the epochs of either parity, padded to a cache line of its own. */
+  struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> active_[2]{};
+  };
+
+  /** Destroys the objects retired in the previous epoch and advances the epoch, if no reader of it is left. */
+  void TryAdvance();
+
+  std::atomic<uint64_t> epoch_{0};
+  ReaderSlot slots_[NUM_READER_SLOTS];
+  // Guards retired_ and serializes advancing the epoch
+  std::mutex latch_;
+  // Objects retired in the epochs of either parity
+  std::vector<std::shared_ptr<const void>> retired_[2];
+};
+
+}  // namespace bustub
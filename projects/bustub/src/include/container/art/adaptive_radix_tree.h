@@ -0,0 +1,808 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/container/art/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "common/epoch_manager.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The layouts a node of an adaptive radix tree switches between as it gains and loses children. */
+enum class ArtNodeType : uint8_t { Leaf, Node4, Node16, Node48, Node256 };
+
+/**
+ * A node of an AdaptiveRadixTree. Every node stores the bytes of its compressed path and may hold the value of the
+ * key that ends right after them. A leaf has no room for children; the derived layouts have room for 4, 16, 48 or 256
+ * children, each labelled with the byte that follows the path.
+ *
+ * Nodes are immutable once a tree has published them. Children and values are shared between the versions of a tree.
+ */
+template <typename V>
+struct ArtNode {
+  explicit ArtNode(ArtNodeType type) : type_(type) {}
+  virtual ~ArtNode() = default;
+
+  ArtNodeType type_;
+  uint16_t num_children_{0};
+  // the bytes of the key consumed by this node, before the byte that labels a child
+  std::string prefix_;
+  // the value of the key ending right after prefix_, nullptr if there is none
+  std::shared_ptr<const V> value_;
+};
+
+/** Up to 4 children, labels sorted and searched linearly. */
+template <typename V>
+struct ArtNode4 : public ArtNode<V> {
+  ArtNode4() : ArtNode<V>(ArtNodeType::Node4) {}
+  uint8_t keys_[4]{};
+  std::shared_ptr<const ArtNode<V>> children_[4];
+};
+
+/** Up to 16 children, labels sorted and compared all at once with SSE2. */
+template <typename V>
+struct ArtNode16 : public ArtNode<V> {
+  ArtNode16() : ArtNode<V>(ArtNodeType::Node16) {}
+  uint8_t keys_[16]{};
+  std::shared_ptr<const ArtNode<V>> children_[16];
+};
+
+/** Up to 48 children, found through a 256 entry index from label to slot. */
+template <typename V>
+struct ArtNode48 : public ArtNode<V> {
+  ArtNode48() : ArtNode<V>(ArtNodeType::Node48) {}
+  // one more than the slot of the child labelled with each byte, 0 if there is no such child
+  uint8_t child_index_[256]{};
+  std::shared_ptr<const ArtNode<V>> children_[48];
+};
+
+/** A child for every byte. */
+template <typename V>
+struct ArtNode256 : public ArtNode<V> {
+  ArtNode256() : ArtNode<V>(ArtNodeType::Node256) {}
+  std::shared_ptr<const ArtNode<V>> children_[256];
+};
+
+/**
+ * AdaptiveRadixTree maps byte string keys to values. It is a radix tree whose nodes grow from Node4 to Node256 and
+ * shrink back as children come and go, and whose chains of single-child nodes are collapsed into the path prefix of
+ * the node below (path compression). A key may be a prefix of another key.
+ *
+ * The tree is persistent: a writer never changes a published node, it copies the nodes on the path to the key it
+ * modifies and publishes the new root with one atomic store. Writers are serialized by a latch, readers take none and
+ * see the version whose root they loaded. Replaced versions are reclaimed through an EpochManager once no reader can
+ * still be inside them.
+ *
+ * @tparam V value type
+ */
+template <typename V>
+class AdaptiveRadixTree {
+ public:
+  using Node = ArtNode<V>;
+  using NodePtr = std::shared_ptr<const Node>;
+
+  /**
+   * Iterator visits keys and their values in key order, one at a time. It stays in the version of the tree it started
+   * in, so writers neither block it nor show up in it, but the versions they replace meanwhile are only reclaimed once
+   * the iterator is gone.
+   */
+  class Iterator {
+   public:
+    /** @return true once every key of the scan has been visited */
+    auto IsEnd() const -> bool { return current_ == nullptr; }
+
+    /** @return the key the iterator is at */
+    auto Key() const -> const std::string & { return key_; }
+
+    /** @return the value of the key the iterator is at */
+    auto Value() const -> const V & { return *current_->value_; }
+
+    auto operator++() -> Iterator & {
+      Advance();
+      return *this;
+    }
+
+   private:
+    friend class AdaptiveRadixTree;
+
+    /** A node on the path to the current key, and the smallest label among its children not visited yet. */
+    struct Frame {
+      const Node *node_;
+      size_t key_length_;
+      int next_label_;
+    };
+
+    explicit Iterator(EpochManager::Guard guard) : guard_(std::move(guard)) {}
+
+    /** Positions the iterator at the first key below node, whose path is preceded by key_. */
+    void Start(const Node *node) {
+      Push(node);
+      if (node->value_ != nullptr) {
+        current_ = node;
+      } else {
+        Advance();
+      }
+    }
+
+    /** Positions the iterator at the first key not below key in the tree under root. */
+    void Seek(const Node *root, std::string_view key) {
+      const Node *node = root;
+      size_t depth = 0;
+      while (node != nullptr) {
+        Push(node);
+        const std::string &prefix = node->prefix_;
+        std::string_view rest = key.substr(depth);
+        size_t match = CommonPrefixLength(prefix, rest);
+        if (match == rest.size() ||
+            (match < prefix.size() && static_cast<uint8_t>(prefix[match]) > static_cast<uint8_t>(rest[match]))) {
+          // Every key below node is at least key
+          if (node->value_ != nullptr) {
+            current_ = node;
+          } else {
+            Advance();
+          }
+          return;
+        }
+        if (match < prefix.size()) {
+          // Every key below node is smaller than key
+          stack_.pop_back();
+          Advance();
+          return;
+        }
+        // The value of node itself is smaller than key, the children labelled below the next byte of key as well
+        depth += match;
+        auto label = static_cast<uint8_t>(key[depth]);
+        const NodePtr *child = FindChild(node, label);
+        if (child == nullptr) {
+          stack_.back().next_label_ = label;
+          Advance();
+          return;
+        }
+        stack_.back().next_label_ = label + 1;
+        key_.push_back(static_cast<char>(label));
+        node = child->get();
+        depth++;
+      }
+      current_ = nullptr;
+    }
+
+    void Push(const Node *node) {
+      key_.append(node->prefix_);
+      stack_.push_back(Frame{node, key_.size(), 0});
+    }
+
+    /** Moves on to the next node holding a value, descending before moving right, i.e. in key order. */
+    void Advance() {
+      while (!stack_.empty()) {
+        Frame &frame = stack_.back();
+        uint8_t label;
+        const Node *child = NextChild(frame.node_, frame.next_label_, &label);
+        if (child == nullptr) {
+          stack_.pop_back();
+          continue;
+        }
+        frame.next_label_ = label + 1;
+        key_.resize(frame.key_length_);
+        key_.push_back(static_cast<char>(label));
+        Push(child);
+        if (child->value_ != nullptr) {
+          current_ = child;
+          return;
+        }
+      }
+      current_ = nullptr;
+    }
+
+    EpochManager::Guard guard_;
+    std::vector<Frame> stack_;
+    std::string key_;
+    // the node holding the value of key_, nullptr at the end
+    const Node *current_{nullptr};
+  };
+
+  AdaptiveRadixTree() = default;
+  ~AdaptiveRadixTree() = default;
+  DISALLOW_COPY_AND_MOVE(AdaptiveRadixTree);
+
+  /**
+   * @brief Insert a key-value pair. An existing value is never overwritten.
+   * @return true if inserted, false if the key already has a value
+   */
+  auto Insert(std::string_view key, V value) -> bool {
+    std::scoped_lock<std::mutex> lock(write_latch_);
+    bool inserted = true;
+    NodePtr root = InsertInto(root_, key, &value, &inserted);
+    if (inserted) {
+      Publish(std::move(root));
+      size_.fetch_add(1);
+    }
+    return inserted;
+  }
+
+  /**
+   * @brief Look up the value of a key without taking any latch, and hand it to a reader while the version it belongs
+   * to is guaranteed to stay alive.
+   * @param read called as read(const V &) if the key has a value. The reference must not escape the call.
+   * @return true if the key has a value
+   */
+  template <typename Reader>
+  auto Read(std::string_view key, Reader &&read) const -> bool {
+    auto guard = epoch_manager_.Enter();
+    const Node *node = published_root_.load();
+    size_t depth = 0;
+    while (node != nullptr) {
+      const std::string &prefix = node->prefix_;
+      if (key.size() - depth < prefix.size() || key.compare(depth, prefix.size(), prefix) != 0) {
+        return false;
+      }
+      depth += prefix.size();
+      if (depth == key.size()) {
+        if (node->value_ == nullptr) {
+          return false;
+        }
+        read(*node->value_);
+        return true;
+      }
+      const NodePtr *child = FindChild(node, static_cast<uint8_t>(key[depth]));
+      node = child == nullptr ? nullptr : child->get();
+      depth++;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Look up the value of a key and copy it out.
+   * @return true if the key has a value
+   */
+  auto Get(std::string_view key, V *value) const -> bool {
+    return Read(key, [&](const V &found) { *value = found; });
+  }
+
+  /**
+   * @brief Scan the keys that start with a prefix, in key order, without collecting them first.
+   * @param prefix the prefix; an empty one scans the whole tree
+   * @return an iterator at the first key with the prefix, or at the end if there is none
+   */
+  auto ScanPrefix(std::string_view prefix) const -> Iterator {
+    Iterator iterator(epoch_manager_.Enter());
+    const Node *node = published_root_.load();
+    size_t depth = 0;
+    while (node != nullptr) {
+      std::string_view rest = prefix.substr(depth);
+      size_t match = CommonPrefixLength(node->prefix_, rest);
+      if (match == rest.size()) {
+        // The prefix ends within the path of node, so every key below node starts with it
+        iterator.key_ = prefix.substr(0, depth);
+        iterator.Start(node);
+        break;
+      }
+      if (match < node->prefix_.size()) {
+        break;
+      }
+      depth += match;
+      const NodePtr *child = FindChild(node, static_cast<uint8_t>(prefix[depth]));
+      node = child == nullptr ? nullptr : child->get();
+      depth++;
+    }
+    return iterator;
+  }
+
+  /**
+   * @brief Scan the keys from the first one not below key onwards, in key order, without collecting them first.
+   * @return an iterator at the first key not below key, or at the end if there is none
+   */
+  auto LowerBound(std::string_view key) const -> Iterator {
+    Iterator iterator(epoch_manager_.Enter());
+    iterator.Seek(published_root_.load(), key);
+    return iterator;
+  }
+
+  /**
+   * @brief Remove the value of a key, then drop, merge or shrink the nodes it leaves underused.
+   * @return true if the key had a value
+   */
+  auto Remove(std::string_view key) -> bool {
+    std::scoped_lock<std::mutex> lock(write_latch_);
+    bool removed = true;
+    NodePtr root = RemoveFrom(root_, key, &removed);
+    if (removed) {
+      Publish(std::move(root));
+      size_.fetch_sub(1);
+    }
+    return removed;
+  }
+
+  /** @return the number of keys in the tree */
+  auto Size() const -> size_t { return size_.load(); }
+
+  /** @return the bytes taken by the nodes of the current version, their out-of-line path prefixes and the values */
+  auto MemoryUsage() const -> size_t {
+    std::scoped_lock<std::mutex> lock(write_latch_);
+    return MemoryUsage(root_.get());
+  }
+
+ private:
+  using MutableNodePtr = std::shared_ptr<Node>;
+
+  static auto MakeLeaf(std::string_view prefix, V *value) -> MutableNodePtr {
+    auto leaf = std::make_shared<Node>(ArtNodeType::Leaf);
+    leaf->prefix_ = prefix;
+    leaf->value_ = std::make_shared<const V>(std::move(*value));
+    return leaf;
+  }
+
+  static auto MakeNode(ArtNodeType type) -> MutableNodePtr {
+    switch (type) {
+      case ArtNodeType::Leaf:
+        return std::make_shared<Node>(ArtNodeType::Leaf);
+      case ArtNodeType::Node4:
+        return std::make_shared<ArtNode4<V>>();
+      case ArtNodeType::Node16:
+        return std::make_shared<ArtNode16<V>>();
+      case ArtNodeType::Node48:
+        return std::make_shared<ArtNode48<V>>();
+      case ArtNodeType::Node256:
+        return std::make_shared<ArtNode256<V>>();
+    }
+    return nullptr;
+  }
+
+  /** @return a private copy of a node that shares its children and value */
+  static auto Clone(const Node &node) -> MutableNodePtr {
+    switch (node.type_) {
+      case ArtNodeType::Leaf:
+        return std::make_shared<Node>(node);
+      case ArtNodeType::Node4:
+        return std::make_shared<ArtNode4<V>>(static_cast<const ArtNode4<V> &>(node));
+      case ArtNodeType::Node16:
+        return std::make_shared<ArtNode16<V>>(static_cast<const ArtNode16<V> &>(node));
+      case ArtNodeType::Node48:
+        return std::make_shared<ArtNode48<V>>(static_cast<const ArtNode48<V> &>(node));
+      case ArtNodeType::Node256:
+        return std::make_shared<ArtNode256<V>>(static_cast<const ArtNode256<V> &>(node));
+    }
+    return nullptr;
+  }
+
+  /** Makes root the version readers see, and hands the one it replaces over for reclamation. */
+  void Publish(NodePtr root) {
+    NodePtr old_root = std::move(root_);
+    root_ = std::move(root);
+    published_root_.store(root_.get());
+    if (old_root != nullptr) {
+      epoch_manager_.Retire(std::move(old_root));
+    }
+  }
+
+  /** @return the new version of the subtree under node with the key inserted, or node itself if it was not */
+  static auto InsertInto(const NodePtr &node, std::string_view key, V *value, bool *inserted) -> NodePtr {
+    if (node == nullptr) {
+      return MakeLeaf(key, value);
+    }
+    size_t match = CommonPrefixLength(node->prefix_, key);
+    if (match < node->prefix_.size()) {
+      // The key leaves the compressed path midway, so a Node4 takes over the shared part of the path
+      auto parent = std::make_shared<ArtNode4<V>>();
+      parent->prefix_ = node->prefix_.substr(0, match);
+      MutableNodePtr suffix = Clone(*node);
+      suffix->prefix_.erase(0, match + 1);
+      InsertChild(parent.get(), static_cast<uint8_t>(node->prefix_[match]), std::move(suffix));
+      if (match == key.size()) {
+        parent->value_ = std::make_shared<const V>(std::move(*value));
+      } else {
+        InsertChild(parent.get(), static_cast<uint8_t>(key[match]), MakeLeaf(key.substr(match + 1), value));
+      }
+      return parent;
+    }
+    if (match == key.size()) {
+      if (node->value_ != nullptr) {
+        *inserted = false;
+        return node;
+      }
+      MutableNodePtr copy = Clone(*node);
+      copy->value_ = std::make_shared<const V>(std::move(*value));
+      return copy;
+    }
+    auto byte = static_cast<uint8_t>(key[match]);
+    const NodePtr *child = FindChild(node.get(), byte);
+    if (child == nullptr) {
+      // A full node grows into the next larger layout instead of being copied as it is
+      MutableNodePtr copy = node->num_children_ == Capacity(node->type_)
+                                ? ChangeType(*node, static_cast<ArtNodeType>(static_cast<uint8_t>(node->type_) + 1))
+                                : Clone(*node);
+      InsertChild(copy.get(), byte, MakeLeaf(key.substr(match + 1), value));
+      return copy;
+    }
+    NodePtr new_child = InsertInto(*child, key.substr(match + 1), value, inserted);
+    if (!*inserted) {
+      return node;
+    }
+    MutableNodePtr copy = Clone(*node);
+    *FindChild(copy.get(), byte) = std::move(new_child);
+    return copy;
+  }
+
+  /** @return the new version of the subtree under node with the key removed, or node itself if it had no value */
+  static auto RemoveFrom(const NodePtr &node, std::string_view key, bool *removed) -> NodePtr {
+    const std::string *prefix = node == nullptr ? nullptr : &node->prefix_;
+    if (prefix == nullptr || key.size() < prefix->size() || key.compare(0, prefix->size(), *prefix) != 0) {
+      *removed = false;
+      return node;
+    }
+    if (key.size() == prefix->size()) {
+      if (node->value_ == nullptr) {
+        *removed = false;
+        return node;
+      }
+      MutableNodePtr copy = Clone(*node);
+      copy->value_.reset();
+      return Normalize(std::move(copy));
+    }
+    auto byte = static_cast<uint8_t>(key[prefix->size()]);
+    const NodePtr *child = FindChild(node.get(), byte);
+    if (child == nullptr) {
+      *removed = false;
+      return node;
+    }
+    NodePtr new_child = RemoveFrom(*child, key.substr(prefix->size() + 1), removed);
+    if (!*removed) {
+      return node;
+    }
+    MutableNodePtr copy = Clone(*node);
+    // A child left without children and value is gone, so this node loses it and may need fixing in turn
+    if (new_child == nullptr) {
+      RemoveChild(copy.get(), byte);
+    } else {
+      *FindChild(copy.get(), byte) = std::move(new_child);
+    }
+    return Normalize(std::move(copy));
+  }
+
+  static auto CommonPrefixLength(std::string_view a, std::string_view b) -> size_t {
+    size_t length = std::min(a.size(), b.size());
+    return std::mismatch(a.begin(), a.begin() + length, b.begin()).first - a.begin();
+  }
+
+  static auto Capacity(ArtNodeType type) -> size_t {
+    switch (type) {
+      case ArtNodeType::Leaf:
+        return 0;
+      case ArtNodeType::Node4:
+        return 4;
+      case ArtNodeType::Node16:
+        return 16;
+      case ArtNodeType::Node48:
+        return 48;
+      case ArtNodeType::Node256:
+        return 256;
+    }
+    return 0;
+  }
+
+  /** @return the slot of the child labelled byte, nullptr if there is none */
+  static auto FindChild(const Node *node, uint8_t byte) -> const NodePtr * {
+    switch (node->type_) {
+      case ArtNodeType::Leaf:
+        return nullptr;
+      case ArtNodeType::Node4: {
+        const auto *node4 = static_cast<const ArtNode4<V> *>(node);
+        for (uint16_t i = 0; i < node4->num_children_; i++) {
+          if (node4->keys_[i] == byte) {
+            return &node4->children_[i];
+          }
+        }
+        return nullptr;
+      }
+      case ArtNodeType::Node16: {
+        const auto *node16 = static_cast<const ArtNode16<V> *>(node);
+#if defined(__SSE2__)
+        __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i *>(node16->keys_)));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches)) & ((1U << node16->num_children_) - 1);
+        return mask == 0 ? nullptr : &node16->children_[__builtin_ctz(mask)];
+#else
+        for (uint16_t i = 0; i < node16->num_children_; i++) {
+          if (node16->keys_[i] == byte) {
+            return &node16->children_[i];
+          }
+        }
+        return nullptr;
+#endif
+      }
+      case ArtNodeType::Node48: {
+        const auto *node48 = static_cast<const ArtNode48<V> *>(node);
+        uint8_t slot = node48->child_index_[byte];
+        return slot == 0 ? nullptr : &node48->children_[slot - 1];
+      }
+      case ArtNodeType::Node256: {
+        const auto *node256 = static_cast<const ArtNode256<V> *>(node);
+        return node256->children_[byte] == nullptr ? nullptr : &node256->children_[byte];
+      }
+    }
+    return nullptr;
+  }
+
+  /** @return the slot of the child labelled byte in a node that is not published yet */
+  static auto FindChild(Node *node, uint8_t byte) -> NodePtr * {
+    return const_cast<NodePtr *>(FindChild(static_cast<const Node *>(node), byte));
+  }
+
+  /** @return the child with the smallest label not below from, which is stored in label; nullptr if there is none */
+  static auto NextChild(const Node *node, int from, uint8_t *label) -> const Node * {
+    switch (node->type_) {
+      case ArtNodeType::Leaf:
+        return nullptr;
+      case ArtNodeType::Node4:
+      case ArtNodeType::Node16: {
+        const uint8_t *keys;
+        const NodePtr *children;
+        if (node->type_ == ArtNodeType::Node4) {
+          keys = static_cast<const ArtNode4<V> *>(node)->keys_;
+          children = static_cast<const ArtNode4<V> *>(node)->children_;
+        } else {
+          keys = static_cast<const ArtNode16<V> *>(node)->keys_;
+          children = static_cast<const ArtNode16<V> *>(node)->children_;
+        }
+        for (uint16_t i = 0; i < node->num_children_; i++) {
+          if (keys[i] >= from) {
+            *label = keys[i];
+            return children[i].get();
+          }
+        }
+        return nullptr;
+      }
+      case ArtNodeType::Node48: {
+        const auto *node48 = static_cast<const ArtNode48<V> *>(node);
+        for (int byte = from; byte < 256; byte++) {
+          if (node48->child_index_[byte] != 0) {
+            *label = static_cast<uint8_t>(byte);
+            return node48->children_[node48->child_index_[byte] - 1].get();
+          }
+        }
+        return nullptr;
+      }
+      case ArtNodeType::Node256: {
+        const auto *node256 = static_cast<const ArtNode256<V> *>(node);
+        for (int byte = from; byte < 256; byte++) {
+          if (node256->children_[byte] != nullptr) {
+            *label = static_cast<uint8_t>(byte);
+            return node256->children_[byte].get();
+          }
+        }
+        return nullptr;
+      }
+    }
+    return nullptr;
+  }
+
+  /** Calls visit(byte, child) for every child, in the order of the labels. */
+  template <typename Visitor>
+  static void ForEachChild(const Node *node, Visitor &&visit) {
+    switch (node->type_) {
+      case ArtNodeType::Leaf:
+        return;
+      case ArtNodeType::Node4: {
+        const auto *node4 = static_cast<const ArtNode4<V> *>(node);
+        for (uint16_t i = 0; i < node4->num_children_; i++) {
+          visit(node4->keys_[i], node4->children_[i]);
+        }
+        return;
+      }
+      case ArtNodeType::Node16: {
+        const auto *node16 = static_cast<const ArtNode16<V> *>(node);
+        for (uint16_t i = 0; i < node16->num_children_; i++) {
+          visit(node16->keys_[i], node16->children_[i]);
+        }
+        return;
+      }
+      case ArtNodeType::Node48: {
+        const auto *node48 = static_cast<const ArtNode48<V> *>(node);
+        for (int byte = 0; byte < 256; byte++) {
+          if (node48->child_index_[byte] != 0) {
+            visit(static_cast<uint8_t>(byte), node48->children_[node48->child_index_[byte] - 1]);
+          }
+        }
+        return;
+      }
+      case ArtNodeType::Node256: {
+        const auto *node256 = static_cast<const ArtNode256<V> *>(node);
+        for (int byte = 0; byte < 256; byte++) {
+          if (node256->children_[byte] != nullptr) {
+            visit(static_cast<uint8_t>(byte), node256->children_[byte]);
+          }
+        }
+        return;
+      }
+    }
+  }
+
+  /** Adds a child to a node that has room for it. Node4 and Node16 keep their labels sorted. */
+  static void InsertChild(Node *node, uint8_t byte, NodePtr child) {
+    switch (node->type_) {
+      case ArtNodeType::Leaf:
+        return;
+      case ArtNodeType::Node4:
+      case ArtNodeType::Node16: {
+        uint8_t *keys;
+        NodePtr *children;
+        if (node->type_ == ArtNodeType::Node4) {
+          keys = static_cast<ArtNode4<V> *>(node)->keys_;
+          children = static_cast<ArtNode4<V> *>(node)->children_;
+        } else {
+          keys = static_cast<ArtNode16<V> *>(node)->keys_;
+          children = static_cast<ArtNode16<V> *>(node)->children_;
+        }
+        uint16_t i = node->num_children_;
+        for (; i > 0 && keys[i - 1] > byte; i--) {
+          keys[i] = keys[i - 1];
+          children[i] = std::move(children[i - 1]);
+        }
+        keys[i] = byte;
+        children[i] = std::move(child);
+        break;
+      }
+      case ArtNodeType::Node48: {
+        auto *node48 = static_cast<ArtNode48<V> *>(node);
+        uint8_t slot = 0;
+        while (node48->children_[slot] != nullptr) {
+          slot++;
+        }
+        node48->children_[slot] = std::move(child);
+        node48->child_index_[byte] = slot + 1;
+        break;
+      }
+      case ArtNodeType::Node256:
+        static_cast<ArtNode256<V> *>(node)->children_[byte] = std::move(child);
+        break;
+    }
+    node->num_children_++;
+  }
+
+  /** Detaches the child labelled byte from a node. */
+  static auto RemoveChild(Node *node, uint8_t byte) -> NodePtr {
+    NodePtr child;
+    switch (node->type_) {
+      case ArtNodeType::Leaf:
+        return nullptr;
+      case ArtNodeType::Node4:
+      case ArtNodeType::Node16: {
+        uint8_t *keys;
+        NodePtr *children;
+        if (node->type_ == ArtNodeType::Node4) {
+          keys = static_cast<ArtNode4<V> *>(node)->keys_;
+          children = static_cast<ArtNode4<V> *>(node)->children_;
+        } else {
+          keys = static_cast<ArtNode16<V> *>(node)->keys_;
+          children = static_cast<ArtNode16<V> *>(node)->children_;
+        }
+        uint16_t i = 0;
+        while (keys[i] != byte) {
+          i++;
+        }
+        child = std::move(children[i]);
+        for (; i + 1 < node->num_children_; i++) {
+          keys[i] = keys[i + 1];
+          children[i] = std::move(children[i + 1]);
+        }
+        break;
+      }
+      case ArtNodeType::Node48: {
+        auto *node48 = static_cast<ArtNode48<V> *>(node);
+        child = std::move(node48->children_[node48->child_index_[byte] - 1]);
+        node48->child_index_[byte] = 0;
+        break;
+      }
+      case ArtNodeType::Node256:
+        child = std::move(static_cast<ArtNode256<V> *>(node)->children_[byte]);
+        break;
+    }
+    node->num_children_--;
+    return child;
+  }
+
+  /** @return a private copy of a node in another layout, holding the same path, value and children */
+  static auto ChangeType(const Node &node, ArtNodeType type) -> MutableNodePtr {
+    MutableNodePtr copy = MakeNode(type);
+    copy->prefix_ = node.prefix_;
+    copy->value_ = node.value_;
+    ForEachChild(&node, [&](uint8_t byte, const NodePtr &child) { InsertChild(copy.get(), byte, child); });
+    return copy;
+  }
+
+  /**
+   * Restores the invariants of a private node that lost its value or a child: a node without children or value is
+   * dropped, a node with neither value nor siblings for its only child is merged into that child, and a node that
+   * became sparse shrinks into a smaller layout.
+   */
+  static auto Normalize(MutableNodePtr node) -> NodePtr {
+    if (node->num_children_ == 0) {
+      if (node->value_ == nullptr) {
+        return nullptr;
+      }
+      return node->type_ == ArtNodeType::Leaf ? node : ChangeType(*node, ArtNodeType::Leaf);
+    }
+    if (node->num_children_ == 1 && node->value_ == nullptr) {
+      MutableNodePtr merged;
+      ForEachChild(node.get(), [&](uint8_t byte, const NodePtr &only_child) {
+        merged = Clone(*only_child);
+        merged->prefix_.insert(0, 1, static_cast<char>(byte));
+        merged->prefix_.insert(0, node->prefix_);
+      });
+      return merged;
+    }
+    // Shrink with some slack below the smaller capacity, so that a node does not flip between layouts
+    if ((node->type_ == ArtNodeType::Node256 && node->num_children_ <= 40) ||
+        (node->type_ == ArtNodeType::Node48 && node->num_children_ <= 12) ||
+        (node->type_ == ArtNodeType::Node16 && node->num_children_ <= 3)) {
+      return ChangeType(*node, static_cast<ArtNodeType>(static_cast<uint8_t>(node->type_) - 1));
+    }
+    return node;
+  }
+
+  static auto MemoryUsage(const Node *node) -> size_t {
+    if (node == nullptr) {
+      return 0;
+    }
+    size_t bytes = 0;
+    switch (node->type_) {
+      case ArtNodeType::Leaf:
+        bytes = sizeof(Node);
+        break;
+      case ArtNodeType::Node4:
+        bytes = sizeof(ArtNode4<V>);
+        break;
+      case ArtNodeType::Node16:
+        bytes = sizeof(ArtNode16<V>);
+        break;
+      case ArtNodeType::Node48:
+        bytes = sizeof(ArtNode48<V>);
+        break;
+      case ArtNodeType::Node256:
+        bytes = sizeof(ArtNode256<V>);
+        break;
+    }
+    // a prefix too long for the string's inline buffer lives on the heap
+    auto *prefix_object = reinterpret_cast<const char *>(&node->prefix_);
+    if (node->prefix_.data() < prefix_object || node->prefix_.data() >= prefix_object + sizeof(std::string)) {
+      bytes += node->prefix_.capacity() + 1;
+    }
+    if (node->value_ != nullptr) {
+      bytes += sizeof(V);
+    }
+    ForEachChild(node, [&](uint8_t, const NodePtr &child) { bytes += MemoryUsage(child.get()); });
+    return bytes;
+  }
+
+  // Serializes writers, which own root_
+  mutable std::mutex write_latch_;
+  NodePtr root_;
+  // The root readers start from, always root_ once a writer is done
+  std::atomic<const Node *> published_root_{nullptr};
+  std::atomic<size_t> size_{0};
+  mutable EpochManager epoch_manager_;
+};
+
+}  // namespace bustub
@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/extent_allocator.h"
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_bucket_page.h"
@@ -29,7 +30,9 @@ namespace bustub {
 /**
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
- * table grows/shrinks dynamically as buckets become full/empty.
+ * table grows/shrinks dynamically as buckets become full/empty. A full bucket
+ * that splitting cannot relieve, because all its entries share one key or the
+ * directory cannot grow any more, takes overflow pages instead.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class DiskExtendibleHashTable {
@@ -40,9 +43,11 @@ class DiskExtendibleHashTable {
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
    * @param hash_fn the hash function
+   * @param io_owner the object that I/O on the pages of the hash table is attributed to
    */
   explicit DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                   const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+                                   const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                                   IOObject io_owner = {});
 
   /**
    * Inserts a key-value pair into the hash table.
@@ -50,7 +55,7 @@ class DiskExtendibleHashTable {
    * @param transaction the current transaction
    * @param key the key to create
    * @param value the value to be associated with the key
-   * @return true if insert succeeded, false otherwise
+   * @return true if insert succeeded, false if the pair is already present
    */
   auto Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool;
 
@@ -137,7 +142,8 @@ class DiskExtendibleHashTable {
   auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
 
   /**
-   * Performs insertion with an optional bucket splitting.
+   * Performs insertion with an optional bucket splitting. Called by Insert without any latch held, it takes the
+   * table latch exclusively.
    *
    * @param transaction a pointer to the current transaction
    * @param key the key to insert
@@ -146,9 +152,34 @@ class DiskExtendibleHashTable {
    */
   auto SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool;
 
+  /**
+   * Collects the values of a key from a bucket page and its overflow chain.
+   *
+   * @return true if at least one value was found
+   */
+  auto ChainGetValue(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Inserts a pair into the first page of a bucket's chain that has room for it.
+   *
+   * @param[out] full set if the pair is new but every page of the chain is full
+   * @return whether the pair was inserted
+   */
+  auto ChainInsert(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, const ValueType &value, bool *full)
+      -> bool;
+
+  /** Inserts a pair known to be new into a bucket's chain, appending an overflow page if every page is full. */
+  void AppendToChain(HASH_TABLE_BUCKET_TYPE *bucket_page, const KeyType &key, const ValueType &value);
+
+  /** @return whether every entry of a bucket's chain has the same key, so that no split can separate them */
+  auto ChainHasSingleKey(HASH_TABLE_BUCKET_TYPE *bucket_page) -> bool;
+
+  /** Unlinks the empty overflow pages of a bucket's chain and deletes them. */
+  void DropEmptyOverflowPages(HASH_TABLE_BUCKET_TYPE *bucket_page);
+
   /**
    * Optionally merges an empty bucket into it's pair.  This is called by Remove,
-   * if Remove makes a bucket empty.
+   * if Remove makes a bucket empty, without any latch held; it takes the table latch exclusively.
    *
    * There are three conditions under which we skip the merge:
    * 1. The bucket is no longer empty.
@@ -164,9 +195,12 @@ class DiskExtendibleHashTable {
   // member variables
   page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
+  // creates the directory and bucket pages in extents of their own
+  ExtentAllocator extent_allocator_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
+  // Readers includes inserts and removes, writers are splits and merges. Readers latch the bucket page they access,
+  // writers have the whole table to themselves and latch no pages
   ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
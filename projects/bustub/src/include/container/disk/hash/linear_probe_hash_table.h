@@ -29,7 +29,12 @@ namespace bustub {
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
- * table dynamically grows once full.
+ * table dynamically grows once half of its slots are occupied.
+ *
+ * Growing is incremental: a resize allocates a new header page and block pages
+ * twice the size, and every later insert and remove migrates a few slots of the
+ * old table into the new one before doing its own work. Until the old table is
+ * drained, inserts go to the new table while lookups and removes consult both.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
@@ -41,16 +46,18 @@ class LinearProbeHashTable {
    * @param comparator comparator for keys
    * @param num_buckets initial number of buckets contained by this hash table
    * @param hash_fn the hash function
+   * @param migrate_slots number of old slots each operation migrates while the table is being resized
    */
   explicit LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn);
+                                const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn,
+                                size_t migrate_slots = HASH_TABLE_MIGRATE_SLOTS);
 
   /**
    * Inserts a key-value pair into the hash table.
    * @param transaction the current transaction
    * @param key the key to create
    * @param value the value to be associated with the key
-   * @return true if insert succeeded, false otherwise
+   * @return true if insert succeeded, false if the pair is already present or the table is full and cannot grow
    */
   auto Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool;
 
@@ -73,31 +80,73 @@ class LinearProbeHashTable {
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. The new table is allocated right away, but the
+   * entries are migrated by the operations that follow. A resize still in progress is finished first.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
 
   /**
    * Gets the size of the hash table
-   * @return current size of the hash table
+   * @return current size of the hash table, the new one while a resize is in progress
    */
   auto GetSize() -> size_t;
 
+  /**
+   * @return whether a resize is still migrating entries out of the old table
+   */
+  auto IsResizing() -> bool;
+
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
-  auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
-  void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
-  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
-  void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
-  auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
+  auto FetchHeaderPage(page_id_t header_page_id) -> HashTableHeaderPage *;
+  auto FetchBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
+
+  /**
+   * Allocates a header page and num_blocks empty block pages.
+   * @return the page id of the new header page
+   */
+  auto CreateTable(size_t num_blocks) -> page_id_t;
+
+  /** Deletes the header page and all block pages of a table. */
+  void DeleteTable(page_id_t header_page_id);
+
+  /**
+   * Probes the table linearly from the slot the key hashes to, calling visit(block_page, slot) on each slot until it
+   * returns true, a never occupied slot has been visited or the probe wrapped around.
+   * @return whether visit returned true
+   */
+  template <typename Visitor>
+  auto Probe(page_id_t header_page_id, const KeyType &key, bool is_dirty, Visitor &&visit) -> bool;
+
+  /** Inserts into the first never occupied slot of the probe sequence. Tombstones are not reused. */
+  auto ProbeInsert(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool;
+  auto ProbeFind(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Allocates a table at least twice initial_size and makes it the one inserts go to. Does nothing if the header page
+   * cannot address a larger table. Called with the table latch held exclusively.
+   */
+  void StartResize(size_t initial_size);
+
+  /**
+   * Moves the readable entries of the next num_slots slots of the old table into the new one, leaving tombstones
+   * behind, and drops the old table once all of its slots are migrated. Called with the table latch held exclusively.
+   */
+  void MigrateSlots(size_t num_slots);
 
   // member variable
   page_id_t header_page_id_;
+  // table still being migrated into header_page_id_'s, INVALID_PAGE_ID if no resize is in progress
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  // the next slot of the old table to migrate
+  size_t migrate_next_{0};
+  // occupied slots of the current table, tombstones included, which decides when to grow
+  size_t num_occupied_{0};
+  size_t migrate_slots_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers are lookups, writers are inserts and removes, which migrate entries while a resize is in progress
   ReaderWriterLatch table_latch_;
 
   // Hash function
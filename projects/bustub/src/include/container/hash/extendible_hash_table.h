@@ -17,18 +17,28 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "container/hash/hash_table.h"
 
 namespace bustub {
 
 /**
  * ExtendibleHashTable implements a hash table using the extendible hashing algorithm.
+ *
+ * Buckets keep their entries in a contiguous array next to a one byte fingerprint of each key, which a lookup compares
+ * 16 at a time with SSE2 before comparing any key. Every bucket has its own reader-writer latch. The directory is read
+ * without any latch: splits bump a version counter before and after they rewrite it, and a reader that latched a
+ * bucket while the version changed retries. Splits are serialized by the table latch; buckets are never freed, so a
+ * reader holding a stale bucket pointer can still latch it safely.
+ *
  * @tparam K key type
  * @tparam V value type
  */
@@ -63,12 +73,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
    */
   auto GetNumBuckets() const -> int;
 
-  /**
-   * @brief Increment depth of the global.
-   * @return The depth of global.
-   */
-  void IncrementGlobalDepth();
-
   /**
    * @brief Get the number of directory.
    * @return The number of directory.
@@ -81,7 +85,7 @@ class ExtendibleHashTable : public HashTable<K, V> {
    *
    * @brief Find the value associated with the given key.
    *
-   * Use IndexOf(key) to find the directory index the key hashes to.
+   * Use LatchBucket(key, false) to find and latch the bucket the key hashes to.
    *
    * @param key The key to be searched.
    * @param[out] value The value associated with the key.
@@ -125,7 +129,7 @@ class ExtendibleHashTable : public HashTable<K, V> {
     explicit Bucket(size_t size, int depth = 0);
 
     /** @brief Check if a bucket is full. */
-    inline auto IsFull() const -> bool { return list_.size() == size_; }
+    inline auto IsFull() const -> bool { return items_.size() == size_; }
 
     /** @brief Get the local depth of the bucket. */
     inline auto GetDepth() const -> int { return depth_; }
@@ -133,12 +137,12 @@ class ExtendibleHashTable : public HashTable<K, V> {
     /** @brief Increment the local depth of a bucket. */
     inline void IncrementDepth() { depth_++; }
 
-    inline auto GetItems() -> std::list<std::pair<K, V>> & { return list_; }
+    inline auto GetItems() -> std::vector<std::pair<K, V>> & { return items_; }
+
+    /** @brief The latch a reader holds shared and a writer exclusively while accessing the bucket. */
+    inline auto GetLatch() -> ReaderWriterLatch & { return latch_; }
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Find the value associated with the given key in the bucket.
      * @param key The key to be searched.
      * @param[out] value The value associated with the key.
@@ -147,74 +151,83 @@ class ExtendibleHashTable : public HashTable<K, V> {
     auto Find(const K &key, V &value) -> bool;
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
-     * @brief Given the key, remove the corresponding key-value pair in the bucket.
+     * @brief Given the key, remove the corresponding key-value pair in the bucket. The last entry takes its place.
      * @param key The key to be deleted.
      * @return True if the key exists, false otherwise.
      */
     auto Remove(const K &key) -> bool;
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Insert the given key-value pair into the bucket.
      *      1. If a key already exists, the value should be updated.
      *      2. If the bucket is full, do nothing and return false.
      * @param key The key to be inserted.
      * @param value The value to be inserted.
-     * @return True if the key-value pair is inserted, false otherwise.
+     * @return True if the key-value pair is inserted or updated, false otherwise.
      */
     auto Insert(const K &key, const V &value) -> bool;
 
    private:
-    // TODO(student): You may add additional private members and helper functions
+    /** @return the index of the entry with the given key, or -1 if there is none */
+    auto IndexOf(const K &key, uint8_t fingerprint) const -> int;
+
     size_t size_;
     int depth_;
-    std::list<std::pair<K, V>> list_;
-    // size_t bucket_id_;
+    // fingerprints_[i] is the fingerprint of items_[i]'s key, padded to a multiple of 16 so that SIMD loads stay inside
+    std::vector<uint8_t> fingerprints_;
+    std::vector<std::pair<K, V>> items_;
+    ReaderWriterLatch latch_;
   };
 
  private:
-  // TODO(student): You may add additional private members and helper functions and remove the ones
-  // you don't need.
+  /**
+   * A directory of 2^global_depth bucket pointers. A directory that has to double is replaced by a new one, so that
+   * the global depth of a directory never changes and lock-free readers never see its slots move.
+   */
+  struct Directory {
+    explicit Directory(int global_depth)
+        : global_depth_(global_depth), slots_(std::make_unique<std::atomic<Bucket *>[]>(size_t{1} << global_depth)) {}
+    auto Size() const -> size_t { return size_t{1} << global_depth_; }
 
-  int global_depth_;    // The global depth of the directory
-  size_t bucket_size_;  // The size of a bucket
-  int num_buckets_;     // The number of buckets in the hash table
-  mutable std::recursive_mutex latch_;
-  std::vector<std::shared_ptr<Bucket>> dir_;  // The directory of the hash table
+    const int global_depth_;
+    std::unique_ptr<std::atomic<Bucket *>[]> slots_;
+  };
 
-  // The following functions are completely optional, you can delete them if you have your own ideas.
+  size_t bucket_size_;            // The size of a bucket
+  std::atomic<Directory *> dir_;  // The directory of the hash table
+  // Even while the directory is stable, odd while a split rewrites it
+  std::atomic<uint64_t> version_{0};
+  // Serializes splits and guards buckets_ and directories_
+  mutable std::mutex latch_;
+  // Every bucket and directory ever created. Readers may still hold pointers to old ones, so they live as long as the
+  // table; directories double in size, so the old ones take no more memory than the current one
+  std::vector<std::unique_ptr<Bucket>> buckets_;
+  std::vector<std::unique_ptr<Directory>> directories_;
 
   /**
-   * @brief Redistribute the kv pairs in a full bucket.
-   * @param bucket The bucket to be redistributed.
+   * @brief Latch the bucket the key hashes to, reading the directory without any latch.
+   * @param key The key to be hashed.
+   * @param exclusive Whether to latch the bucket exclusively.
+   * @return The bucket, latched. It stays the bucket of the key until it is unlatched.
    */
-  auto RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void;
-
-  auto RehashDirectoryPointers(std::shared_ptr<Bucket> first, std::shared_ptr<Bucket> second, size_t index,
-                               int local_depth, int global_depth) -> void;
+  auto LatchBucket(const K &key, bool exclusive) -> Bucket *;
 
-  auto SplitAndRehash(std::shared_ptr<Bucket> bucket, size_t index, int local_depth, int global_depth) -> void;
-
-  auto GetSpecifiedBit(size_t n, int k) -> int;
-  /*****************************************************************
-   * Must acquire latch_ first before calling the below functions. *
-   *****************************************************************/
+  /**
+   * @brief Split the bucket the key hashes to if it is still full, doubling the directory if needed.
+   * @param key The key that did not fit into its bucket.
+   */
+  void SplitBucket(const K &key);
 
   /**
    * @brief For the given key, return the entry index in the directory where the key hashes to.
    * @param key The key to be hashed.
+   * @param dir The directory to index.
    * @return The entry index in the directory.
    */
-  auto IndexOf(const K &key) -> size_t;
+  static auto IndexOf(const K &key, const Directory *dir) -> size_t;
 
-  auto GetGlobalDepthInternal() const -> int;
-  auto GetLocalDepthInternal(int dir_index) const -> int;
-  auto GetNumBucketsInternal() const -> int;
+  /** @return the one byte fingerprint of the key, taken from the high bits of its scrambled hash */
+  static auto FingerprintOf(const K &key) -> uint8_t;
 };
 
 }  // namespace bustub
@@ -12,6 +12,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "common/rid.h"
@@ -23,7 +31,14 @@
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table. It fetches RIDs from the index one batch at a time and
+ * holds no index latch in between, so that the operators above it may modify the same index.
+ *
+ * It also executes index-only scans, which build their tuples from the index entries instead of the table heap.
+ *
+ * A plan with parallelism above 1 splits the range into sub-ranges. A worker thread per sub-range reads the index
+ * and materializes the tuples, queueing a few batches ahead; Next drains the sub-ranges in order, so the tuples still
+ * come out in key order.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -35,6 +50,9 @@ class IndexScanExecutor : public AbstractExecutor {
    */
   IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan);
 
+  /** Stops and joins the worker threads of a parallel scan. */
+  ~IndexScanExecutor() override;
+
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
   void Init() override;
@@ -42,7 +60,47 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** A batch of tuples with their RIDs, read from one sub-range. */
+  using Batch = std::pair<std::vector<RID>, std::vector<Tuple>>;
+
+  /** The batches read ahead from one sub-range by its worker thread. */
+  struct Partition {
+    std::unique_ptr<IndexRangeScan> scan_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Batch> batches_;
+    bool done_{false};
+    std::thread worker_;
+  };
+
+  /** Read the next batch of a scan and materialize its tuples. @return false if the scan is exhausted */
+  auto FetchBatch(IndexRangeScan *scan, Batch *batch) -> bool;
+
+  /** Fill the queue of a partition until its scan is exhausted or the executor stops. */
+  void RunWorker(Partition *partition);
+
+  /** Stop the workers and drop the partitions. */
+  void StopWorkers();
+
+  /** Build a tuple in the table layout from an index entry. */
+  auto MakeIndexOnlyTuple(const Tuple &entry) const -> Tuple;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The table the index belongs to */
+  TableInfo *table_info_{nullptr};
+  /** The ongoing range scan of the index, for a serial scan */
+  std::unique_ptr<IndexRangeScan> scan_;
+  /** The sub-ranges of a parallel scan in key order, and the one being drained */
+  std::vector<std::unique_ptr<Partition>> partitions_;
+  size_t partition_cursor_{0};
+  std::atomic<bool> stopped_{false};
+  /** The current batch and the position of the next tuple to emit */
+  Batch batch_;
+  size_t cursor_{0};
+  /** For an index-only scan: the entry column of every table column, if any */
+  bool index_only_{false};
+  std::vector<std::optional<uint32_t>> entry_columns_;
+  const Schema *entry_schema_{nullptr};
 };
 }  // namespace bustub
@@ -28,7 +28,9 @@
 namespace bustub {
 
 /**
- * IndexJoinExecutor executes index join operations.
+ * IndexJoinExecutor executes index join operations. It pulls the outer tuples in batches and looks up the join keys
+ * of a whole batch in the inner index at once, so that the index can share its descent between neighbouring keys.
+ * The output follows the order of the outer tuples.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -48,7 +50,18 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Join the next batch of outer tuples. @return false if the outer table is exhausted */
+  auto JoinNextBatch() -> bool;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The executor of the outer table */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The inner table and its index */
+  TableInfo *inner_table_info_{nullptr};
+  IndexInfo *index_info_{nullptr};
+  /** The joined tuples of the current batch and the position of the next one to emit */
+  std::vector<Tuple> results_;
+  size_t cursor_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// like_expression.h
+//
+// Identification: src/include/execution/expressions/like_expression.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "fmt/format.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * LikeExpression matches a string against a SQL LIKE pattern, in which % stands for any sequence of characters, _ for
+ * any single character, and a backslash makes the character after it stand for itself.
+ */
+class LikeExpression : public AbstractExpression {
+ public:
+  /** Creates a new like expression representing (input [NOT] LIKE pattern). */
+  LikeExpression(AbstractExpressionRef input, AbstractExpressionRef pattern, bool negated)
+      : AbstractExpression({std::move(input), std::move(pattern)}, TypeId::BOOLEAN), negated_{negated} {}
+
+  auto Evaluate(const Tuple *tuple, const Schema &schema) const -> Value override {
+    Value input = GetChildAt(0)->Evaluate(tuple, schema);
+    Value pattern = GetChildAt(1)->Evaluate(tuple, schema);
+    return PerformMatch(input, pattern);
+  }
+
+  auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
+                    const Schema &right_schema) const -> Value override {
+    Value input = GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    Value pattern = GetChildAt(1)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    return PerformMatch(input, pattern);
+  }
+
+  /** @return the string representation of the expression node and its children */
+  auto ToString() const -> std::string override {
+    return fmt::format("({} {} {})", *GetChildAt(0), negated_ ? "NOT LIKE" : "LIKE", *GetChildAt(1));
+  }
+
+  BUSTUB_EXPR_CLONE_WITH_CHILDREN(LikeExpression);
+
+  /**
+   * Split a pattern into the literal characters every match starts with and the rest, which begins at the first
+   * wildcard. A pattern whose rest is "%" matches exactly the strings that start with the literal prefix; one without
+   * a rest matches only the prefix itself.
+   * @param pattern the LIKE pattern
+   * @param[out] rest the part of the pattern after the literal prefix
+   * @return the literal prefix, with its escapes resolved
+   */
+  static auto LiteralPrefix(std::string_view pattern, std::string_view *rest) -> std::string {
+    std::string prefix;
+    size_t i = 0;
+    for (; i < pattern.size() && pattern[i] != '%' && pattern[i] != '_'; i++) {
+      if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+        i++;
+      }
+      prefix.push_back(pattern[i]);
+    }
+    *rest = pattern.substr(i);
+    return prefix;
+  }
+
+  /** @return whether input matches pattern */
+  static auto Match(std::string_view input, std::string_view pattern) -> bool {
+    size_t i = 0;
+    size_t p = 0;
+    // Where matching resumes if the characters after the last % fail: one more input character swallowed by the %
+    size_t star_p = std::string_view::npos;
+    size_t star_i = 0;
+    while (i < input.size()) {
+      if (p < pattern.size() && pattern[p] == '%') {
+        star_p = ++p;
+        star_i = i;
+        continue;
+      }
+      if (p < pattern.size()) {
+        bool escaped = pattern[p] == '\\' && p + 1 < pattern.size();
+        char c = escaped ? pattern[p + 1] : pattern[p];
+        if ((!escaped && c == '_') || c == input[i]) {
+          p += escaped ? 2 : 1;
+          i++;
+          continue;
+        }
+      }
+      if (star_p == std::string_view::npos) {
+        return false;
+      }
+      p = star_p;
+      i = ++star_i;
+    }
+    while (p < pattern.size() && pattern[p] == '%') {
+      p++;
+    }
+    return p == pattern.size();
+  }
+
+  /** Whether this is NOT LIKE. */
+  bool negated_;
+
+ private:
+  auto PerformMatch(const Value &input, const Value &pattern) const -> Value {
+    if (input.IsNull() || pattern.IsNull()) {
+      return ValueFactory::GetBooleanValue(CmpBool::CmpNull);
+    }
+    return ValueFactory::GetBooleanValue(Match(input.ToString(), pattern.ToString()) != negated_);
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_plan.h
+//
+// Identification: src/include/execution/plans/index_only_scan_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "execution/plans/index_scan_plan.h"
+
+namespace bustub {
+/**
+ * IndexOnlyScanPlanNode is an index scan that answers from the index entries alone and never reads the table heap.
+ * It produces tuples in the layout of the table, so the expressions above it need no rewriting, but only the key and
+ * included columns of the index are filled in; the other columns are NULL. The optimizer only picks it when no
+ * operator above reads those columns.
+ */
+class IndexOnlyScanPlanNode : public IndexScanPlanNode {
+ public:
+  /**
+   * Creates a new index-only scan plan node.
+   * @param output the output format of this scan plan node, the schema of the table
+   * @param index_scan the index scan to answer from the index entries
+   */
+  IndexOnlyScanPlanNode(SchemaRef output, const IndexScanPlanNode &index_scan)
+      : IndexScanPlanNode(std::move(output), index_scan.index_oid_, index_scan.reverse_, index_scan.lower_bound_,
+                          index_scan.lower_inclusive_, index_scan.upper_bound_, index_scan.upper_inclusive_) {
+    parallelism_ = index_scan.parallelism_;
+  }
+
+  auto GetType() const -> PlanType override { return PlanType::IndexOnlyScan; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexOnlyScanPlanNode);
+
+ protected:
+  auto PlanNodeToString() const -> std::string override {
+    auto index_scan = IndexScanPlanNode::PlanNodeToString();
+    return "IndexOnly" + index_scan.substr(std::string("Index").size());
+  }
+};
+
+}  // namespace bustub
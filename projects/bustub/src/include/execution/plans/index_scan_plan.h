@@ -21,7 +21,8 @@
 
 namespace bustub {
 /**
- * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ * IndexScanPlanNode identifies a table that should be scanned through one of its indexes, optionally restricted to
+ * a range of keys. The bounds are constant expressions over the single key column of the index.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -29,25 +30,64 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param reverse whether to scan the index from the largest key to the smallest
+   * @param lower_bound the smallest key to scan, nullptr if unbounded
+   * @param lower_inclusive whether keys equal to the lower bound are scanned
+   * @param upper_bound the largest key to scan, nullptr if unbounded
+   * @param upper_inclusive whether keys equal to the upper bound are scanned
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, bool reverse = false,
+                    AbstractExpressionRef lower_bound = nullptr, bool lower_inclusive = true,
+                    AbstractExpressionRef upper_bound = nullptr, bool upper_inclusive = true)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        reverse_(reverse),
+        lower_bound_(std::move(lower_bound)),
+        lower_inclusive_(lower_inclusive),
+        upper_bound_(std::move(upper_bound)),
+        upper_inclusive_(upper_inclusive) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return true if the index is scanned in descending key order */
+  auto IsReverse() const -> bool { return reverse_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** Whether the index is scanned in descending key order. */
+  bool reverse_;
+
+  /** The key range to scan; a nullptr bound leaves that side open. */
+  AbstractExpressionRef lower_bound_;
+  bool lower_inclusive_;
+  AbstractExpressionRef upper_bound_;
+  bool upper_inclusive_;
+
+  /** The number of sub-ranges scanned concurrently, 1 for a serial scan. Set by the optimizer. */
+  size_t parallelism_{1};
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    std::string attributes = fmt::format("index_oid={}", index_oid_);
+    if (lower_bound_ != nullptr || upper_bound_ != nullptr) {
+      attributes += fmt::format(", range={}{}, {}{}", lower_inclusive_ ? "[" : "(",
+                                lower_bound_ == nullptr ? "-inf" : lower_bound_->ToString(),
+                                upper_bound_ == nullptr ? "+inf" : upper_bound_->ToString(),
+                                upper_inclusive_ ? "]" : ")");
+    }
+    if (reverse_) {
+      attributes += ", reverse=true";
+    }
+    if (parallelism_ > 1) {
+      attributes += fmt::format(", parallel={}", parallelism_);
+    }
+    return fmt::format("IndexScan {{ {} }}", attributes);
   }
 };
 
@@ -80,13 +80,34 @@ class Optimizer {
   /** @brief check if the predicate is true::boolean */
   auto IsPredicateTrue(const AbstractExpression &expr) -> bool;
 
+  /**
+   * @brief optimize a filter over a table scan as a range scan of an index, if the filter bounds an indexed column
+   * by constants
+   */
+  auto OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /**
    * @brief optimize order by as index scan if there's an index on a table
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
-  /** @brief check if the index can be matched */
-  auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
+  /**
+   * @brief optimize an index scan whose key and included columns hold every column read by the projection or
+   * aggregation above it as an index-only scan, which never visits the table heap
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief scan the range of an index scan feeding an aggregation as several sub-ranges in parallel, since the
+   * aggregation consumes the whole range anyway, unless the table is too small to give every worker a batch
+   */
+  auto OptimizeParallelIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief check if the index can be matched. Point lookups prefer a hash index, which reads one bucket page per key
+   * instead of descending a tree; any other scan needs an ordered index.
+   */
+  auto MatchIndex(const std::string &table_name, uint32_t index_key_idx, bool point_lookup = true)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
 
   /**
@@ -95,8 +116,8 @@ class Optimizer {
   auto OptimizeSortLimitAsTopN(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
   /**
-   * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. BusTub
-   * doesn't support statistics for now, so it's the only way for you to get the table size :(
+   * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. Tables
+   * without a size in their name fall back to the entry count of one of their indexes, if they have any.
    *
    * @param table_name
    * @return std::optional<size_t>
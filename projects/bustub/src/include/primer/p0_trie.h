@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <any>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -21,7 +22,7 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
-#include "common/rwlatch.h"
+#include "container/art/adaptive_radix_tree.h"
 
 namespace bustub {
 
@@ -253,32 +254,31 @@ class TrieNodeWithValue : public TrieNode {
   T GetValue() const { return value_; }
 };
 
+/** TrieIterator visits keys of a Trie in key order; Value() holds the std::any stored for the key. */
+using TrieIterator = AdaptiveRadixTree<std::any>::Iterator;
+
 /**
  * Trie is a concurrent key-value store. Each key is a string and its corresponding
  * value can be any type.
+ *
+ * The keys are stored in an adaptive radix tree rather than in a tree of TrieNode: children are kept in node layouts
+ * sized for 4, 16, 48 or 256 of them instead of a hash map, and chains of single-child nodes are collapsed into one
+ * node. Values are kept in std::any, whose type is checked without dynamic_cast.
+ *
+ * Writers copy the path they change and publish a new version of the tree, so readers take no latch at all.
  */
 class Trie {
  private:
-  /* Root node of the trie */
-  std::unique_ptr<TrieNode> root_;
-  /* Read-write lock for the trie */
-  ReaderWriterLatch latch_;
+  /* Keys and their values, which serializes writers itself */
+  AdaptiveRadixTree<std::any> tree_;
 
  public:
   /**
-   * TODO(P0): Add implementation
-   *
-   * @brief Construct a new Trie object. Initialize the root node with '\0'
-   * character.
+   * @brief Construct a new, empty Trie object.
    */
-  Trie() {
-    this->root_ = std::make_unique<TrieNode>('\0');
-    // LOG_INFO("#Trie:constructor = %c", this->root_->GetKeyChar());
-  }
+  Trie() = default;
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Insert key-value pair into the trie.
    *
    * If the key is an empty string, return false immediately.
@@ -286,18 +286,6 @@ class Trie {
    * If the key already exists, return false. Duplicated keys are not allowed and
    * you should never overwrite value of an existing key.
    *
-   * When you reach the ending character of a key:
-   * 1. If TrieNode with this ending character does not exist, create new TrieNodeWithValue
-   * and add it to parent node's children_ map.
-   * 2. If the terminal node is a TrieNode, then convert it into TrieNodeWithValue by
-   * invoking the appropriate constructor.
-   * 3. If it is already a TrieNodeWithValue,
-   * then insertion fails and returns false. Do not overwrite existing data with new data.
-   *
-   * You can quickly check whether a TrieNode pointer holds TrieNode or TrieNodeWithValue
-   * by checking the is_end_ flag. If is_end_ == false, then it points to TrieNode. If
-   * is_end_ == true, it points to TrieNodeWithValue.
-   *
    * @param key Key used to traverse the trie and find the correct node
    * @param value Value to be inserted
    * @return True if insertion succeeds, false if the key already exists
@@ -307,65 +295,14 @@ class Trie {
     if (key.empty()) {
       return false;
     }
-
-    latch_.WLock();
-    TrieNode *cur = this->root_.get();
-    for (size_t i = 0; i < key.size(); i++) {
-      if (i < key.size() - 1) {
-        if (!cur->HasChild(key[i])) {
-          TrieNode node(key[i]);
-          std::unique_ptr<TrieNode> new_node_ptr(new TrieNode(std::move(node)));
-          cur->InsertChildNode(key[i], std::move(new_node_ptr));
-        }
-        cur = cur->GetChildNode(key[i])->get();
-      } else {
-        //  1. If TrieNode with this ending character does not exist, create new TrieNodeWithValue
-        // and add it to parent node's children_ map.
-        if (!cur->HasChild(key[i])) {
-          TrieNodeWithValue<T> node(key[i], value);
-          node.SetEndNode(true);
-          std::unique_ptr<TrieNodeWithValue<T>> new_node_ptr(new TrieNodeWithValue<T>(std::move(node), value));
-          cur->InsertChildNode(key[i], std::move(new_node_ptr));
-          break;
-        }
-
-        if (cur->HasChild(key[i])) {
-          // 2. If the terminal node is a TrieNode, then convert it into TrieNodeWithValue by
-          // invoking the appropriate constructor.
-          auto terminal_node = dynamic_cast<TrieNodeWithValue<T> *>((*cur->GetChildNode(key[i])).get());
-          if (terminal_node == nullptr) {
-            TrieNodeWithValue<T> node(std::move(*(*cur->GetChildNode(key[i]))), value);
-            std::unique_ptr<TrieNodeWithValue<T>> new_node_ptr(new TrieNodeWithValue<T>(std::move(node), value));
-            cur->RemoveChildNode(key[i]);
-            cur->InsertChildNode(key[i], std::move(new_node_ptr));
-            latch_.WUnlock();
-            return true;
-          }
-          // 3. If it is already a TrieNodeWithValue,
-          // then insertion fails and returns false. Do not overwrite existing data with new data.
-          latch_.WUnlock();
-          return false;
-        }
-      }
-    }
-    latch_.WUnlock();
-    return true;
+    return tree_.Insert(key, std::any(std::move(value)));
   }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Remove key value pair from the trie.
-   * This function should also remove nodes that are no longer part of another
+   * This function also removes nodes that are no longer part of another
    * key. If key is empty or not found, return false.
    *
-   * You should:
-   * 1) Find the terminal node for the given key.
-   * 2) If this terminal node does not have any children, remove it from its
-   * parent's children_ map.
-   * 3) Recursively remove nodes that have no children and are not terminal node
-   * of another key.
-   *
    * @param key Key used to traverse the trie and find the correct node
    * @return True if the key exists and is removed, false otherwise
    */
@@ -373,77 +310,44 @@ class Trie {
     if (key.empty()) {
       return false;
     }
-
-    latch_.WLock();
-    TrieNode *cur = this->root_.get();
-    std::vector<TrieNode *> nodes;
-    for (char c : key) {
-      nodes.push_back(cur);
-      if (!cur->HasChild(c)) {
-        latch_.WUnlock();
-        return false;
-      }
-      cur = (*cur->GetChildNode(c)).get();
-    }
-    cur->SetEndNode(false);
-    while (!nodes.empty()) {
-      if (!cur->HasChildren()) {
-        TrieNode *parent = nodes.back();
-        parent->RemoveChildNode(cur->GetKeyChar());
-        nodes.pop_back();
-        cur = parent;
-        continue;
-      }
-      break;
-    }
-    latch_.WUnlock();
-    return true;
+    return tree_.Remove(key);
   }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Get the corresponding value of type T given its key.
    * If key is empty, set success to false.
    * If key does not exist in trie, set success to false.
-   * If the given type T is not the same as the value type stored in TrieNodeWithValue
-   * (ie. GetValue<int> is called but terminal node holds std::string),
+   * If the given type T is not the same as the value type stored for the key
+   * (ie. GetValue<int> is called but the key holds std::string),
    * set success to false.
    *
-   * To check whether the two types are the same, dynamic_cast
-   * the terminal TrieNode to TrieNodeWithValue<T>. If the casted result
-   * is not nullptr, then type T is the correct type.
-   *
    * @param key Key used to traverse the trie and find the correct node
    * @param success Whether GetValue is successful or not
    * @return Value of type T if type matches
    */
   template <typename T>
   T GetValue(const std::string &key, bool *success) {
-    latch_.RLock();
-    TrieNode *cur = this->root_.get();
-    for (size_t i = 0; i < key.size(); i++) {
-      if (i < key.size() - 1) {
-        if (!cur->HasChild(key[i])) {
-          break;
-        }
-        cur = cur->GetChildNode(key[i])->get();
-      } else {
-        if (!cur->HasChild(key[i])) {
-          break;
-        }
-        auto value_node = dynamic_cast<TrieNodeWithValue<T> *>((*cur->GetChildNode(key[i])).get());
-        if (cur->HasChild(key[i]) && value_node != nullptr) {
-          *success = true;
-          latch_.RUnlock();
-          return value_node->GetValue();
-        }
-      }
-    }
+    T result{};
     *success = false;
-    latch_.RUnlock();
-    return {};
+    tree_.Read(key, [&](const std::any &value) {
+      const T *typed_value = std::any_cast<T>(&value);
+      if (typed_value != nullptr) {
+        result = *typed_value;
+        *success = true;
+      }
+    });
+    return result;
   }
+
+  /**
+   * @brief Scan the keys that start with a prefix, in key order. The keys are visited
+   * one at a time instead of being collected first, and the scan sees the trie as it
+   * was when the scan started, whatever writers do meanwhile.
+   *
+   * @param prefix Prefix of the keys to visit; an empty prefix visits every key
+   * @return Iterator at the first key with the prefix, at the end if there is none
+   */
+  TrieIterator ScanPrefix(const std::string &prefix) const { return tree_.ScanPrefix(prefix); }
 };
 
 /**
@@ -17,8 +17,11 @@
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/io_stats.h"
 
 namespace bustub {
 
@@ -63,7 +66,7 @@ class DiskManager {
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -72,7 +75,7 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  auto ReadLog(char *log_data, int size, int offset) -> bool;
+  virtual auto ReadLog(char *log_data, int size, int offset) -> bool;
 
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
@@ -83,6 +86,19 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /**
+   * Attribute the I/O on a run of pages to the object that reserved them.
+   * @param first_page_id id of the first page of the extent
+   * @param num_pages number of pages in the extent
+   * @param owner the table, index or temporary object that owns the extent
+   */
+  void RegisterExtent(page_id_t first_page_id, size_t num_pages, IOObject owner) {
+    io_stats_.RegisterExtent(first_page_id, num_pages, owner);
+  }
+
+  /** @return the reads, writes, bytes and latency histogram of every object that issued I/O so far */
+  auto GetIOStats() const -> std::vector<std::pair<IOObject, IOStats>> { return io_stats_.Snapshot(); }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -106,6 +122,8 @@ class DiskManager {
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
   std::mutex db_io_latch_;
+  // per-object I/O accounting, every WritePage/ReadPage/WriteLog/ReadLog implementation records into it
+  IOStatsRegistry io_stats_;
 };
 
 }  // namespace bustub
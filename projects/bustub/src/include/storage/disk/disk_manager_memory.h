@@ -70,6 +70,7 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * @param page_data raw page data
    */
   void WritePage(page_id_t page_id, const char *page_data) override {
+    auto start = std::chrono::steady_clock::now();
     std::unique_lock<std::mutex> l(mutex_);
     if (page_id >= static_cast<int>(data_.size())) {
       data_.resize(page_id + 1);
@@ -82,6 +83,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     l.unlock();
 
     memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
+    l_page.unlock();
+    io_stats_.RecordPageIO(page_id, true, std::chrono::steady_clock::now() - start);
   }
 
   /**
@@ -90,6 +93,7 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * @param[out] page_data output buffer
    */
   void ReadPage(page_id_t page_id, char *page_data) override {
+    auto start = std::chrono::steady_clock::now();
     std::unique_lock<std::mutex> l(mutex_);
     if (page_id >= static_cast<int>(data_.size()) || page_id < 0) {
       LOG_WARN("page not exist");
@@ -104,6 +108,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     l.unlock();
 
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
+    l_page.unlock();
+    io_stats_.RecordPageIO(page_id, false, std::chrono::steady_clock::now() - start);
   }
 
  private:
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated.h
+//
+// Identification: src/include/storage/disk/disk_manager_simulated.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <random>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** The shape of the latency distribution sampled for every simulated I/O request. */
+enum class LatencyDistribution {
+  /** Every request takes exactly `base_`. */
+  FIXED,
+  /** Uniform in [base_ - jitter_, base_ + jitter_]. */
+  UNIFORM,
+  /** `base_` plus an exponentially distributed tail with mean `jitter_`. */
+  EXPONENTIAL
+};
+
+/**
+ * LatencyModel describes the service time of one kind of request (read or write), excluding the transfer time
+ * imposed by the bandwidth cap.
+ */
+struct LatencyModel {
+  LatencyDistribution distribution_{LatencyDistribution::FIXED};
+  std::chrono::microseconds base_{0};
+  std::chrono::microseconds jitter_{0};
+};
+
+/**
+ * Configuration of a DiskManagerSimulated. A default-constructed option set adds no delay at all.
+ */
+struct SimulatedDiskOptions {
+  /** Latency of a single page read. */
+  LatencyModel read_latency_;
+  /** Latency of a single page write. */
+  LatencyModel write_latency_;
+  /** Maximum transfer rate of the device in bytes per second, shared by reads and writes. 0 means unlimited. */
+  uint64_t bandwidth_bytes_per_sec_{0};
+  /** Maximum number of requests in flight at once; additional requests wait for a slot. 0 means unlimited. */
+  size_t queue_depth_{0};
+  /** Seed of the latency sampler, so that the same workload sees the same sequence of latencies. */
+  uint64_t seed_{0};
+};
+
+/**
+ * DiskManagerSimulated wraps another DiskManager and delays every page read and write as a real device would:
+ * each request waits for a queue slot, occupies the shared transfer channel for `BUSTUB_PAGE_SIZE / bandwidth`,
+ * and then completes after a latency sampled from the configured distribution. The underlying DiskManager performs
+ * the actual data movement, so it is typically a DiskManagerMemory or DiskManagerUnlimitedMemory.
+ *
+ * Latencies are drawn from a seeded generator; besides sleeping, the simulator also accumulates the injected delay
+ * so that benchmarks can report the simulated I/O time independently of scheduling noise.
+ */
+class DiskManagerSimulated : public DiskManager {
+ public:
+  /**
+   * Creates a new simulated disk on top of an existing disk manager.
+   * @param disk_manager the disk manager that stores the data, not owned
+   * @param options latency, bandwidth and queue depth of the simulated device
+   */
+  DiskManagerSimulated(DiskManager *disk_manager, const SimulatedDiskOptions &options);
+
+  ~DiskManagerSimulated() override = default;
+
+  /**
+   * Write a page to the underlying disk manager after the simulated write delay.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the underlying disk manager after the simulated read delay.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Log writes are forwarded to the underlying disk manager without delay. */
+  void WriteLog(char *log_data, int size) override;
+
+  /** Log reads are forwarded to the underlying disk manager without delay. */
+  auto ReadLog(char *log_data, int size, int offset) -> bool override;
+
+  /** @return the number of page reads served so far */
+  auto GetNumReads() const -> uint64_t;
+
+  /** @return the total delay injected into page reads so far, in microseconds */
+  auto GetSimulatedReadTime() const -> uint64_t;
+
+  /** @return the total delay injected into page writes so far, in microseconds */
+  auto GetSimulatedWriteTime() const -> uint64_t;
+
+ private:
+  /**
+   * Block the calling thread for the duration of one simulated request of the given kind.
+   * @param is_write true for a page write, false for a page read
+   * @return the injected delay, in microseconds
+   */
+  auto SimulateRequest(bool is_write) -> uint64_t;
+
+  /** Draw one service time from the given model. Caller must hold latch_. */
+  auto SampleLatency(const LatencyModel &model) -> std::chrono::microseconds;
+
+  /** The disk manager that actually stores the pages. */
+  DiskManager *disk_manager_;
+  /** Device characteristics. */
+  const SimulatedDiskOptions options_;
+
+  /** Protects the sampler, the channel timeline, the in-flight count and the counters below. */
+  mutable std::mutex latch_;
+  /** Signalled whenever a queue slot becomes free. */
+  std::condition_variable slot_cv_;
+  /** Number of requests currently holding a queue slot. */
+  size_t in_flight_{0};
+  /** Point in time at which the transfer channel becomes idle. */
+  std::chrono::steady_clock::time_point channel_free_at_;
+  /** Seeded latency sampler. */
+  std::mt19937_64 rng_;
+
+  uint64_t num_reads_{0};
+  uint64_t read_time_us_{0};
+  uint64_t write_time_us_{0};
+};
+
+}  // namespace bustub
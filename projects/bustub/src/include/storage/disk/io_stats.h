@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_stats.h
+//
+// Identification: src/include/storage/disk/io_stats.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** The kind of object that a page or a log record belongs to. */
+enum class IOObjectType {
+  /** Pages that were not allocated from an extent, e.g. the header page. */
+  OTHER,
+  TABLE,
+  INDEX,
+  LOG,
+  /** Scratch pages of a single operation, e.g. sorted runs that spilled to disk. */
+  TEMP
+};
+
+/**
+ * IOObject identifies the owner that disk I/O is attributed to. `oid_` is the table or index oid and is unused for
+ * the other types.
+ */
+struct IOObject {
+  IOObjectType type_{IOObjectType::OTHER};
+  uint32_t oid_{0};
+
+  static auto Table(uint32_t table_oid) -> IOObject { return {IOObjectType::TABLE, table_oid}; }
+  static auto Index(uint32_t index_oid) -> IOObject { return {IOObjectType::INDEX, index_oid}; }
+  static auto Temp() -> IOObject { return {IOObjectType::TEMP, 0}; }
+
+  auto operator<(const IOObject &other) const -> bool {
+    return std::make_pair(type_, oid_) < std::make_pair(other.type_, other.oid_);
+  }
+  auto operator==(const IOObject &other) const -> bool { return type_ == other.type_ && oid_ == other.oid_; }
+
+  /** @return a short name of the type, such as "table" */
+  auto TypeName() const -> std::string;
+};
+
+/**
+ * IOStats accumulates the I/O issued on behalf of one IOObject.
+ */
+struct IOStats {
+  /** Bucket i of the latency histogram counts requests that took [2^i, 2^(i+1)) microseconds; bucket 0 also counts
+   * requests below 1 microsecond and the last bucket also counts everything above it. */
+  static constexpr size_t NUM_LATENCY_BUCKETS = 24;
+
+  uint64_t reads_{0};
+  uint64_t writes_{0};
+  uint64_t bytes_read_{0};
+  uint64_t bytes_written_{0};
+  std::array<uint64_t, NUM_LATENCY_BUCKETS> latency_histogram_{};
+
+  /**
+   * Estimate a latency percentile from the histogram.
+   * @param percentile a value in (0, 1]
+   * @return the upper bound of the bucket that contains the percentile, in microseconds; 0 if nothing was recorded
+   */
+  auto LatencyPercentile(double percentile) const -> uint64_t;
+};
+
+/**
+ * IOStatsRegistry maps page ids to their owners and keeps one IOStats per owner. Owners are assigned to whole extents
+ * when the extent is reserved, so attributing a page costs a single ordered-map lookup.
+ */
+class IOStatsRegistry {
+ public:
+  /**
+   * Attribute the pages [first_page_id, first_page_id + num_pages) to `owner`.
+   */
+  void RegisterExtent(page_id_t first_page_id, size_t num_pages, IOObject owner);
+
+  /** @return the owner of the page, or an OTHER object if the page is not part of a registered extent */
+  auto OwnerOf(page_id_t page_id) const -> IOObject;
+
+  /** Record one page read or write. */
+  void RecordPageIO(page_id_t page_id, bool is_write, std::chrono::nanoseconds latency);
+
+  /** Record one request of `bytes` bytes issued on behalf of `owner`. */
+  void RecordIO(IOObject owner, bool is_write, size_t bytes, std::chrono::nanoseconds latency);
+
+  /** @return a copy of the statistics of every owner that issued at least one request, ordered by owner */
+  auto Snapshot() const -> std::vector<std::pair<IOObject, IOStats>>;
+
+ private:
+  auto OwnerOfLocked(page_id_t page_id) const -> IOObject;
+  void RecordLocked(IOObject owner, bool is_write, size_t bytes, std::chrono::nanoseconds latency);
+
+  mutable std::mutex latch_;
+  /** first page id of an extent -> (one past its last page id, owner) */
+  std::map<page_id_t, std::pair<page_id_t, IOObject>> extents_;
+  std::map<IOObject, IOStats> stats_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.h
+//
+// Identification: src/include/storage/index/art_index.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "container/art/adaptive_radix_tree.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+#define ART_INDEX_TYPE ArtIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * An in-memory index (CREATE INDEX ... USING ART) over an AdaptiveRadixTree. It never touches the buffer pool: lookups
+ * follow pointers through the tree and take no latch, which suits small, hot tables that always fit in memory.
+ *
+ * The tree is keyed by the normalized encoding of KeyType, whose bytes order keys the same way the comparator does;
+ * like in a B+ tree index, a non-unique index appends the RID to tell entries apart. Nothing of the index is written to
+ * disk, so it is rebuilt from the table heap whenever it is created.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ArtIndex : public Index {
+ public:
+  explicit ArtIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  ~ArtIndex() override = default;
+
+  /** Insert an entry. A unique index skips keys that are already present, like a unique BPlusTreeIndex does. */
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * Scans keep reading the version of the tree they started in, whatever is written meanwhile. A reverse scan collects
+   * its range before returning the first batch, since the tree is only iterated forward.
+   */
+  auto ScanRange(const IndexRange &range, Transaction *transaction) -> std::unique_ptr<IndexRangeScan> override;
+
+  /** Only the number of entries applies to an in-memory index. */
+  auto GetStats() -> std::optional<IndexStats> override;
+
+  auto GetNumEntries() -> std::optional<size_t> override;
+
+  /** What the tree stores for an entry: its RID, and the encoded included columns that follow the key. */
+  struct Entry {
+    RID rid_;
+    std::string payload_;
+  };
+
+  using Tree = AdaptiveRadixTree<Entry>;
+
+  /** @return the tuple of the entry schema for an entry: the key columns followed by the included columns */
+  auto MakeEntryTuple(std::string_view tree_key, const Entry &entry) const -> Tuple;
+
+  /**
+   * @param fits If not null, set to whether the key columns fit; a lookup may use a truncated key, which equals no entry
+   * @return the tree key of an index key and RID; the RID only matters for a non-unique index
+   */
+  auto MakeTreeKey(const Tuple &key, RID rid, bool *fits = nullptr) const -> std::string;
+
+ protected:
+  /** @return the bytes of an encoded index key that the tree is keyed by, i.e. all but the payload */
+  auto TreeKeyOf(const KeyType &index_key) const -> std::string;
+
+  /** @return the bytes of the key columns in a tree key, which all entries of that key share */
+  auto KeyColumnsSize() const -> size_t;
+
+  Tree tree_;
+};
+
+}  // namespace bustub
@@ -10,10 +10,15 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <optional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "buffer/extent_allocator.h"
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -23,6 +28,52 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/**
+ * The keys visited by a bounded scan of a BPlusTree. A missing bound leaves that side of the range open.
+ */
+template <typename KeyType>
+struct KeyRange {
+  std::optional<KeyType> lower_;
+  bool lower_inclusive_{true};
+  std::optional<KeyType> upper_;
+  bool upper_inclusive_{true};
+};
+
+/**
+ * The shape of a BPlusTree: its height, how many pages and entries each kind of page holds and how full they are,
+ * and how often the tree has been restructured since it was opened.
+ */
+struct BPlusTreeStats {
+  /** number of levels, 0 for an empty tree and 1 for a tree of a single leaf */
+  int height_{0};
+  /** number of pages on each level, from the root down to the leaves */
+  std::vector<size_t> pages_per_level_;
+  size_t num_leaf_pages_{0};
+  size_t num_internal_pages_{0};
+  /** number of key/value pairs in the leaves */
+  size_t num_entries_{0};
+  /** number of child pointers in the internal pages */
+  size_t num_children_{0};
+  /** average fraction of a leaf and of an internal page in use */
+  double leaf_fill_{0};
+  double internal_fill_{0};
+  size_t num_leaf_splits_{0};
+  size_t num_internal_splits_{0};
+  /** merges and redistributions (borrowing an entry from a sibling) of leaf and internal pages */
+  size_t num_merges_{0};
+  size_t num_redistributions_{0};
+
+  /** @return the average number of children of an internal page, 0 if there is none */
+  auto AverageFanout() const -> double {
+    return num_internal_pages_ == 0 ? 0 : static_cast<double>(num_children_) / num_internal_pages_;
+  }
+
+  /** @return the average number of entries of a leaf page, 0 if the tree is empty */
+  auto AverageLeafEntries() const -> double {
+    return num_leaf_pages_ == 0 ? 0 : static_cast<double>(num_entries_) / num_leaf_pages_;
+  }
+};
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
@@ -31,16 +82,20 @@ namespace bustub {
  * (1) We only support unique key
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
- * (4) Implement index iterator for range scan
+ * (4) Implement index iterator for range scan, in both directions
+ * (5) Every level is linked left to right and pages carry high keys
+ *     (B-link tree), so readers never wait for a split to finish
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     IOObject io_owner = {});
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -48,23 +103,27 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
-  // auto BinarySearchInLeaf(const KeyType &key, LeafPage *node);
-  void HandleLeafOverflow(LeafPage *target_page);
-  void HandleInternalOverflow(InternalPage *target_page, const KeyType &key, const page_id_t &value);
+  // Build this (empty) B+ tree bottom-up from entries produced in ascending key order. Pages are packed to
+  // fill_factor of their capacity; like Insert, only the first entry of a duplicate key is kept.
+  // Returns false without consuming any entry if the tree is not empty.
+  auto BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor = BULK_LOAD_FILL_FACTOR) -> bool;
 
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
-  auto FindFistKey(InternalPage *target_page) -> KeyType;
-  void HandleLeafUnderflow(LeafPage *target_page);
-  void HandleInternalUnderflow(InternalPage *target_page);
-  auto GetBrotherPage(InternalPage *parent_page, BPlusTreePage *child_page, int &target_index, int &bro_index)
-      -> BPlusTreePage *;
 
   // return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
-  // auto GetLeafPage(const KeyType &key) -> Page *;
-  auto FindLeafPage(const KeyType &key) -> LeafPage *;
+  // look up a batch of keys sorted in ascending order in one left-to-right sweep: the path of internal pages is
+  // kept and a key is searched from the deepest page of it that still covers the key, or from the current leaf and
+  // its right sibling. results[i] receives the values of sorted_keys[i]: of the entry equal to it, or, if `matches`
+  // is given, of all consecutive entries from the first one not less than it that match it
+  void GetValues(const std::vector<KeyType> &sorted_keys, std::vector<std::vector<ValueType>> *results,
+                 const std::function<bool(const KeyType &, const KeyType &)> &matches = nullptr,
+                 Transaction *transaction = nullptr);
+
+  // return the number of entries in the tree, kept up to date by every insert and removal without reading a page
+  auto GetNumEntries() const -> size_t;
 
   // return the page id of the root node
   auto GetRootPageId() -> page_id_t;
@@ -74,6 +133,26 @@ class BPlusTree {
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
 
+  // reverse index iterator, from the largest key (not greater than `key`) down to the smallest; ends at End()
+  auto RBegin() -> INDEXITERATOR_TYPE;
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
+
+  // index iterator over the keys in `range`, ascending or (reverse) descending. For a forward scan, `upcoming`, if
+  // given, receives up to INDEX_PREFETCH_LEAVES leaves in the range that follow the first one, as read from its parent
+  // on the way down, so that the caller can fetch them ahead of the iterator
+  auto Begin(const KeyRange<KeyType> &range, bool reverse = false, std::vector<page_id_t> *upcoming = nullptr)
+      -> INDEXITERATOR_TYPE;
+
+  // split `range` into at most num_partitions consecutive, disjoint sub-ranges that hold about as many leaves each,
+  // using the separator keys of the highest internal level that has enough of them. Ranges too small to be worth
+  // splitting, i.e. under INDEX_PARTITION_MIN_LEAVES leaves per sub-range, come back whole
+  auto PartitionRange(const KeyRange<KeyType> &range, size_t num_partitions) -> std::vector<KeyRange<KeyType>>;
+
+  // walk every level of the tree along the right links and count its pages and entries. Pages are read-latched one
+  // at a time, so the numbers are only a snapshot while the tree is being modified. The split, merge and
+  // redistribution counters cover the lifetime of this object
+  auto GetStats() -> BPlusTreeStats;
+
   // print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -87,8 +166,105 @@ class BPlusTree {
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
 
  private:
+  /* 写操作类型，用于判断页面在下降过程中是否安全 */
+  enum class Operation { INSERT, REMOVE };
+
+  /* 读操作下降时选择孩子页面的方式：包含key的页面、最左/最右页面、包含小于key的最大数据的页面 */
+  enum class SearchMode { KEY, LEFTMOST, RIGHTMOST, BEFORE_KEY };
+
+  /* 批量构建的中间状态 */
+  struct BulkLoadState {
+    /* 每个内部页面写入的子页面数 */
+    int internal_capacity_{0};
+    /* 变长key的页面按字节数填充的比例 */
+    double fill_factor_{1};
+    /* 上一个叶子页面，保持pin直到下一个叶子页面链接到它 */
+    Page *prev_leaf_{nullptr};
+    /* 第i层已写出、但还没有父页面的页面及其子树中最小的key */
+    std::vector<std::vector<std::pair<KeyType, page_id_t>>> children_;
+    /* 第i层已经写出的父页面数 */
+    std::vector<int> num_parents_;
+    /* 第i层页面的父页面中最后写出的一个，等待链接到它右侧的页面 */
+    std::vector<page_id_t> prev_internal_;
+  };
+
   void UpdateRootPageId(int insert_record = 0);
 
+  // write one leaf page of a bulk load with the first `count` entries, or as many of them as fill the page, and
+  // register it with the level above; returns the number of entries written
+  auto BulkLoadLeaf(const MappingType *entries, int count, BulkLoadState *state) -> int;
+
+  // write one internal page over the first `count` parentless pages of `level`, or as many of them as fill it
+  void BulkLoadInternal(size_t level, int count, BulkLoadState *state);
+
+  // add a finished page of `level` - 1 to `level`, writing an internal page once enough of them have piled up
+  void BulkLoadAddChild(size_t level, const KeyType &key, page_id_t page_id, BulkLoadState *state);
+
+  // whether the page can absorb the operation without splitting or merging
+  auto IsSafe(BPlusTreePage *page, Operation operation) const -> bool;
+
+  // the high key of a leaf or internal page, meaningful only if the page has a next page
+  auto HighKeyOf(const BPlusTreePage *page) const -> const KeyType &;
+
+  // whether a concurrent split moved what the search is looking for to the right of `page`
+  auto NeedMoveRight(const BPlusTreePage *page, const KeyType &key, SearchMode mode) const -> bool;
+
+  // follow right links from the latched `page` while NeedMoveRight, latching each next page before releasing the
+  // previous one. lower_bound, if given, receives the high key of the last page that was left behind
+  auto MoveRight(Page *page, const KeyType &key, SearchMode mode, bool exclusive,
+                 std::optional<KeyType> *lower_bound = nullptr) -> Page *;
+
+  // find the read-latched leaf covering `key` for GetValues, starting from the previous leaf (released or returned)
+  // and the recorded `path` of internal pages; nullptr if the tree is empty
+  auto FindLeafPageForBatch(Page *leaf_page, const KeyType &key, std::vector<page_id_t> *path) -> Page *;
+
+  // read-latch crabbing down from the read-latched `page` to the leaf covering `key`, appending the internal pages
+  // passed to `path`
+  auto DescendForBatch(Page *page, const KeyType &key, std::vector<page_id_t> *path) -> Page *;
+
+  // read-latch crabbing down to a leaf; the returned leaf is pinned and read-latched, nullptr if the tree is empty.
+  // lower_bound, if given, receives the tightest separator key that bounds the leaf from below (none for the
+  // leftmost leaf); right_siblings, if given, receives the separator keys and page ids of the leaves to the right
+  // of the returned one under the same parent
+  auto FindLeafPageRead(const KeyType &key, SearchMode mode = SearchMode::KEY,
+                        std::optional<KeyType> *lower_bound = nullptr,
+                        std::vector<std::pair<KeyType, page_id_t>> *right_siblings = nullptr) -> Page *;
+
+  // find the leaf holding the largest key less than `key` without holding any latch on the way in, so that a
+  // reverse iterator can step back without waiting on a latch out of the left-to-right order. The leaf is pinned
+  // and read-latched and *index is the position of that key; nullptr if there is no such key
+  auto FindPrevLeafPage(KeyType key, int *index) -> Page *;
+
+  // set the prev link of the leaf `page_id` (if valid) after the leaf to its left was split or merged
+  void LinkPrevPage(page_id_t page_id, page_id_t prev_page_id);
+
+  // read-latch internal pages and write-latch only the leaf; nullptr if the tree is empty. path, if given,
+  // receives the ids of the internal pages passed on the way down, from the root to the parent of the leaf
+  auto FindLeafPageOptimistic(const KeyType &key, std::vector<page_id_t> *path = nullptr) -> Page *;
+
+  // split the full, write-latched leaf and release it, then insert the new separator into its parent. A pending
+  // entry that did not fit in the leaf goes into whichever half it belongs to
+  void HandleLeafOverflow(Page *page, std::vector<page_id_t> *path, const MappingType *pending = nullptr);
+
+  // insert the separator of a split page into the page one level up, taken from the end of `path` (or, once the
+  // path is used up, the root), splitting pages upwards as long as they are full
+  void InsertIntoParent(page_id_t left_page_id, KeyType key, page_id_t right_page_id, std::vector<page_id_t> *path);
+
+  // write-latch crabbing for a remove: every latched page that may still be modified is kept in the transaction's
+  // page set, a nullptr entry stands for root_latch_; returns nullptr (with root_latch_ held) if the tree is empty
+  auto FindLeafPagePessimistic(const KeyType &key, Transaction *transaction) -> Page *;
+
+  void HandleLeafUnderflow(LeafPage *target_page, Transaction *transaction);
+  void HandleInternalUnderflow(InternalPage *target_page, Transaction *transaction);
+
+  // the parent of a page latched by FindLeafPagePessimistic, which is the page before it in the page set
+  auto GetParentPage(BPlusTreePage *child_page, Transaction *transaction) -> InternalPage *;
+  auto GetBrotherPage(InternalPage *parent_page, BPlusTreePage *child_page, int &target_index, int &bro_index,
+                      Transaction *transaction) -> Page *;
+
+  // release all latches in the page set and delete the pages in the deleted page set
+  void ReleaseWLatches(Transaction *transaction, bool is_dirty);
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -98,10 +274,24 @@ class BPlusTree {
   std::string index_name_;
   page_id_t root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
+  ExtentAllocator extent_allocator_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
-  std::shared_mutex shared_mutex_;
+  /* 保护root_page_id_ */
+  ReaderWriterLatch root_latch_;
+  /*
+   * 结构修改锁：分裂自底向上进行，不持有父页面的锁，插入在分裂期间持有读锁，多个插入可以同时分裂；
+   * 合并和借取依赖完整的父页面，悲观删除持有写锁。读操作沿右链接恢复，从不获取该锁
+   */
+  ReaderWriterLatch smo_latch_;
+  /* 结构修改的次数，由GetStats报告 */
+  std::atomic<size_t> num_leaf_splits_{0};
+  std::atomic<size_t> num_internal_splits_{0};
+  std::atomic<size_t> num_merges_{0};
+  std::atomic<size_t> num_redistributions_{0};
+  /* 条目数，插入成功时加一、删除成功时减一，供优化器估计基数而不必遍历B+树 */
+  std::atomic<size_t> num_entries_{0};
 };
 
 }  // namespace bustub
@@ -18,6 +18,7 @@
 
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
 #include "storage/index/index.h"
 
 namespace bustub {
@@ -27,7 +28,8 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 IOObject io_owner = {});
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -35,13 +37,50 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  // sorts the keys and looks them all up in one sweep of the tree
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  // sorts the entries, spilling to temporary pages if needed, and builds an empty tree bottom-up
+  void BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction) override;
+
+  // re-descends the tree for every batch of INDEX_SCAN_BATCH_SIZE entries, resuming after the last key returned
+  auto ScanRange(const IndexRange &range, Transaction *transaction) -> std::unique_ptr<IndexRangeScan> override;
+
+  // splits the range at separator keys of the tree into sub-ranges spanning about the same number of leaves
+  auto ScanRangePartitioned(const IndexRange &range, size_t num_partitions, Transaction *transaction)
+      -> std::vector<std::unique_ptr<IndexRangeScan>> override;
+
+  // walks every level of the tree
+  auto GetStats() -> std::optional<IndexStats> override;
+
+  // the entry count the tree keeps up to date, read without visiting a page
+  auto GetNumEntries() -> std::optional<size_t> override;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  // decode an index key into a tuple of the entry schema: the key columns followed by the included columns
+  auto MakeEntryTuple(const KeyType &index_key) const -> Tuple;
+
  protected:
+  // encode the key columns, followed by the RID if the index is not unique. `fits`, if given, is set to whether the
+  // key columns fit in the key; a lookup may use a truncated key, since it equals no stored one
+  auto MakeIndexKey(const Tuple &key, RID rid, bool *fits = nullptr) const -> KeyType;
+
+  // encode a whole entry: the index key and the payload of included columns. Throws if they do not fit in the key
+  auto MakeEntryKey(const Tuple &entry, RID rid) const -> KeyType;
+
+  // encode one bound of a range scan so that it includes or excludes all entries of its key
+  auto MakeBoundKey(const Tuple &key, bool is_lower, bool inclusive) const -> KeyType;
+
+  // encode both bounds of a range scan
+  auto MakeKeyRange(const IndexRange &range) const -> KeyRange<KeyType>;
+
+  BufferPoolManager *buffer_pool_manager_;
   // comparator for key
   KeyComparator comparator_;
   // container
@@ -59,4 +98,10 @@ using BPlusTreeIndexIteratorForOneIntegerColumn =
     IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
 using IntegerHashFunctionType = HashFunction<IntegerKeyType>;
 
+/** A non-unique index on one integer column also stores the RID of every entry in its key. */
+constexpr static const auto NON_UNIQUE_INTEGER_SIZE = 16;
+using NonUniqueIntegerKeyType = GenericKey<NON_UNIQUE_INTEGER_SIZE>;
+using NonUniqueIntegerComparatorType = GenericComparator<NON_UNIQUE_INTEGER_SIZE>;
+using NonUniqueIntegerHashFunctionType = HashFunction<NonUniqueIntegerKeyType>;
+
 }  // namespace bustub
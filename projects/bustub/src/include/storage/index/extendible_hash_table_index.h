@@ -25,20 +25,39 @@ namespace bustub {
 
 #define HASH_TABLE_INDEX_TYPE ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * A hash index (CREATE INDEX ... USING HASH) over a DiskExtendibleHashTable. A point lookup reads the directory page
+ * and one bucket page, whatever the size of the index. The keys are unordered, so besides point lookups the index only
+ * serves range scans whose range is a single key.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTableIndex : public Index {
  public:
   ExtendibleHashTableIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
-                           const HashFunction<KeyType> &hash_fn);
+                           const HashFunction<KeyType> &hash_fn, IOObject io_owner = {});
 
   ~ExtendibleHashTableIndex() override = default;
 
+  /**
+   * Insert an entry. A unique index skips keys that are already present, like a unique BPlusTreeIndex does. Any number
+   * of entries may share a key of a non-unique index.
+   */
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Only ranges holding a single key, with both bounds inclusive and equal, are supported; they are answered by one
+   * point lookup.
+   * @throw NotImplementedException for any other range
+   */
+  auto ScanRange(const IndexRange &range, Transaction *transaction) -> std::unique_ptr<IndexRangeScan> override;
+
+  /** @return the entry tuple of an index key, the key columns of the index */
+  auto MakeEntryTuple(const KeyType &index_key) const -> Tuple;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/extent_allocator.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORTER_TYPE ExternalSorter<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalSorter sorts (key, value) pairs that do not necessarily fit in memory.
+ *
+ * Added entries are buffered until `buffer_pages` pages worth of them have been collected. The buffer is then sorted
+ * and written out as a run of temporary pages, whose I/O is attributed to IOObjectType::TEMP. Next() merges the runs
+ * with the remaining buffer; when nothing was spilled it simply walks the sorted buffer without any I/O.
+ *
+ * Entries with equal keys come out in the order they were added. A temporary page is deleted as soon as it has been
+ * read back, so the sorter never holds more than one page per run in memory while merging.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSorter {
+ public:
+  /**
+   * @param buffer_pool_manager the buffer pool manager that holds the spilled runs
+   * @param comparator the key comparator
+   * @param buffer_pages number of pages worth of entries that are sorted in memory before a run is spilled
+   */
+  ExternalSorter(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                 size_t buffer_pages = SORT_BUFFER_PAGES);
+
+  ~ExternalSorter();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSorter);
+
+  /**
+   * Add an entry. Must not be called after the first call to Next().
+   */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /**
+   * Produce the next entry in key order.
+   * @param[out] entry the next entry
+   * @return false if all entries have been produced
+   */
+  auto Next(MappingType *entry) -> bool;
+
+  /** @return the number of runs that were spilled to disk */
+  auto GetNumSpilledRuns() const -> size_t { return num_spilled_runs_; }
+
+ private:
+  static constexpr size_t ENTRIES_PER_PAGE = BUSTUB_PAGE_SIZE / sizeof(MappingType);
+
+  /** A sorted run: the pages it still has on disk and the entries of the page being merged. */
+  struct Run {
+    std::vector<page_id_t> pages_;
+    size_t next_page_{0};
+    /** number of entries on the last page */
+    size_t last_page_size_{0};
+    std::vector<MappingType> entries_;
+    size_t position_{0};
+  };
+
+  void SortBuffer();
+  void SpillBuffer();
+  /** Read the next page of the run into its entries, deleting the page. @return false if the run is exhausted */
+  auto LoadNextPage(Run *run) -> bool;
+  void StartMerge();
+
+  BufferPoolManager *buffer_pool_manager_;
+  ExtentAllocator temp_allocator_;
+  KeyComparator comparator_;
+  const size_t buffer_size_;
+
+  std::vector<MappingType> buffer_;
+  std::vector<Run> runs_;
+  size_t num_spilled_runs_{0};
+  bool merging_{false};
+
+  /** indexes of the runs that still have entries, ordered by their current entry (then by run index) */
+  using RunHeap = std::priority_queue<size_t, std::vector<size_t>, std::function<bool(size_t, size_t)>>;
+  RunHeap heap_;
+};
+
+}  // namespace bustub
@@ -13,54 +13,139 @@
 #pragma once
 
 #include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
 
+#include "common/exception.h"
+#include "common/rid.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
 namespace bustub {
 
+/**
+ * @return the most bytes the normalized encoding of a value of `column` takes in a GenericKey: a varchar takes a
+ * marker byte, its characters and a two byte terminator. The declared length of a varchar is not enforced on its
+ * values, so indexes refuse to store the longer ones rather than truncate them.
+ */
+inline auto GenericKeyColumnSize(const Column &column) -> size_t {
+  return column.GetType() == TypeId::VARCHAR ? column.GetLength() + 3 : column.GetFixedLength();
+}
+
 /**
  * Generic key is used for indexing with opaque data.
  *
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * The key columns are stored in a normalized, order-preserving encoding, so that two keys compare the same way
+ * byte-wise (memcmp) as their values compare column by column:
+ * - integers and booleans are stored big-endian with the sign bit flipped;
+ * - decimals are stored big-endian with the sign bit flipped, and all bits flipped for negative numbers;
+ * - timestamps are stored big-endian;
+ * - varchars are stored as a 0x01 marker (0x00 for NULL), the characters with every 0x00 escaped as 0x00 0xFF, and a
+ *   0x00 0x00 terminator.
+ * NULL numeric values keep their sentinel (the minimum of the type), so they sort first. The unused tail of the key is
+ * zeroed. Values that do not fit are truncated, which SetFromKey and SetPayload report: a truncated key may equal the
+ * key of a different value, so it must never be stored. Looking one up is harmless, since it equals no stored key.
+ *
+ * A covering index also stores the values of its included columns in a payload of `payload_size` bytes at the very end
+ * of the key, after the RID of a non-unique index. The payload is not part of the key: the comparator stops before it.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  /** Number of bytes SetRid stores at the end of the key */
+  static constexpr size_t RID_SIZE = sizeof(uint32_t) * 2;
+
+  /**
+   * Encode the key columns of `tuple` at the start of the key.
+   * @param key_size The bytes the key columns may take, i.e. all but what SetRid and SetPayload store after them
+   * @return false if the key columns did not fit in key_size bytes and were truncated
+   */
+  inline auto SetFromKey(const Tuple &tuple, const Schema *key_schema, size_t key_size = KeySize) -> bool {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    size_t offset = 0;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      offset = EncodeValue(tuple.GetValue(key_schema, i), offset);
+    }
+    return offset <= key_size;
+  }
+
+  /**
+   * Store `rid` in the RID_SIZE bytes just before the payload. Non-unique indexes do this so that entries with equal
+   * keys stay distinct and are ordered by RID; the key columns then only have KeySize - payload_size - RID_SIZE bytes
+   * before they are truncated.
+   */
+  inline void SetRid(const RID &rid, size_t payload_size = 0) {
+    size_t offset = KeySize > RID_SIZE + payload_size ? KeySize - payload_size - RID_SIZE : 0;
+    offset = PutBigEndian(static_cast<uint32_t>(rid.GetPageId()), sizeof(uint32_t), offset);
+    PutBigEndian(rid.GetSlotNum(), sizeof(uint32_t), offset);
+  }
+
+  /** @return whether the two keys are equal apart from the RIDs stored by SetRid and the payloads */
+  inline auto EqualsIgnoringRid(const GenericKey &other, size_t payload_size = 0) const -> bool {
+    return KeySize <= RID_SIZE + payload_size ||
+           memcmp(data_, other.data_, KeySize - payload_size - RID_SIZE) == 0;
+  }
+
+  /**
+   * Store the values of the included columns in the last `payload_size` bytes of the key.
+   * @return false if they did not fit and were truncated
+   */
+  inline auto SetPayload(const std::vector<Value> &values, size_t payload_size) -> bool {
+    size_t offset = KeySize - payload_size;
+    memset(data_ + offset, 0, payload_size);
+    for (const auto &value : values) {
+      offset = EncodeValue(value, offset);
+    }
+    return offset <= KeySize;
+  }
+
+  /** @return the included column `column_idx` of `payload_schema`, read from a payload stored by SetPayload */
+  inline auto PayloadToValue(const Schema *payload_schema, uint32_t column_idx, size_t payload_size) const -> Value {
+    size_t offset = KeySize - payload_size;
+    for (uint32_t i = 0; i < column_idx; i++) {
+      DecodeValue(payload_schema->GetColumn(i).GetType(), &offset);
+    }
+    return DecodeValue(payload_schema->GetColumn(column_idx).GetType(), &offset);
   }
 
   // NOTE: for test purpose only
+  // encode the key as a BIGINT column, or as an INTEGER column for keys shorter than 8 bytes
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    if constexpr (KeySize >= sizeof(int64_t)) {
+      EncodeValue(Value(TypeId::BIGINT, key), 0);
+    } else {
+      EncodeValue(Value(TypeId::INTEGER, static_cast<int32_t>(key)), 0);
+    }
   }
 
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < column_idx; i++) {
+      DecodeValue(schema->GetColumn(i).GetType(), &offset);
     }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    return DecodeValue(schema->GetColumn(column_idx).GetType(), &offset);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline auto ToString() const -> int64_t { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // interpret the key as a single BIGINT column (INTEGER for keys shorter than 8 bytes)
+  inline auto ToString() const -> int64_t {
+    size_t offset = 0;
+    if constexpr (KeySize >= sizeof(int64_t)) {
+      return DecodeValue(TypeId::BIGINT, &offset).template GetAs<int64_t>();
+    } else {
+      return DecodeValue(TypeId::INTEGER, &offset).template GetAs<int32_t>();
+    }
+  }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // interpret the key as a single BIGINT column (INTEGER for keys shorter than 8 bytes)
   friend auto operator<<(std::ostream &os, const GenericKey &key) -> std::ostream & {
     os << key.ToString();
     return os;
@@ -68,39 +153,168 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  static constexpr uint64_t SignBit(size_t num_bytes) { return uint64_t{1} << (8 * num_bytes - 1); }
+
+  /** Write the low `num_bytes` bytes of `bits` big-endian at `offset`, dropping what does not fit. */
+  inline auto PutBigEndian(uint64_t bits, size_t num_bytes, size_t offset) -> size_t {
+    for (size_t i = 0; i < num_bytes; i++, offset++) {
+      if (offset < KeySize) {
+        data_[offset] = static_cast<char>(bits >> (8 * (num_bytes - 1 - i)));
+      }
+    }
+    return offset;
+  }
+
+  /** Read `num_bytes` big-endian bytes at `*offset`; bytes past the end of the key read as 0. */
+  inline auto GetBigEndian(size_t num_bytes, size_t *offset) const -> uint64_t {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < num_bytes; i++, (*offset)++) {
+      bits = (bits << 8) | (*offset < KeySize ? static_cast<uint8_t>(data_[*offset]) : 0);
+    }
+    return bits;
+  }
+
+  /**
+   * Append the normalized encoding of `value` at `offset`, returning the offset after it. Bytes past the end of the key
+   * are dropped; the returned offset then lies past KeySize.
+   */
+  inline auto EncodeValue(const Value &value, size_t offset) -> size_t {
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return PutBigEndian(static_cast<uint8_t>(value.GetAs<int8_t>()) ^ SignBit(1), 1, offset);
+      case TypeId::SMALLINT:
+        return PutBigEndian(static_cast<uint16_t>(value.GetAs<int16_t>()) ^ SignBit(2), 2, offset);
+      case TypeId::INTEGER:
+        return PutBigEndian(static_cast<uint32_t>(value.GetAs<int32_t>()) ^ SignBit(4), 4, offset);
+      case TypeId::BIGINT:
+        return PutBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ SignBit(8), 8, offset);
+      case TypeId::DECIMAL: {
+        auto d = value.GetAs<double>();
+        if (d == 0) {
+          // -0.0 and 0.0 are equal values, so they must share an encoding
+          d = 0;
+        }
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        bits = (bits & SignBit(8)) != 0 ? ~bits : bits ^ SignBit(8);
+        return PutBigEndian(bits, 8, offset);
+      }
+      case TypeId::TIMESTAMP:
+        return PutBigEndian(value.GetAs<uint64_t>(), 8, offset);
+      case TypeId::VARCHAR: {
+        if (value.IsNull()) {
+          return PutBigEndian(0, 1, offset);
+        }
+        offset = PutBigEndian(1, 1, offset);
+        const char *data = value.GetData();
+        // the stored length includes the trailing '\0'
+        for (uint32_t i = 0; i + 1 < value.GetLength() && offset < KeySize; i++) {
+          offset = PutBigEndian(static_cast<uint8_t>(data[i]), 1, offset);
+          if (data[i] == '\0') {
+            offset = PutBigEndian(0xFF, 1, offset);
+          }
+        }
+        return PutBigEndian(0, 2, offset);
+      }
+      default:
+        throw Exception(ExceptionType::NOT_IMPLEMENTED, "unsupported index key type");
+    }
+  }
+
+  /** Decode the value of type `type` at `*offset` and advance the offset past it. */
+  inline auto DecodeValue(TypeId type, size_t *offset) const -> Value {
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return {type, static_cast<int8_t>(GetBigEndian(1, offset) ^ SignBit(1))};
+      case TypeId::SMALLINT:
+        return {type, static_cast<int16_t>(GetBigEndian(2, offset) ^ SignBit(2))};
+      case TypeId::INTEGER:
+        return {type, static_cast<int32_t>(GetBigEndian(4, offset) ^ SignBit(4))};
+      case TypeId::BIGINT:
+        return {type, static_cast<int64_t>(GetBigEndian(8, offset) ^ SignBit(8))};
+      case TypeId::DECIMAL: {
+        uint64_t bits = GetBigEndian(8, offset);
+        bits = (bits & SignBit(8)) != 0 ? bits ^ SignBit(8) : ~bits;
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return {type, d};
+      }
+      case TypeId::TIMESTAMP:
+        return {type, GetBigEndian(8, offset)};
+      case TypeId::VARCHAR: {
+        if (GetBigEndian(1, offset) == 0) {
+          return Value(type);
+        }
+        std::string str;
+        while (*offset < KeySize) {
+          auto c = static_cast<char>(GetBigEndian(1, offset));
+          if (c == '\0') {
+            if (GetBigEndian(1, offset) == 0) {
+              break;
+            }
+          }
+          str.push_back(c);
+        }
+        return {type, str};
+      }
+      default:
+        throw Exception(ExceptionType::NOT_IMPLEMENTED, "unsupported index key type");
+    }
+  }
 };
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys are normalized by GenericKey::SetFromKey, so no per-column decoding is needed: 4 and 8 byte keys are compared as
+ * a single big-endian integer, longer keys with memcmp. The payload of a covering index is left out of the comparison.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
+    if constexpr (KeySize == sizeof(uint32_t) || KeySize == sizeof(uint64_t)) {
+      if (compare_size_ == KeySize) {
+        using Word = std::conditional_t<KeySize == sizeof(uint32_t), uint32_t, uint64_t>;
+        Word lhs_word = LoadBigEndian<Word>(lhs.data_);
+        Word rhs_word = LoadBigEndian<Word>(rhs.data_);
+        return static_cast<int>(lhs_word > rhs_word) - static_cast<int>(lhs_word < rhs_word);
       }
     }
-    // equals
-    return 0;
+    int cmp = memcmp(lhs.data_, rhs.data_, compare_size_);
+    return static_cast<int>(cmp > 0) - static_cast<int>(cmp < 0);
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, compare_size_{other.compare_size_} {}
 
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  // constructor, `payload_size` trailing bytes of every key are not compared
+  explicit GenericComparator(Schema *key_schema, size_t payload_size = 0)
+      : key_schema_(key_schema), compare_size_(KeySize - payload_size) {}
 
  private:
-  Schema *key_schema_;
+  template <typename Word>
+  static inline auto LoadBigEndian(const char *data) -> Word {
+    Word word;
+    memcpy(&word, data, sizeof(Word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if constexpr (sizeof(Word) == sizeof(uint32_t)) {
+      word = __builtin_bswap32(word);
+    } else {
+      word = __builtin_bswap64(word);
+    }
+#endif
+    return word;
+  }
+
+  // the key schema is only needed to encode and decode keys, not to compare them
+  [[maybe_unused]] Schema *key_schema_;
+  // number of leading bytes that take part in the comparison
+  size_t compare_size_;
 };
 
 }  // namespace bustub
@@ -12,12 +12,15 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -43,11 +46,27 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param is_unique Whether the index holds at most one entry per key
+   * @param include_attrs The base table columns whose values are stored alongside each key, without being part of it
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, std::vector<uint32_t> include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique),
+        include_attrs_(std::move(include_attrs)) {
     key_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, key_attrs_));
+    include_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, include_attrs_));
+    std::vector<uint32_t> entry_attrs = key_attrs_;
+    entry_attrs.insert(entry_attrs.end(), include_attrs_.begin(), include_attrs_.end());
+    entry_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, entry_attrs));
+    for (const auto &column : include_schema_->GetColumns()) {
+      if (!column.IsInlined()) {
+        throw NotImplementedException("only fixed-length columns can be included in an index");
+      }
+      payload_size_ += column.GetFixedLength();
+    }
   }
 
   ~IndexMetadata() = default;
@@ -72,6 +91,24 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
+  /** @return Whether the index holds at most one entry per key */
+  inline auto IsUnique() const -> bool { return is_unique_; }
+
+  /** @return The base table columns stored alongside each key */
+  inline auto GetIncludeAttrs() const -> const std::vector<uint32_t> & { return include_attrs_; }
+
+  /** @return A schema object pointer that represents the included columns */
+  inline auto GetIncludeSchema() const -> Schema * { return include_schema_.get(); }
+
+  /**
+   * @return A schema object pointer that represents an index entry: the key columns followed by the included columns.
+   * Entries are inserted, and returned by index-only scans, as tuples of this schema.
+   */
+  inline auto GetEntrySchema() const -> Schema * { return entry_schema_.get(); }
+
+  /** @return The number of bytes the included columns take in each entry */
+  inline auto GetPayloadSize() const -> size_t { return payload_size_; }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -79,8 +116,12 @@ class IndexMetadata {
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
        << "Type = B+Tree, "
+       << "Unique = " << (is_unique_ ? "true" : "false") << ", "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
+    if (!include_attrs_.empty()) {
+      os << " INCLUDE " << include_schema_->ToString();
+    }
 
     return os.str();
   }
@@ -92,8 +133,86 @@ class IndexMetadata {
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
   const std::vector<uint32_t> key_attrs_;
+  /** Whether the index holds at most one entry per key */
+  const bool is_unique_;
   /** The schema of the indexed key */
   std::shared_ptr<Schema> key_schema_;
+  /** The mapping relation between included columns and base table columns */
+  const std::vector<uint32_t> include_attrs_;
+  /** The schema of the included columns */
+  std::shared_ptr<Schema> include_schema_;
+  /** The key columns followed by the included columns */
+  std::shared_ptr<Schema> entry_schema_;
+  /** The size of the included column values in each entry, in bytes */
+  size_t payload_size_{0};
+};
+
+/** The data structure behind an index, chosen with CREATE INDEX ... USING */
+enum class IndexType { BPlusTreeIndex, HashTableIndex, ArtIndex };
+
+/** @return the name of an index type, as it is written in CREATE INDEX ... USING */
+inline auto IndexTypeToString(IndexType index_type) -> const char * {
+  switch (index_type) {
+    case IndexType::BPlusTreeIndex:
+      return "btree";
+    case IndexType::HashTableIndex:
+      return "hash";
+    case IndexType::ArtIndex:
+      return "art";
+  }
+  return "unknown";
+}
+
+/**
+ * IndexRange describes the keys visited by a range scan. Bounds are key tuples in the index key schema; a missing
+ * bound leaves that side of the range open.
+ */
+struct IndexRange {
+  std::optional<Tuple> lower_;
+  bool lower_inclusive_{true};
+  std::optional<Tuple> upper_;
+  bool upper_inclusive_{true};
+  /** Visit the keys in descending order */
+  bool reverse_{false};
+};
+
+/**
+ * IndexStats describes the structure of an index, for deciding when to rebuild it and for costing index scans. Every
+ * index reports its entries; the fields after is_paged_ only apply to an index stored in pages, such as a B+ tree.
+ */
+struct IndexStats {
+  /** Number of entries in the index */
+  size_t num_entries_{0};
+  /** Whether the index is stored in pages; if not, the fields below do not apply and are left zero */
+  bool is_paged_{false};
+  /** Number of levels, the leaf level included; 0 for an empty index */
+  int height_{0};
+  /** Number of pages on each level, from the root down to the leaves */
+  std::vector<size_t> pages_per_level_;
+  /** Average fraction of a leaf page in use */
+  double fill_factor_{0};
+  /** Estimated number of entries per leaf page, i.e. how many entries one page read of a range scan yields */
+  double keys_per_leaf_{0};
+  /** Structure modifications since the index was opened */
+  size_t num_splits_{0};
+  size_t num_merges_{0};
+  size_t num_redistributions_{0};
+};
+
+/**
+ * IndexRangeScan is an ongoing range scan, returned by Index::ScanRange. It remembers where the last batch ended
+ * and holds no latch in between, so the index may be modified between two batches.
+ */
+class IndexRangeScan {
+ public:
+  virtual ~IndexRangeScan() = default;
+
+  /**
+   * Append the RIDs of the next batch of entries in the range to `result`.
+   * @param entries If not null, the entries themselves are appended as well, as tuples of the entry schema of the index
+   * @return false if the range is exhausted and nothing was appended
+   */
+  virtual auto NextBatch(std::vector<RID> *result, std::vector<Tuple> *entries = nullptr) -> bool = 0;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -139,6 +258,9 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /** @return The attributes stored alongside each key */
+  auto GetIncludeAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetIncludeAttrs(); }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -153,7 +275,7 @@ class Index {
 
   /**
    * Insert an entry into the index.
-   * @param key The index key
+   * @param key The index key; for an index with included columns, a tuple of the entry schema that also holds them
    * @param rid The RID associated with the key
    * @param transaction The transaction context
    */
@@ -175,6 +297,72 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for a batch of keys. The default implementation searches them one at a time; indexes that
+   * can share work between neighbouring keys override it.
+   * @param keys The index keys, in any order and possibly repeated
+   * @param results Receives the RIDs found for keys[i] in results[i]
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  /**
+   * Insert a batch of entries into the index. The default implementation inserts them one at a time; indexes that
+   * can be built faster from a whole batch override it.
+   * @param next Produces the next key (as in InsertEntry) and RID, returns false when the batch is exhausted
+   * @param transaction The transaction context
+   */
+  virtual void BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction) {
+    Tuple key;
+    RID rid;
+    while (next(&key, &rid)) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
+  /**
+   * Start a scan over the entries whose keys lie in a range, in key order. Only ordered indexes support it.
+   * @param range The keys to visit
+   * @param transaction The transaction context
+   * @return The scan, positioned before the first entry of the range
+   */
+  virtual auto ScanRange(const IndexRange &range, Transaction *transaction) -> std::unique_ptr<IndexRangeScan> {
+    throw NotImplementedException("range scans are not supported by this index");
+  }
+
+  /**
+   * Split a forward range scan into consecutive scans over disjoint sub-ranges, so that they can run in parallel.
+   * Concatenating the entries of the returned scans in order yields the entries of ScanRange(range).
+   * @param range The keys to visit, must not be reversed
+   * @param num_partitions The maximum number of scans to return
+   * @param transaction The transaction context
+   * @return At least one scan; a single one if the index cannot split the range
+   */
+  virtual auto ScanRangePartitioned(const IndexRange &range, size_t num_partitions, Transaction *transaction)
+      -> std::vector<std::unique_ptr<IndexRangeScan>> {
+    std::vector<std::unique_ptr<IndexRangeScan>> scans;
+    scans.push_back(ScanRange(range, transaction));
+    return scans;
+  }
+
+  /**
+   * Collect statistics about the structure of the index. This may visit every page of the index.
+   * @return The statistics, or nothing if the index does not keep any
+   */
+  virtual auto GetStats() -> std::optional<IndexStats> { return std::nullopt; }
+
+  /**
+   * Count the entries of the index without visiting its pages, e.g. for estimating the cardinality of its table.
+   * @return The number of entries, or nothing if the index does not keep count
+   */
+  virtual auto GetNumEntries() -> std::optional<size_t> { return std::nullopt; }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
@@ -13,41 +13,86 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <optional>
+#include <utility>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * The iterator owns a pin and a read latch on the leaf page it points into. The latch is handed over leaf by leaf
+ * (left to right) while advancing, and released once the iterator reaches the end or is destroyed. Iterators are
+ * therefore move-only.
+ *
+ * A reverse iterator walks the prev links instead. Waiting on the left neighbour while holding a leaf would invert
+ * the latch order, so it only tries the latch and, if that fails, lets go of its leaf and searches the tree again
+ * for the largest key below the current leaf.
+ *
+ * A stop key bounds the iteration.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
-  // you may define your own constructor based on your member variables
-  IndexIterator(LeafPage *page, int index, BufferPoolManager *buffer_pool_manager);
-  IndexIterator(int index, page_id_t page_id, BufferPoolManager *buffer_pool_manager);
-  // IndexIterator(GenericKey key, RID rid, GenericComparator comparator);
+  // page must be pinned and read-latched, the iterator takes over both
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index);
+  // same, for a reverse iterator over `tree`; index may be -1 to start at the end of the previous leaf
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *buffer_pool_manager,
+                Page *page, int index);
 
   IndexIterator();
   ~IndexIterator();  // NOLINT
 
+  IndexIterator(const IndexIterator &) = delete;
+  auto operator=(const IndexIterator &) -> IndexIterator & = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
+
   auto IsEnd() -> bool;
 
   auto operator*() -> const MappingType &;
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return GetPageId() == itr.GetPageId() && index_ == itr.index_;
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
+
+  // end the iteration at `key`: a forward iterator ends after it (inclusive) or at it, a reverse iterator likewise
+  // in descending order. The comparator must outlive the iterator
+  void SetStopKey(const KeyType &key, bool inclusive, const KeyComparator *comparator);
 
  private:
-  // add your own private member variables here
-  LeafPage *page_;
-  int index_;
-  BufferPoolManager *buffer_pool_manager_;
-  page_id_t page_id_;
+  auto GetPageId() const -> page_id_t { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+  // skip to the next non-empty leaf while index_ is past the end of the current one
+  void SkipExhaustedPages();
+  // reverse counterpart: step back to the previous non-empty leaf while index_ is before the start of this one
+  void SkipExhaustedPagesReverse();
+  // end the iteration if the current entry is past the stop key
+  void CheckStopKey();
+  // release the current page, ending the iteration
+  void Release();
+
+  /* 非空表示反向迭代器 */
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  int index_{0};
+  std::optional<KeyType> stop_key_;
+  bool stop_inclusive_{true};
+  const KeyComparator *comparator_{nullptr};
+  /* 变长key的页面不直接保存条目，operator*返回解码后的副本 */
+  MappingType item_;
 };
 
 }  // namespace bustub
@@ -11,14 +11,18 @@
 #pragma once
 
 #include <queue>
+#include <vector>
 
+#include "storage/page/b_plus_tree_key_array.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_SIZE                                                                                     \
+  (BPlusTreeKeyArray<KeyType, page_id_t>::MaxCount(BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - sizeof(KeyType), \
+                                                   sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -29,33 +33,53 @@ namespace bustub {
  *
  * Internal page format (keys are stored in increasing order):
  *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
+ * | HEADER | HIGH KEY | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * Like a leaf page, every key in the subtree is less than the high key, which is
+ * the separator of the next page on this level; it is only meaningful when
+ * NextPageId is valid.
+ *
+ * Wide keys are stored in slots with their shared prefix stored once, as in a
+ * leaf page, and the page is full when its bytes run out.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
+  using KeyArray = BPlusTreeKeyArray<KeyType, ValueType>;
+
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, int max_size = INTERNAL_PAGE_SIZE);
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
   auto ValueAt(int index) const -> ValueType;
   void SetValueAt(int index, const ValueType &value);
-  void InsertByKey(const KeyType &key, const ValueType &value, const KeyComparator &comparator,
-                   BufferPoolManager *buffer_pool_manager);
+  auto GetHighKey() const -> const KeyType &;
+  void SetHighKey(const KeyType &key);
+  void InsertByKey(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   void MoveHalfDataAndInsertTo(B_PLUS_TREE_INTERNAL_PAGE_TYPE *des_page, const KeyType &key, const page_id_t &value,
-                               const KeyComparator &comparator, BufferPoolManager *buffer_pool_manager);
+                               const KeyComparator &comparator);
   void RemoveByIndex(int index);
   void RemoveByValue(const page_id_t &value);
-  void InsertByIndex(int index, const KeyType &key, const ValueType &value, const KeyComparator &comparator,
-                     BufferPoolManager *buffer_pool_manager);
+  void InsertByIndex(int index, const KeyType &key, const ValueType &value);
   auto GetIndexByValue(const ValueType &value) -> int;
-  void MoveAllDataTo(B_PLUS_TREE_INTERNAL_PAGE_TYPE *des_page, const KeyComparator &comparator,
-                     BufferPoolManager *buffer_pool_manager);
+  auto GetIndexByKey(const KeyType &key, const KeyComparator &comparator) const -> int;
+  auto GetIndexBeforeKey(const KeyType &key, const KeyComparator &comparator) const -> int;
+  void MoveAllDataTo(B_PLUS_TREE_INTERNAL_PAGE_TYPE *des_page, const KeyType &middle_key);
+  // byte-aware capacity checks, see BPlusTreeLeafPage
+  auto HasRoomFor(const KeyType &key, double fill_factor = 1) const -> bool;
+  auto HasRoomFor(const KeyType &key, const KeyType &other_key) const -> bool;
+  auto CanReplaceKey(int index, const KeyType &key) const -> bool;
+  auto CanMergeFrom(const B_PLUS_TREE_INTERNAL_PAGE_TYPE *src_page, const KeyType &middle_key) const -> bool;
+  auto IsUnderflow() const -> bool;
+  auto CanSpareEntry() const -> bool;
+  // fraction of the page in use: by bytes for variable-length keys, by entries otherwise
+  auto GetFillRatio() const -> double;
 
  private:
-  // Flexible array member for page data.
-  MappingType array_[1];
+  KeyType high_key_;
+  // page data, up to the end of the page
+  KeyArray array_;
 };
 }  // namespace bustub
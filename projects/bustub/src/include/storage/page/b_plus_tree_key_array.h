@@ -0,0 +1,458 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_array.h
+//
+// Identification: src/include/storage/page/b_plus_tree_key_array.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * The entries of a B+ tree page stored in place, as an array of (key, value) pairs.
+ *
+ * Every entry takes the same number of bytes, so a page is full exactly when it holds max_size entries: the byte-based
+ * checks always pass and the tree only looks at the number of entries. The page passes its size to every method that
+ * needs it.
+ */
+template <typename KeyType, typename ValueType>
+class FixedKeyArray {
+  using Entry = std::pair<KeyType, ValueType>;
+
+ public:
+  /** @return the number of entries of `entry_size` bytes that fit in `capacity` bytes */
+  static constexpr auto MaxCount(size_t capacity, size_t entry_size) -> int {
+    return static_cast<int>(capacity / entry_size);
+  }
+
+  /** @return where to split `count` sorted entries between two pages: after `count_split` of them */
+  static auto SplitIndex(const Entry * /*entries*/, int /*count*/, int count_split) -> int { return count_split; }
+
+  /** @return the key that separates `left` from the greater `right` in the parent page: `right` itself */
+  static auto Separator(const KeyType & /*left*/, const KeyType &right) -> KeyType { return right; }
+
+  void Init(size_t /*capacity*/) {}
+
+  auto KeyAt(int index) const -> KeyType { return entries_[index].first; }
+  auto ValueAt(int index) const -> ValueType { return entries_[index].second; }
+  void SetValueAt(int index, const ValueType &value) { entries_[index].second = value; }
+  void SetKeyAt(int /*size*/, int index, const KeyType &key) { entries_[index].first = key; }
+
+  /** @return the first index in [begin, end) whose key fails `pred`, given that the keys passing it come first */
+  template <typename Pred>
+  auto PartitionPoint(int begin, int end, Pred pred) const -> int {
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      if (pred(entries_[mid].first)) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+  void InsertAt(int size, int index, const KeyType &key, const ValueType &value) {
+    for (int i = size; i > index; i--) {
+      entries_[i] = entries_[i - 1];
+    }
+    entries_[index] = {key, value};
+  }
+
+  void RemoveAt(int size, int index) {
+    for (int i = index; i < size - 1; i++) {
+      entries_[i] = entries_[i + 1];
+    }
+  }
+
+  auto Entries(int size) const -> std::vector<Entry> { return std::vector<Entry>(entries_, entries_ + size); }
+
+  /** Replace all entries with `count` sorted ones. */
+  void Assign(const Entry *entries, int count) { std::copy(entries, entries + count, entries_); }
+
+  /** Add sorted entries that are all greater than the current ones. */
+  void Append(int size, const std::vector<Entry> &entries) {
+    std::copy(entries.begin(), entries.end(), entries_ + size);
+  }
+
+  auto HasRoomFor(int /*size*/, const KeyType & /*key*/, double /*fill_factor*/ = 1) const -> bool { return true; }
+  auto HasRoomFor(int /*size*/, const KeyType & /*key*/, const KeyType & /*other_key*/) const -> bool { return true; }
+  auto HasRoomToReplace(int /*size*/, int /*index*/, const KeyType & /*key*/) const -> bool { return true; }
+  auto HasRoomToMerge(int /*size*/, const FixedKeyArray & /*src*/, int /*src_size*/,
+                      const KeyType * /*first_key*/) const -> bool {
+    return true;
+  }
+  auto IsLessThanHalfFull(int /*size*/) const -> bool { return true; }
+  auto CanSpareEntry(int /*size*/) const -> bool { return false; }
+
+  /** @return the fraction of the page in use, measured in entries */
+  auto FillRatio(int size, int max_size) const -> double { return static_cast<double>(size) / max_size; }
+
+ private:
+  // Flexible array member for page data.
+  Entry entries_[1];
+};
+
+/**
+ * The entries of a B+ tree page with wide keys, in a slotted, prefix-compressed layout:
+ *
+ *  --------------------------------------------------------------------------------------------
+ * | HEADER | PREFIX | SLOT(1) | SLOT(2) | ... | SLOT(n) | ... free ... | ENTRY(j) | ... | ENTRY(k) |
+ *  --------------------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 8 bytes in total):
+ *  ------------------------------------------------------------------
+ * | Capacity (2) | PrefixLength (2) | HeapBegin (2) | UsedBytes (2) |
+ *  ------------------------------------------------------------------
+ *
+ * The leading bytes that all keys of the page share are stored once, as the prefix. The slots hold the offsets of the
+ * entries in key order; the entries themselves are appended from the end of the page towards the slots. An entry holds
+ * the value and the rest of its key after the prefix, with the longest run of zero bytes left out:
+ *
+ *  ---------------------------------------------------------------
+ * | VALUE | HeadLength (2) | ZeroRunLength (2) | HEAD | TAIL |
+ *  ---------------------------------------------------------------
+ *
+ * This drops the zero padding after a short key as well as the padding between the key columns and the RID of a
+ * non-unique index, so an entry takes about as many bytes as its key really needs. A page is full when its bytes run
+ * out rather than at max_size entries, which only bounds the number of slots.
+ *
+ * Removing an entry frees its slot only. The space of removed entries is reclaimed by rebuilding the page when an
+ * insert does not find enough contiguous free space, or when a key that does not start with the prefix shortens it.
+ */
+template <typename KeyType, typename ValueType>
+class SlottedKeyArray {
+  using Entry = std::pair<KeyType, ValueType>;
+
+ public:
+  static constexpr size_t HEADER_SIZE = 4 * sizeof(uint16_t);
+  static constexpr size_t SLOT_SIZE = sizeof(uint16_t);
+  static constexpr size_t ENTRY_HEADER_SIZE = sizeof(ValueType) + 2 * sizeof(uint16_t);
+
+  /** @return the most entries that fit in `capacity` bytes, when the prefix takes up their whole keys */
+  static constexpr auto MaxCount(size_t capacity, size_t /*entry_size*/) -> int {
+    return static_cast<int>((capacity - HEADER_SIZE) / (SLOT_SIZE + ENTRY_HEADER_SIZE));
+  }
+
+  /** @return where to split `count` sorted entries between two pages so that both get about half of the bytes */
+  static auto SplitIndex(const Entry *entries, int count, int /*count_split*/) -> int {
+    size_t total_bytes = 0;
+    for (int i = 0; i < count; i++) {
+      total_bytes += EntrySize(entries[i].first, 0);
+    }
+    size_t left_bytes = 0;
+    int index = 0;
+    while (index < count - 1 && left_bytes * 2 < total_bytes) {
+      left_bytes += EntrySize(entries[index].first, 0);
+      index++;
+    }
+    return std::max(index, 1);
+  }
+
+  /**
+   * @return the shortest key greater than `left` and not greater than `right` (suffix truncation): the bytes of
+   * `right` up to and including the first one that differs from `left`, followed by zeros. Since the zeros are left
+   * out of the entry, the separator takes only as many bytes as are needed to tell the two pages apart.
+   */
+  static auto Separator(const KeyType &left, const KeyType &right) -> KeyType {
+    const auto *right_data = reinterpret_cast<const char *>(&right);
+    size_t len = CommonPrefixLength(reinterpret_cast<const char *>(&left), right_data, sizeof(KeyType));
+    KeyType separator;
+    auto *data = reinterpret_cast<char *>(&separator);
+    memset(data, 0, sizeof(KeyType));
+    memcpy(data, right_data, std::min(len + 1, sizeof(KeyType)));
+    return separator;
+  }
+
+  void Init(size_t capacity) {
+    capacity_ = capacity - HEADER_SIZE;
+    prefix_len_ = 0;
+    heap_begin_ = capacity_;
+    used_bytes_ = 0;
+  }
+
+  auto KeyAt(int index) const -> KeyType {
+    KeyType key;
+    auto *data = reinterpret_cast<char *>(&key);
+    memcpy(data, data_, prefix_len_);
+    DecodeSuffix(index, data);
+    return key;
+  }
+
+  auto ValueAt(int index) const -> ValueType {
+    ValueType value;
+    memcpy(static_cast<void *>(&value), data_ + SlotAt(index), sizeof(ValueType));
+    return value;
+  }
+
+  void SetValueAt(int index, const ValueType &value) {
+    memcpy(data_ + SlotAt(index), static_cast<const void *>(&value), sizeof(ValueType));
+  }
+
+  void SetKeyAt(int size, int index, const KeyType &key) {
+    ValueType value = ValueAt(index);
+    RemoveAt(size, index);
+    InsertAt(size - 1, index, key, value);
+  }
+
+  /** @return the first index in [begin, end) whose key fails `pred`, given that the keys passing it come first */
+  template <typename Pred>
+  auto PartitionPoint(int begin, int end, Pred pred) const -> int {
+    /* 前缀只复制一次，每次比较只解码key的剩余部分 */
+    KeyType key;
+    auto *data = reinterpret_cast<char *>(&key);
+    memcpy(data, data_, prefix_len_);
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      DecodeSuffix(mid, data);
+      if (pred(key)) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+  void InsertAt(int size, int index, const KeyType &key, const ValueType &value) {
+    size_t prefix_len = SharedPrefixLength(key);
+    size_t entry_size = EntrySize(key, prefix_len);
+
+    /* key不以前缀开头，或者连续的空闲空间不够时，重建整个页面 */
+    if (prefix_len < prefix_len_ || heap_begin_ < prefix_len_ + (size + 1) * SLOT_SIZE + entry_size) {
+      std::vector<Entry> entries = Entries(size);
+      entries.insert(entries.begin() + index, {key, value});
+      Rebuild(entries.data(), size + 1, prefix_len);
+      return;
+    }
+
+    heap_begin_ -= entry_size;
+    WriteEntry(heap_begin_, key, value);
+    char *slots = data_ + prefix_len_;
+    memmove(slots + (index + 1) * SLOT_SIZE, slots + index * SLOT_SIZE, (size - index) * SLOT_SIZE);
+    SetSlot(index, heap_begin_);
+    used_bytes_ += entry_size;
+  }
+
+  void RemoveAt(int size, int index) {
+    used_bytes_ -= EntrySizeAt(index);
+    char *slots = data_ + prefix_len_;
+    memmove(slots + index * SLOT_SIZE, slots + (index + 1) * SLOT_SIZE, (size - index - 1) * SLOT_SIZE);
+  }
+
+  auto Entries(int size) const -> std::vector<Entry> {
+    std::vector<Entry> entries;
+    entries.reserve(size);
+    for (int i = 0; i < size; i++) {
+      entries.emplace_back(KeyAt(i), ValueAt(i));
+    }
+    return entries;
+  }
+
+  /** Replace all entries with `count` sorted ones, taking the longest prefix they share. */
+  void Assign(const Entry *entries, int count) {
+    size_t prefix_len = count == 0 ? 0 : sizeof(KeyType);
+    for (int i = 1; i < count; i++) {
+      prefix_len = CommonPrefixLength(reinterpret_cast<const char *>(&entries[0].first),
+                                      reinterpret_cast<const char *>(&entries[i].first), prefix_len);
+    }
+    Rebuild(entries, count, prefix_len);
+  }
+
+  /** Add sorted entries that are all greater than the current ones. */
+  void Append(int size, const std::vector<Entry> &entries) {
+    std::vector<Entry> all_entries = Entries(size);
+    all_entries.insert(all_entries.end(), entries.begin(), entries.end());
+    Assign(all_entries.data(), static_cast<int>(all_entries.size()));
+  }
+
+  /** @return whether an entry with `key` fits, using at most `fill_factor` of the page */
+  auto HasRoomFor(int size, const KeyType &key, double fill_factor = 1) const -> bool {
+    size_t prefix_len = SharedPrefixLength(key);
+    return static_cast<double>(BytesWithPrefix(size, prefix_len) + SLOT_SIZE + EntrySize(key, prefix_len)) <=
+           fill_factor * capacity_;
+  }
+
+  /** @return whether entries with `key` and `other_key` both fit */
+  auto HasRoomFor(int size, const KeyType &key, const KeyType &other_key) const -> bool {
+    size_t prefix_len = std::min(SharedPrefixLength(key), SharedPrefixLength(other_key));
+    return BytesWithPrefix(size, prefix_len) + 2 * SLOT_SIZE + EntrySize(key, prefix_len) +
+               EntrySize(other_key, prefix_len) <=
+           capacity_;
+  }
+
+  /** @return whether the entry at `index` still fits when its key becomes `key` */
+  auto HasRoomToReplace(int size, int index, const KeyType &key) const -> bool {
+    size_t prefix_len = SharedPrefixLength(key);
+    return BytesWithPrefix(size, prefix_len) - (EntrySizeAt(index) + prefix_len_ - prefix_len) +
+               EntrySize(key, prefix_len) <=
+           capacity_;
+  }
+
+  /** @return whether the entries of `src` fit as well, with the key of its first entry replaced by `*first_key` */
+  auto HasRoomToMerge(int size, const SlottedKeyArray &src, int src_size, const KeyType *first_key) const -> bool {
+    size_t prefix_len = CommonPrefixLength(data_, src.data_, std::min(prefix_len_, src.prefix_len_));
+    if (first_key != nullptr) {
+      prefix_len = std::min(prefix_len, SharedPrefixLength(*first_key));
+    }
+    /* 被替换的首个key仍按原大小计算；合并后重新计算的前缀可能更长，按最长的前缀预留空间 */
+    size_t bytes = BytesWithPrefix(size, prefix_len) + src.BytesWithPrefix(src_size, prefix_len) - 2 * prefix_len;
+    if (first_key != nullptr) {
+      bytes += EntrySize(*first_key, prefix_len);
+    }
+    return bytes + sizeof(KeyType) <= capacity_;
+  }
+
+  auto IsLessThanHalfFull(int size) const -> bool { return BytesWithPrefix(size, prefix_len_) * 2 < capacity_; }
+
+  /** @return whether the page stays at least half full after losing any one entry */
+  auto CanSpareEntry(int size) const -> bool {
+    size_t max_entry_size = SLOT_SIZE + ENTRY_HEADER_SIZE + sizeof(KeyType) - prefix_len_;
+    return BytesWithPrefix(size, prefix_len_) >= capacity_ / 2 + max_entry_size;
+  }
+
+  /** @return the fraction of the page in use, measured in bytes */
+  auto FillRatio(int size, int /*max_size*/) const -> double {
+    return static_cast<double>(BytesWithPrefix(size, prefix_len_)) / capacity_;
+  }
+
+ private:
+  /** @return the bytes an entry with `key` takes after a prefix of `prefix_len` bytes */
+  static auto EntrySize(const KeyType &key, size_t prefix_len) -> size_t {
+    return ENTRY_HEADER_SIZE + sizeof(KeyType) - prefix_len - LongestZeroRun(key, prefix_len).second;
+  }
+
+  /** @return the offset and the length of the longest run of zero bytes in `key` after `prefix_len` bytes */
+  static auto LongestZeroRun(const KeyType &key, size_t prefix_len) -> std::pair<size_t, size_t> {
+    const auto *data = reinterpret_cast<const char *>(&key);
+    std::pair<size_t, size_t> longest{sizeof(KeyType), 0};
+    size_t i = prefix_len;
+    while (i < sizeof(KeyType)) {
+      if (data[i] != 0) {
+        i++;
+        continue;
+      }
+      size_t run_begin = i;
+      while (i < sizeof(KeyType) && data[i] == 0) {
+        i++;
+      }
+      if (i - run_begin > longest.second) {
+        longest = {run_begin, i - run_begin};
+      }
+    }
+    return longest;
+  }
+
+  static auto CommonPrefixLength(const char *lhs, const char *rhs, size_t limit) -> size_t {
+    size_t len = 0;
+    while (len < limit && lhs[len] == rhs[len]) {
+      len++;
+    }
+    return len;
+  }
+
+  /** @return how many bytes of the prefix `key` starts with */
+  auto SharedPrefixLength(const KeyType &key) const -> size_t {
+    return CommonPrefixLength(data_, reinterpret_cast<const char *>(&key), prefix_len_);
+  }
+
+  /** @return an upper bound of the bytes the entries take once the prefix is cut down to `prefix_len` bytes */
+  auto BytesWithPrefix(int size, size_t prefix_len) const -> size_t {
+    return prefix_len + size * (SLOT_SIZE + prefix_len_ - prefix_len) + used_bytes_;
+  }
+
+  auto SlotAt(int index) const -> uint16_t {
+    uint16_t offset;
+    memcpy(&offset, data_ + prefix_len_ + index * SLOT_SIZE, SLOT_SIZE);
+    return offset;
+  }
+
+  void SetSlot(int index, uint16_t offset) { memcpy(data_ + prefix_len_ + index * SLOT_SIZE, &offset, SLOT_SIZE); }
+
+  auto EntrySizeAt(int index) const -> size_t {
+    uint16_t zero_run_len;
+    memcpy(&zero_run_len, data_ + SlotAt(index) + sizeof(ValueType) + sizeof(uint16_t), sizeof(uint16_t));
+    return ENTRY_HEADER_SIZE + sizeof(KeyType) - prefix_len_ - zero_run_len;
+  }
+
+  /** Write the bytes of the key at `index` that follow the prefix into `key`. */
+  void DecodeSuffix(int index, char *key) const {
+    const char *entry = data_ + SlotAt(index);
+    uint16_t head_len;
+    uint16_t zero_run_len;
+    memcpy(&head_len, entry + sizeof(ValueType), sizeof(uint16_t));
+    memcpy(&zero_run_len, entry + sizeof(ValueType) + sizeof(uint16_t), sizeof(uint16_t));
+    char *suffix = key + prefix_len_;
+    memcpy(suffix, entry + ENTRY_HEADER_SIZE, head_len);
+    memset(suffix + head_len, 0, zero_run_len);
+    memcpy(suffix + head_len + zero_run_len, entry + ENTRY_HEADER_SIZE + head_len,
+           sizeof(KeyType) - prefix_len_ - head_len - zero_run_len);
+  }
+
+  void WriteEntry(size_t offset, const KeyType &key, const ValueType &value) {
+    char *entry = data_ + offset;
+    auto [zero_run_begin, zero_run_len] = LongestZeroRun(key, prefix_len_);
+    auto head_len = static_cast<uint16_t>(zero_run_begin - prefix_len_);
+    auto run_len = static_cast<uint16_t>(zero_run_len);
+    const auto *data = reinterpret_cast<const char *>(&key);
+    memcpy(entry, static_cast<const void *>(&value), sizeof(ValueType));
+    memcpy(entry + sizeof(ValueType), &head_len, sizeof(uint16_t));
+    memcpy(entry + sizeof(ValueType) + sizeof(uint16_t), &run_len, sizeof(uint16_t));
+    memcpy(entry + ENTRY_HEADER_SIZE, data + prefix_len_, head_len);
+    memcpy(entry + ENTRY_HEADER_SIZE + head_len, data + zero_run_begin + zero_run_len,
+           sizeof(KeyType) - zero_run_begin - zero_run_len);
+  }
+
+  /** Rewrite the page with `count` sorted entries that all start with the same `prefix_len` bytes. */
+  void Rebuild(const Entry *entries, int count, size_t prefix_len) {
+    size_t bytes = prefix_len + count * SLOT_SIZE;
+    for (int i = 0; i < count; i++) {
+      bytes += EntrySize(entries[i].first, prefix_len);
+    }
+    BUSTUB_ASSERT(bytes <= capacity_, "entries do not fit in the page");
+
+    prefix_len_ = prefix_len;
+    heap_begin_ = capacity_;
+    used_bytes_ = 0;
+    if (count > 0) {
+      memcpy(data_, &entries[0].first, prefix_len);
+    }
+    for (int i = 0; i < count; i++) {
+      size_t entry_size = EntrySize(entries[i].first, prefix_len);
+      heap_begin_ -= entry_size;
+      WriteEntry(heap_begin_, entries[i].first, entries[i].second);
+      SetSlot(i, heap_begin_);
+      used_bytes_ += entry_size;
+    }
+  }
+
+  uint16_t capacity_;
+  uint16_t prefix_len_;
+  uint16_t heap_begin_;
+  uint16_t used_bytes_;
+  // Flexible array member for page data.
+  char data_[1];
+};
+
+/** Keys at least SLOTTED_KEY_MIN_SIZE bytes wide are stored in slots, narrower ones in place. */
+template <typename KeyType, typename ValueType>
+using BPlusTreeKeyArray = std::conditional_t<(sizeof(KeyType) >= static_cast<size_t>(SLOTTED_KEY_MIN_SIZE)),
+                                             SlottedKeyArray<KeyType, ValueType>, FixedKeyArray<KeyType, ValueType>>;
+
+}  // namespace bustub
@@ -13,13 +13,16 @@
 #include <utility>
 #include <vector>
 
+#include "storage/page/b_plus_tree_key_array.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
 #define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_SIZE                                                                                  \
+  (BPlusTreeKeyArray<KeyType, ValueType>::MaxCount(BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType), \
+                                                   sizeof(MappingType)))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -28,37 +31,60 @@ namespace bustub {
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ * | HEADER | HIGH KEY | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
  *  Header format (size in byte, 28 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ----------------------------------------------------------------
+ * | NextPageId (4) | PageId (4) | PrevPageId (4)
+ *  ----------------------------------------------------------------
+ *
+ * All keys of the page are less than its high key, which is the first key of
+ * the next page. The high key is only meaningful when NextPageId is valid.
+ *
+ * Keys of SLOTTED_KEY_MIN_SIZE bytes or more (varchars, composite keys) are
+ * stored in a slotted layout instead, with the prefix they share stored once
+ * (see SlottedKeyArray). Such a page is full when its bytes run out, so the
+ * tree asks HasRoomFor before inserting and IsUnderflow after removing rather
+ * than comparing the size with max_size and min_size.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
+  using KeyArray = BPlusTreeKeyArray<KeyType, ValueType>;
+
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, int max_size = LEAF_PAGE_SIZE);
   // helper methods
-  auto GetNextPageId() const -> page_id_t;
-  void SetNextPageId(page_id_t next_page_id);
+  auto GetHighKey() const -> const KeyType &;
+  void SetHighKey(const KeyType &key);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
   auto KeyAt(int index) const -> KeyType;
   auto ValueAt(int index) const -> ValueType;
+  auto GetItem(int index) const -> MappingType;
+  auto GetIndexByKey(const KeyType &key, const KeyComparator &comparator) const -> int;
   auto InsertByKey(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> bool;
   void MoveHalfDataTo(B_PLUS_TREE_LEAF_PAGE_TYPE *des_page);
   void RemoveByIndex(int index);
   auto RemoveByKey(const KeyType &key, const KeyComparator &comparator) -> bool;
   void MoveAllDataTo(B_PLUS_TREE_LEAF_PAGE_TYPE *des_page);
+  // byte-aware capacity checks, see the class comment
+  auto HasRoomFor(const KeyType &key, double fill_factor = 1) const -> bool;
+  auto CanMergeFrom(const B_PLUS_TREE_LEAF_PAGE_TYPE *src_page) const -> bool;
+  auto IsUnderflow() const -> bool;
+  auto CanSpareEntry() const -> bool;
+  // fraction of the page in use: by bytes for variable-length keys, by entries otherwise
+  auto GetFillRatio() const -> double;
 
  private:
-  page_id_t next_page_id_;
-  // Flexible array member for page data.
-  MappingType array_[1];
+  page_id_t prev_page_id_;
+  KeyType high_key_;
+  // page data, up to the end of the page
+  KeyArray array_;
 };
 }  // namespace bustub
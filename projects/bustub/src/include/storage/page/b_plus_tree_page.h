@@ -37,13 +37,17 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | NextPageId (4) | PageId(4) |
  * ----------------------------------------------------------------------------
+ *
+ * Pages do not point to their parents. Instead every page links to its right
+ * sibling on the same level (NextPageId) and stores a high key that bounds its
+ * keys from above, so a reader that arrives at a page after a concurrent split
+ * moved the key it looks for follows the link instead of restarting (B-link tree).
  */
 class BPlusTreePage {
  public:
   auto IsLeafPage() const -> bool;
-  auto IsRootPage() const -> bool;
   void SetPageType(IndexPageType page_type);
 
   auto GetSize() const -> int;
@@ -55,8 +59,8 @@ class BPlusTreePage {
   void SetMaxSize(int max_size);
   auto GetMinSize() const -> int;
 
-  auto GetParentPageId() const -> page_id_t;
-  void SetParentPageId(page_id_t parent_page_id);
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
 
   auto GetPageId() const -> page_id_t;
   void SetPageId(page_id_t page_id);
@@ -69,7 +73,7 @@ class BPlusTreePage {
   lsn_t lsn_ __attribute__((__unused__));
   int size_ __attribute__((__unused__));
   int max_size_ __attribute__((__unused__));
-  page_id_t parent_page_id_ __attribute__((__unused__));
+  page_id_t next_page_id_ __attribute__((__unused__));
   page_id_t page_id_ __attribute__((__unused__));
 };
 
@@ -33,6 +33,9 @@ namespace bustub {
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ *  A bucket that is full of entries the directory cannot split apart, such as the values of a single key, continues
+ *  in a chain of overflow pages of the same format.
+ *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -137,7 +140,14 @@ class HashTableBucketPage {
    */
   void PrintBucket();
 
+  /** @return the page_id of the next page in the overflow chain of the bucket, INVALID_PAGE_ID if there is none */
+  auto GetOverflowPageId() const -> page_id_t { return overflow_page_id_; }
+
+  /** Link the next page of the overflow chain; new bucket pages must set INVALID_PAGE_ID. */
+  void SetOverflowPageId(page_id_t overflow_page_id) { overflow_page_id_ = overflow_page_id; }
+
  private:
+  page_id_t overflow_page_id_;
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
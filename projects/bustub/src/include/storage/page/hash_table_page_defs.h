@@ -28,6 +28,12 @@
  */
 #define BLOCK_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
 
+/**
+ * HEADER_ARRAY_SIZE is the number of block page_ids that fit in a linear probe hash header page behind its lsn_,
+ * size_, page_id_ and next_ind_ fields, which take 32 bytes with padding. It caps how far the table can grow.
+ */
+#define HEADER_ARRAY_SIZE ((BUSTUB_PAGE_SIZE - 32) / sizeof(page_id_t))
+
 /**
  * Extendible Hashing Definitions
  */
@@ -36,9 +42,9 @@
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hash index bucket page.
  * The computation is the same as the above BLOCK_ARRAY_SIZE, but blocks and buckets have different implementations
- * of search, insertion, removal, and helper methods.
+ * of search, insertion, removal, and helper methods. A bucket page also starts with the page_id of its overflow page.
  */
-#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * (BUSTUB_PAGE_SIZE - sizeof(page_id_t)) / (4 * sizeof(MappingType) + 1))
 
 /**
  * DIRECTORY_ARRAY_SIZE is the number of page_ids that can fit in the directory page of an extendible hash index.
@@ -68,6 +68,9 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Acquire the page read latch if that does not need to wait. @return true if the latch was acquired */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
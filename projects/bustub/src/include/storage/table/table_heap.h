@@ -13,6 +13,7 @@
 #pragma once
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/extent_allocator.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
@@ -36,9 +37,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param first_page_id the id of the first page
+   * @param io_owner the object that I/O on new pages of this table is attributed to
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, IOObject io_owner = {});
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -46,9 +48,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param io_owner the object that I/O on the pages of this table is attributed to
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, IOObject io_owner = {});
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
@@ -113,6 +116,8 @@ class TableHeap {
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** Allocates the pages of this table from its own extents, so that a sequential scan reads adjacent pages. */
+  ExtentAllocator extent_allocator_;
 };
 
 }  // namespace bustub
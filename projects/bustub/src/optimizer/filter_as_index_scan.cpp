@@ -0,0 +1,272 @@
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/like_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** A bound <column> <comparison> <constant> implied by a conjunct. */
+struct ColumnBound {
+  uint32_t col_idx_;
+  ComparisonType comp_type_;
+  AbstractExpressionRef constant_;
+  // whether the bounds of the conjunct are all there is to it, otherwise it is still checked by a filter
+  bool exact_{true};
+};
+
+/** Split an AND tree into its conjuncts. */
+void CollectConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    CollectConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    CollectConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+/** @return whether `value` converts to `type` and back unchanged, so that a key of that type can stand for it */
+auto CastsLosslessly(const Value &value, TypeId type) -> bool {
+  if (value.GetTypeId() == type) {
+    return true;
+  }
+  try {
+    return value.CastAs(type).CastAs(value.GetTypeId()).CompareEquals(value) == CmpBool::CmpTrue;
+  } catch (const std::exception &e) {
+    return false;
+  }
+}
+
+/**
+ * Match a conjunct against <column> <comparison> <constant>, flipping `5 < x` into `x > 5`. A comparison with NULL holds
+ * for no row, while the index keeps NULL keys, so it is left to the filter, and so is a constant the key type cannot
+ * hold, such as '99999999999' against an integer column.
+ */
+auto MatchColumnBound(const AbstractExpressionRef &expr) -> std::optional<ColumnBound> {
+  const auto *comp_expr = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (comp_expr == nullptr || comp_expr->comp_type_ == ComparisonType::NotEqual) {
+    return std::nullopt;
+  }
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(0).get());
+  auto constant = comp_expr->GetChildAt(1);
+  auto comp_type = comp_expr->comp_type_;
+  if (column == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(1).get());
+    constant = comp_expr->GetChildAt(0);
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(constant.get());
+  if (column == nullptr || column->GetTupleIdx() != 0 || constant_expr == nullptr || constant_expr->val_.IsNull() ||
+      !CastsLosslessly(constant_expr->val_, column->GetReturnType())) {
+    return std::nullopt;
+  }
+  return ColumnBound{column->GetColIdx(), comp_type, constant};
+}
+
+/** @return the smallest string greater than every string that starts with prefix, nullopt if there is none */
+auto PrefixSuccessor(std::string prefix) -> std::optional<std::string> {
+  while (!prefix.empty() && static_cast<unsigned char>(prefix.back()) == 0xFF) {
+    prefix.pop_back();
+  }
+  if (prefix.empty()) {
+    return std::nullopt;
+  }
+  prefix.back() = static_cast<char>(static_cast<unsigned char>(prefix.back()) + 1);
+  return prefix;
+}
+
+/**
+ * Match a conjunct against <varchar column> LIKE <constant pattern> whose pattern starts with literal characters: the
+ * strings with that prefix form the range [prefix, successor of prefix). A pattern without wildcards is an equality.
+ */
+auto MatchLikePrefix(const AbstractExpressionRef &expr) -> std::vector<ColumnBound> {
+  const auto *like_expr = dynamic_cast<const LikeExpression *>(expr.get());
+  if (like_expr == nullptr || like_expr->negated_) {
+    return {};
+  }
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(like_expr->GetChildAt(0).get());
+  const auto *pattern = dynamic_cast<const ConstantValueExpression *>(like_expr->GetChildAt(1).get());
+  if (column == nullptr || column->GetTupleIdx() != 0 || column->GetReturnType() != TypeId::VARCHAR ||
+      pattern == nullptr || pattern->val_.IsNull()) {
+    return {};
+  }
+  std::string pattern_str = pattern->val_.ToString();
+  std::string_view rest;
+  std::string prefix = LikeExpression::LiteralPrefix(pattern_str, &rest);
+  if (rest.empty()) {
+    return {ColumnBound{column->GetColIdx(), ComparisonType::Equal,
+                        std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue(prefix))}};
+  }
+  if (prefix.empty()) {
+    return {};
+  }
+  bool exact = rest == "%";
+  std::vector<ColumnBound> bounds{ColumnBound{
+      column->GetColIdx(), ComparisonType::GreaterThanOrEqual,
+      std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue(prefix)), exact}};
+  if (auto successor = PrefixSuccessor(prefix); successor.has_value()) {
+    bounds.push_back(ColumnBound{column->GetColIdx(), ComparisonType::LessThan,
+                                 std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue(*successor)),
+                                 exact});
+  }
+  return bounds;
+}
+
+/** @return the bounds a conjunct puts on a single column, empty if it bounds none */
+auto MatchColumnBounds(const AbstractExpressionRef &expr) -> std::vector<ColumnBound> {
+  if (auto bound = MatchColumnBound(expr); bound.has_value()) {
+    return {*bound};
+  }
+  return MatchLikePrefix(expr);
+}
+
+/** Narrow one side of a range: keep whichever bound admits fewer keys. */
+void TightenBound(AbstractExpressionRef *bound, bool *inclusive, const AbstractExpressionRef &new_bound,
+                  bool new_inclusive, bool is_lower) {
+  if (*bound != nullptr) {
+    const Value &old_value = dynamic_cast<const ConstantValueExpression &>(**bound).val_;
+    const Value &new_value = dynamic_cast<const ConstantValueExpression &>(*new_bound).val_;
+    if (old_value.CompareEquals(new_value) == CmpBool::CmpTrue) {
+      *inclusive = *inclusive && new_inclusive;
+      return;
+    }
+    auto looser = is_lower ? new_value.CompareLessThan(old_value) : new_value.CompareGreaterThan(old_value);
+    if (looser == CmpBool::CmpTrue) {
+      return;
+    }
+  }
+  *bound = new_bound;
+  *inclusive = new_inclusive;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(filter_plan.children_.size() == 1, "Filter with multiple children?? Impossible!");
+  if (filter_plan.GetChildPlan()->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*filter_plan.GetChildPlan());
+  if (seq_scan.filter_predicate_ != nullptr) {
+    return optimized_plan;
+  }
+
+  std::vector<AbstractExpressionRef> conjuncts;
+  CollectConjuncts(filter_plan.GetPredicate(), &conjuncts);
+  std::vector<std::vector<ColumnBound>> bounds;
+  for (const auto &conjunct : conjuncts) {
+    bounds.push_back(MatchColumnBounds(conjunct));
+  }
+
+  // the first bounded column that has a single-column index decides the index; an equality bound can use a hash index
+  std::optional<std::tuple<index_oid_t, std::string>> index;
+  uint32_t col_idx = 0;
+  for (const auto &conjunct_bounds : bounds) {
+    if (!conjunct_bounds.empty()) {
+      bool equality = conjunct_bounds.size() == 1 && conjunct_bounds[0].comp_type_ == ComparisonType::Equal;
+      index = MatchIndex(seq_scan.table_name_, conjunct_bounds[0].col_idx_, equality);
+      if (index.has_value()) {
+        col_idx = conjunct_bounds[0].col_idx_;
+        break;
+      }
+    }
+  }
+  if (!index.has_value()) {
+    return optimized_plan;
+  }
+  // a hash index answers a single equality, the other bounds on its column are checked by the filter
+  const bool point_lookup = catalog_.GetIndex(std::get<0>(*index))->index_type_ == IndexType::HashTableIndex;
+
+  // fold every bound on that column into one range, the remaining conjuncts stay in a filter
+  AbstractExpressionRef lower;
+  bool lower_inclusive = true;
+  AbstractExpressionRef upper;
+  bool upper_inclusive = true;
+  AbstractExpressionRef residual;
+  for (size_t i = 0; i < conjuncts.size(); i++) {
+    const auto &conjunct_bounds = bounds[i];
+    bool use_bounds =
+        !conjunct_bounds.empty() && conjunct_bounds[0].col_idx_ == col_idx &&
+        (!point_lookup ||
+         (conjunct_bounds.size() == 1 && conjunct_bounds[0].comp_type_ == ComparisonType::Equal && lower == nullptr));
+    if (!use_bounds || !conjunct_bounds[0].exact_) {
+      residual = residual == nullptr ? conjuncts[i]
+                                     : std::make_shared<LogicExpression>(residual, conjuncts[i], LogicType::And);
+    }
+    if (!use_bounds) {
+      continue;
+    }
+    for (const auto &bound : conjunct_bounds) {
+      auto comp_type = bound.comp_type_;
+      if (comp_type == ComparisonType::Equal || comp_type == ComparisonType::GreaterThan ||
+          comp_type == ComparisonType::GreaterThanOrEqual) {
+        TightenBound(&lower, &lower_inclusive, bound.constant_, comp_type != ComparisonType::GreaterThan, true);
+      }
+      if (comp_type == ComparisonType::Equal || comp_type == ComparisonType::LessThan ||
+          comp_type == ComparisonType::LessThanOrEqual) {
+        TightenBound(&upper, &upper_inclusive, bound.constant_, comp_type != ComparisonType::LessThan, false);
+      }
+    }
+  }
+
+  // NULL keys sort before every value in the index but satisfy no comparison, so a range bounded only from above starts
+  // right after them
+  if (lower == nullptr && upper != nullptr) {
+    lower = std::make_shared<ConstantValueExpression>(
+        ValueFactory::GetNullValueByType(seq_scan.OutputSchema().GetColumn(col_idx).GetType()));
+    lower_inclusive = false;
+  }
+
+  auto index_scan = std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, std::get<0>(*index), false,
+                                                        std::move(lower), lower_inclusive, std::move(upper),
+                                                        upper_inclusive);
+  if (residual == nullptr) {
+    return index_scan;
+  }
+  return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, std::move(residual), std::move(index_scan));
+}
+
+}  // namespace bustub
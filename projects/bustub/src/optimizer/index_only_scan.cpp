@@ -0,0 +1,89 @@
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** Add the columns of the child tuple that an expression reads to `columns`. */
+void CollectColumns(const AbstractExpressionRef &expr, std::unordered_set<uint32_t> *columns) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr.get()); column != nullptr) {
+    columns->insert(column->GetColIdx());
+  }
+  for (const auto &child : expr->GetChildren()) {
+    CollectColumns(child, columns);
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // only a projection or an aggregation tells which columns of the scan are read at all
+  std::unordered_set<uint32_t> columns;
+  if (optimized_plan->GetType() == PlanType::Projection) {
+    for (const auto &expr : dynamic_cast<const ProjectionPlanNode &>(*optimized_plan).GetExpressions()) {
+      CollectColumns(expr, &columns);
+    }
+  } else if (optimized_plan->GetType() == PlanType::Aggregation) {
+    const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+    for (const auto &expr : agg_plan.GetGroupBys()) {
+      CollectColumns(expr, &columns);
+    }
+    for (const auto &expr : agg_plan.GetAggregates()) {
+      CollectColumns(expr, &columns);
+    }
+  } else {
+    return optimized_plan;
+  }
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Projection with multiple children?? Impossible!");
+
+  // a filter in between passes the tuples of the scan through, so its predicate reads the same columns
+  auto child_plan = optimized_plan->GetChildAt(0);
+  const FilterPlanNode *filter_plan = nullptr;
+  if (child_plan->GetType() == PlanType::Filter) {
+    filter_plan = dynamic_cast<const FilterPlanNode *>(child_plan.get());
+    CollectColumns(filter_plan->GetPredicate(), &columns);
+    child_plan = filter_plan->GetChildPlan();
+  }
+  if (child_plan->GetType() != PlanType::IndexScan) {
+    return optimized_plan;
+  }
+
+  // every column read above the scan must be a key or an included column of the index
+  const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan);
+  const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+  std::unordered_set<uint32_t> covered(index_info->index_->GetKeyAttrs().begin(),
+                                       index_info->index_->GetKeyAttrs().end());
+  covered.insert(index_info->index_->GetIncludeAttrs().begin(), index_info->index_->GetIncludeAttrs().end());
+  for (auto column : columns) {
+    if (covered.count(column) == 0) {
+      return optimized_plan;
+    }
+  }
+
+  AbstractPlanNodeRef scan_plan = std::make_shared<IndexOnlyScanPlanNode>(index_scan.output_schema_, index_scan);
+  if (filter_plan != nullptr) {
+    scan_plan = filter_plan->CloneWithChildren({std::move(scan_plan)});
+  }
+  return optimized_plan->CloneWithChildren({std::move(scan_plan)});
+}
+
+}  // namespace bustub
@@ -21,15 +21,23 @@
 
 namespace bustub {
 
-auto Optimizer::MatchIndex(const std::string &table_name, uint32_t index_key_idx)
+auto Optimizer::MatchIndex(const std::string &table_name, uint32_t index_key_idx, bool point_lookup)
     -> std::optional<std::tuple<index_oid_t, std::string>> {
   const auto key_attrs = std::vector{index_key_idx};
+  std::optional<std::tuple<index_oid_t, std::string>> match;
   for (const auto *index_info : catalog_.GetTableIndexes(table_name)) {
-    if (key_attrs == index_info->index_->GetKeyAttrs()) {
-      return std::make_optional(std::make_tuple(index_info->index_oid_, index_info->name_));
+    if (key_attrs != index_info->index_->GetKeyAttrs()) {
+      continue;
+    }
+    if (index_info->index_type_ == IndexType::HashTableIndex) {
+      if (point_lookup) {
+        return std::make_optional(std::make_tuple(index_info->index_oid_, index_info->name_));
+      }
+    } else if (!match.has_value()) {
+      match = std::make_tuple(index_info->index_oid_, index_info->name_);
     }
   }
-  return std::nullopt;
+  return match;
 }
 
 auto Optimizer::OptimizeNLJAsIndexJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
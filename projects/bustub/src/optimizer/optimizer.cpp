@@ -39,6 +39,12 @@ auto Optimizer::EstimatedCardinality(const std::string &table_name) -> std::opti
   if (StringUtil::EndsWith(table_name, "_100")) {
     return std::make_optional(100);
   }
+  // otherwise count the entries of an index of the table, which has one for every tuple
+  for (auto *index_info : catalog_.GetTableIndexes(table_name)) {
+    if (auto num_entries = index_info->index_->GetNumEntries(); num_entries.has_value()) {
+      return num_entries;
+    }
+  }
   return std::nullopt;
 }
 
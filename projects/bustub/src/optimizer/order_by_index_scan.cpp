@@ -37,11 +37,12 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       return optimized_plan;
     }
 
-    // Order type is asc or default
+    // Order type is asc, default or desc; desc scans the index backwards
     const auto &[order_type, expr] = order_bys[0];
-    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+    if (order_type == OrderByType::INVALID) {
       return optimized_plan;
     }
+    const bool reverse = order_type == OrderByType::DESC;
 
     // Order expression is a column value expression
     const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
@@ -55,17 +56,30 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
     BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
     const auto &child_plan = optimized_plan->children_[0];
 
+    // A range scan of the index on the order by column is already sorted
+    if (child_plan->GetType() == PlanType::IndexScan) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan);
+      const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+      if (index_info->index_type_ != IndexType::HashTableIndex && !index_scan.IsReverse() &&
+          index_info->index_->GetKeyAttrs() == std::vector{order_by_column_id}) {
+        return std::make_shared<IndexScanPlanNode>(
+            index_scan.output_schema_, index_scan.GetIndexOid(), reverse, index_scan.lower_bound_,
+            index_scan.lower_inclusive_, index_scan.upper_bound_, index_scan.upper_inclusive_);
+      }
+    }
+
     if (child_plan->GetType() == PlanType::SeqScan) {
       const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
       const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
 
       for (const auto *index : indices) {
+        // only a tree index returns its keys in order
         const auto &columns = index->key_schema_.GetColumns();
-        if (columns.size() == 1 &&
+        if (index->index_type_ != IndexType::HashTableIndex && columns.size() == 1 &&
             columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
           // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_, reverse);
         }
       }
     }
@@ -0,0 +1,63 @@
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/config.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Set the parallelism of the index scan below a chain of filters and projections, if there is one and it is worth
+ * splitting.
+ */
+auto ParallelizeScan(const AbstractPlanNodeRef &plan,
+                     const std::function<bool(const IndexScanPlanNode &)> &worth_splitting) -> AbstractPlanNodeRef {
+  if (plan->GetType() == PlanType::Filter || plan->GetType() == PlanType::Projection) {
+    auto child = ParallelizeScan(plan->GetChildAt(0), worth_splitting);
+    return child == nullptr ? nullptr : plan->CloneWithChildren({std::move(child)});
+  }
+  if (plan->GetType() != PlanType::IndexScan && plan->GetType() != PlanType::IndexOnlyScan) {
+    return nullptr;
+  }
+  // a reverse scan is there to produce descending order, which the sub-ranges are not split for
+  if (dynamic_cast<const IndexScanPlanNode &>(*plan).IsReverse() ||
+      !worth_splitting(dynamic_cast<const IndexScanPlanNode &>(*plan))) {
+    return nullptr;
+  }
+  auto scan_plan = plan->CloneWithChildren({});
+  dynamic_cast<IndexScanPlanNode &>(*scan_plan).parallelism_ = INDEX_SCAN_PARALLELISM;
+  return scan_plan;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeParallelIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeParallelIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Aggregation) {
+    return optimized_plan;
+  }
+  // a table that does not fill a batch for every worker is read faster by a single scan than by starting workers
+  auto worth_splitting = [this](const IndexScanPlanNode &scan_plan) {
+    constexpr size_t min_cardinality = INDEX_SCAN_PARALLELISM * INDEX_SCAN_BATCH_SIZE;
+    auto cardinality = EstimatedCardinality(catalog_.GetIndex(scan_plan.GetIndexOid())->table_name_);
+    return !cardinality.has_value() || *cardinality >= min_cardinality;
+  };
+  auto child = ParallelizeScan(optimized_plan->GetChildAt(0), worth_splitting);
+  if (child == nullptr) {
+    return optimized_plan;
+  }
+  return optimized_plan->CloneWithChildren({std::move(child)});
+}
+
+}  // namespace bustub
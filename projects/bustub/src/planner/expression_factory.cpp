@@ -5,6 +5,7 @@
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/like_expression.h"
 #include "execution/expressions/logic_expression.h"
 #include "planner/planner.h"
 
@@ -56,6 +57,9 @@ auto Planner::GetBinaryExpressionFromFactory(const std::string &op_name, Abstrac
     return std::make_shared<ComparisonExpression>(std::move(left), std::move(right),
                                                   ComparisonType::GreaterThanOrEqual);
   }
+  if (op_name == "~~" || op_name == "!~~") {
+    return std::make_shared<LikeExpression>(std::move(left), std::move(right), op_name == "!~~");
+  }
   if (op_name == "+") {
     return std::make_shared<ArithmeticExpression>(std::move(left), std::move(right), ArithmeticType::Plus);
   }
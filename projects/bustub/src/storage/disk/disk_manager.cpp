@@ -78,6 +78,7 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  auto start = std::chrono::steady_clock::now();
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
   // set write cursor to offset
@@ -91,12 +92,14 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   }
   // needs to flush to keep disk file in sync
   db_io_.flush();
+  io_stats_.RecordPageIO(page_id, true, std::chrono::steady_clock::now() - start);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  auto start = std::chrono::steady_clock::now();
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   int offset = page_id * BUSTUB_PAGE_SIZE;
   // check if read beyond file length
@@ -120,6 +123,7 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
       memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
     }
   }
+  io_stats_.RecordPageIO(page_id, false, std::chrono::steady_clock::now() - start);
 }
 
 /**
@@ -143,6 +147,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
+  auto start = std::chrono::steady_clock::now();
   // sequence write
   log_io_.write(log_data, size);
 
@@ -154,6 +159,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
   // needs to flush to keep disk file in sync
   log_io_.flush();
   flush_log_ = false;
+  io_stats_.RecordIO({IOObjectType::LOG}, true, size, std::chrono::steady_clock::now() - start);
 }
 
 /**
@@ -167,6 +173,7 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
+  auto start = std::chrono::steady_clock::now();
   log_io_.seekp(offset);
   log_io_.read(log_data, size);
 
@@ -181,6 +188,7 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
     memset(log_data + read_count, 0, size - read_count);
   }
 
+  io_stats_.RecordIO({IOObjectType::LOG}, false, size, std::chrono::steady_clock::now() - start);
   return true;
 }
 
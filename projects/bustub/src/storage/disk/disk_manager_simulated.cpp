@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated.cpp
+//
+// Identification: src/storage/disk/disk_manager_simulated.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_simulated.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+DiskManagerSimulated::DiskManagerSimulated(DiskManager *disk_manager, const SimulatedDiskOptions &options)
+    : disk_manager_(disk_manager),
+      options_(options),
+      channel_free_at_(std::chrono::steady_clock::now()),
+      rng_(options.seed_) {}
+
+/**
+ * Write the contents of the specified page into the underlying disk manager once the simulated write completes
+ */
+void DiskManagerSimulated::WritePage(page_id_t page_id, const char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  SimulateRequest(true);
+  disk_manager_->WritePage(page_id, page_data);
+  io_stats_.RecordPageIO(page_id, true, std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Read the contents of the specified page from the underlying disk manager once the simulated read completes
+ */
+void DiskManagerSimulated::ReadPage(page_id_t page_id, char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  SimulateRequest(false);
+  disk_manager_->ReadPage(page_id, page_data);
+  io_stats_.RecordPageIO(page_id, false, std::chrono::steady_clock::now() - start);
+}
+
+void DiskManagerSimulated::WriteLog(char *log_data, int size) {
+  if (size != 0) {
+    std::scoped_lock lock(latch_);
+    num_flushes_ += 1;
+  }
+  disk_manager_->WriteLog(log_data, size);
+}
+
+auto DiskManagerSimulated::ReadLog(char *log_data, int size, int offset) -> bool {
+  return disk_manager_->ReadLog(log_data, size, offset);
+}
+
+auto DiskManagerSimulated::GetNumReads() const -> uint64_t {
+  std::scoped_lock lock(latch_);
+  return num_reads_;
+}
+
+auto DiskManagerSimulated::GetSimulatedReadTime() const -> uint64_t {
+  std::scoped_lock lock(latch_);
+  return read_time_us_;
+}
+
+auto DiskManagerSimulated::GetSimulatedWriteTime() const -> uint64_t {
+  std::scoped_lock lock(latch_);
+  return write_time_us_;
+}
+
+auto DiskManagerSimulated::SimulateRequest(bool is_write) -> uint64_t {
+  const auto start = std::chrono::steady_clock::now();
+  std::unique_lock lock(latch_);
+
+  // wait for a free slot in the device queue
+  if (options_.queue_depth_ > 0) {
+    slot_cv_.wait(lock, [&] { return in_flight_ < options_.queue_depth_; });
+  }
+  in_flight_++;
+
+  // reserve the transfer channel; transfers are serialized, so a saturated device queues them back to back
+  auto transfer_begin = std::max(std::chrono::steady_clock::now(), channel_free_at_);
+  if (options_.bandwidth_bytes_per_sec_ > 0) {
+    auto transfer_ns = static_cast<uint64_t>(BUSTUB_PAGE_SIZE) * 1000000000ULL / options_.bandwidth_bytes_per_sec_;
+    channel_free_at_ = transfer_begin + std::chrono::nanoseconds(transfer_ns);
+  } else {
+    channel_free_at_ = transfer_begin;
+  }
+  const auto done_at = channel_free_at_ + SampleLatency(is_write ? options_.write_latency_ : options_.read_latency_);
+
+  lock.unlock();
+  std::this_thread::sleep_until(done_at);
+  lock.lock();
+
+  in_flight_--;
+  auto delay = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(done_at - start).count());
+  if (is_write) {
+    num_writes_ += 1;
+    write_time_us_ += delay;
+  } else {
+    num_reads_ += 1;
+    read_time_us_ += delay;
+  }
+
+  lock.unlock();
+  slot_cv_.notify_one();
+  return delay;
+}
+
+auto DiskManagerSimulated::SampleLatency(const LatencyModel &model) -> std::chrono::microseconds {
+  const auto base = static_cast<double>(model.base_.count());
+  const auto jitter = static_cast<double>(model.jitter_.count());
+  double sample = base;
+
+  switch (model.distribution_) {
+    case LatencyDistribution::FIXED:
+      break;
+    case LatencyDistribution::UNIFORM:
+      if (jitter > 0) {
+        sample = std::uniform_real_distribution<double>(base - jitter, base + jitter)(rng_);
+      }
+      break;
+    case LatencyDistribution::EXPONENTIAL:
+      if (jitter > 0) {
+        sample = base + std::exponential_distribution<double>(1.0 / jitter)(rng_);
+      }
+      break;
+  }
+
+  return std::chrono::microseconds(static_cast<int64_t>(std::max(sample, 0.0)));
+}
+
+}  // namespace bustub
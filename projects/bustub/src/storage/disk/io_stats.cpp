@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_stats.cpp
+//
+// Identification: src/storage/disk/io_stats.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bustub {
+
+auto IOObject::TypeName() const -> std::string {
+  switch (type_) {
+    case IOObjectType::OTHER:
+      return "other";
+    case IOObjectType::TABLE:
+      return "table";
+    case IOObjectType::INDEX:
+      return "index";
+    case IOObjectType::LOG:
+      return "log";
+    case IOObjectType::TEMP:
+      return "temp";
+  }
+  return "unknown";
+}
+
+auto IOStats::LatencyPercentile(double percentile) const -> uint64_t {
+  uint64_t total = 0;
+  for (auto count : latency_histogram_) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  auto rank = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(total)));
+  rank = std::clamp<uint64_t>(rank, 1, total);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; i++) {
+    seen += latency_histogram_[i];
+    if (seen >= rank) {
+      return uint64_t{1} << (i + 1);
+    }
+  }
+  return uint64_t{1} << NUM_LATENCY_BUCKETS;
+}
+
+void IOStatsRegistry::RegisterExtent(page_id_t first_page_id, size_t num_pages, IOObject owner) {
+  std::scoped_lock<std::mutex> locker(latch_);
+  extents_[first_page_id] = {first_page_id + static_cast<page_id_t>(num_pages), owner};
+}
+
+auto IOStatsRegistry::OwnerOf(page_id_t page_id) const -> IOObject {
+  std::scoped_lock<std::mutex> locker(latch_);
+  return OwnerOfLocked(page_id);
+}
+
+void IOStatsRegistry::RecordPageIO(page_id_t page_id, bool is_write, std::chrono::nanoseconds latency) {
+  std::scoped_lock<std::mutex> locker(latch_);
+  RecordLocked(OwnerOfLocked(page_id), is_write, BUSTUB_PAGE_SIZE, latency);
+}
+
+void IOStatsRegistry::RecordIO(IOObject owner, bool is_write, size_t bytes, std::chrono::nanoseconds latency) {
+  std::scoped_lock<std::mutex> locker(latch_);
+  RecordLocked(owner, is_write, bytes, latency);
+}
+
+auto IOStatsRegistry::Snapshot() const -> std::vector<std::pair<IOObject, IOStats>> {
+  std::scoped_lock<std::mutex> locker(latch_);
+  return {stats_.begin(), stats_.end()};
+}
+
+auto IOStatsRegistry::OwnerOfLocked(page_id_t page_id) const -> IOObject {
+  // the last extent that starts at or before the page
+  auto it = extents_.upper_bound(page_id);
+  if (it == extents_.begin()) {
+    return {};
+  }
+  --it;
+  if (page_id >= it->second.first) {
+    return {};
+  }
+  return it->second.second;
+}
+
+void IOStatsRegistry::RecordLocked(IOObject owner, bool is_write, size_t bytes, std::chrono::nanoseconds latency) {
+  auto &stats = stats_[owner];
+  if (is_write) {
+    stats.writes_++;
+    stats.bytes_written_ += bytes;
+  } else {
+    stats.reads_++;
+    stats.bytes_read_ += bytes;
+  }
+
+  auto micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  size_t bucket = 0;
+  while (micros > 1 && bucket + 1 < IOStats::NUM_LATENCY_BUCKETS) {
+    micros >>= 1;
+    bucket++;
+  }
+  stats.latency_histogram_[bucket]++;
+}
+
+}  // namespace bustub
@@ -0,0 +1,235 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.cpp
+//
+// Identification: src/storage/index/art_index.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/art_index.h"
+
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "common/config.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+/**
+ * Range scan over an ArtIndex. A forward scan walks one iterator of the tree through the range, a batch at a time; a
+ * reverse scan collects the range up front and returns it back to front.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ArtRangeScan : public IndexRangeScan {
+ public:
+  using Tree = typename ART_INDEX_TYPE::Tree;
+  using Entry = typename ART_INDEX_TYPE::Entry;
+
+  ArtRangeScan(const ART_INDEX_TYPE *index, typename Tree::Iterator iter, std::optional<std::string> lower,
+               std::optional<std::string> upper, bool upper_inclusive, bool reverse)
+      : index_(index),
+        iter_(std::move(iter)),
+        upper_(std::move(upper)),
+        upper_inclusive_(upper_inclusive),
+        reverse_(reverse) {
+    // an exclusive lower bound can only be an entry itself in a unique index, whose keys carry no RID
+    if (lower.has_value() && !iter_.IsEnd() && iter_.Key() == *lower) {
+      ++iter_;
+    }
+    if (reverse_) {
+      for (; InRange(); ++iter_) {
+        reversed_.emplace_back(iter_.Key(), iter_.Value());
+      }
+    }
+  }
+
+  auto NextBatch(std::vector<RID> *result, std::vector<Tuple> *entries) -> bool override {
+    size_t count = 0;
+    if (reverse_) {
+      for (; !reversed_.empty() && count < INDEX_SCAN_BATCH_SIZE; reversed_.pop_back(), count++) {
+        Emit(reversed_.back().first, reversed_.back().second, result, entries);
+      }
+      return count > 0;
+    }
+    for (; InRange() && count < INDEX_SCAN_BATCH_SIZE; ++iter_, count++) {
+      Emit(iter_.Key(), iter_.Value(), result, entries);
+    }
+    return count > 0;
+  }
+
+ private:
+  auto InRange() const -> bool {
+    if (iter_.IsEnd() || !upper_.has_value()) {
+      return !iter_.IsEnd();
+    }
+    return upper_inclusive_ ? iter_.Key() <= *upper_ : iter_.Key() < *upper_;
+  }
+
+  void Emit(std::string_view tree_key, const Entry &entry, std::vector<RID> *result,
+            std::vector<Tuple> *entries) const {
+    result->push_back(entry.rid_);
+    if (entries != nullptr) {
+      entries->push_back(index_->MakeEntryTuple(tree_key, entry));
+    }
+  }
+
+  const ART_INDEX_TYPE *index_;
+  typename Tree::Iterator iter_;
+  // the upper bound as a tree key, compared bytewise like the tree orders its keys
+  std::optional<std::string> upper_;
+  bool upper_inclusive_;
+  bool reverse_;
+  std::vector<std::pair<std::string, Entry>> reversed_;
+};
+
+/*
+ * Constructor
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ART_INDEX_TYPE::ArtIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {
+  size_t suffix_size = GetMetadata()->GetPayloadSize() + (GetMetadata()->IsUnique() ? 0 : KeyType::RID_SIZE);
+  if (sizeof(KeyType) <= suffix_size) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "key type too small for the RID and the included columns");
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto ART_INDEX_TYPE::TreeKeyOf(const KeyType &index_key) const -> std::string {
+  return {index_key.data_, sizeof(KeyType) - GetMetadata()->GetPayloadSize()};
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto ART_INDEX_TYPE::KeyColumnsSize() const -> size_t {
+  return sizeof(KeyType) - GetMetadata()->GetPayloadSize() - (GetMetadata()->IsUnique() ? 0 : KeyType::RID_SIZE);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto ART_INDEX_TYPE::MakeTreeKey(const Tuple &key, RID rid, bool *fits) const -> std::string {
+  KeyType index_key;
+  bool key_fits = index_key.SetFromKey(key, GetKeySchema(), KeyColumnsSize());
+  if (fits != nullptr) {
+    *fits = key_fits;
+  }
+  // entries of a non-unique index are told apart, and ordered, by their RID
+  if (!GetMetadata()->IsUnique()) {
+    index_key.SetRid(rid, GetMetadata()->GetPayloadSize());
+  }
+  return TreeKeyOf(index_key);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto ART_INDEX_TYPE::MakeEntryTuple(std::string_view tree_key, const Entry &entry) const -> Tuple {
+  const auto *metadata = GetMetadata();
+  KeyType index_key;
+  memcpy(index_key.data_, tree_key.data(), tree_key.size());
+  memcpy(index_key.data_ + tree_key.size(), entry.payload_.data(), entry.payload_.size());
+  std::vector<Value> values;
+  for (uint32_t i = 0; i < metadata->GetIndexColumnCount(); i++) {
+    values.push_back(index_key.ToValue(metadata->GetKeySchema(), i));
+  }
+  for (uint32_t i = 0; i < metadata->GetIncludeAttrs().size(); i++) {
+    values.push_back(index_key.PayloadToValue(metadata->GetIncludeSchema(), i, metadata->GetPayloadSize()));
+  }
+  return {values, metadata->GetEntrySchema()};
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ART_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  const auto *metadata = GetMetadata();
+  // the key is sized for the declared length of varchar columns, which values are not held to
+  bool fits;
+  std::string tree_key = MakeTreeKey(key, rid, &fits);
+  Entry entry{rid, {}};
+  if (!metadata->GetIncludeAttrs().empty()) {
+    // the included columns follow the key columns in the entry tuple
+    std::vector<Value> values;
+    auto num_key_columns = metadata->GetIndexColumnCount();
+    for (uint32_t i = 0; i < metadata->GetIncludeAttrs().size(); i++) {
+      values.push_back(key.GetValue(metadata->GetEntrySchema(), num_key_columns + i));
+    }
+    KeyType index_key;
+    fits = index_key.SetPayload(values, metadata->GetPayloadSize()) && fits;
+    entry.payload_.assign(index_key.data_ + sizeof(KeyType) - metadata->GetPayloadSize(), metadata->GetPayloadSize());
+  }
+  if (!fits) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "value longer than the declared length of its indexed column");
+  }
+  // the tree never overwrites a value, so a unique key that is already present keeps its entry
+  tree_.Insert(tree_key, std::move(entry));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ART_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  tree_.Remove(MakeTreeKey(key, rid));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ART_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (GetMetadata()->IsUnique()) {
+    Entry entry;
+    if (tree_.Get(MakeTreeKey(key, RID()), &entry)) {
+      result->push_back(entry.rid_);
+    }
+    return;
+  }
+
+  // the entries of a key are the tree keys that start with its key columns
+  std::string tree_key = MakeTreeKey(key, RID());
+  for (auto iter = tree_.ScanPrefix(std::string_view(tree_key).substr(0, KeyColumnsSize())); !iter.IsEnd(); ++iter) {
+    result->push_back(iter.Value().rid_);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto ART_INDEX_TYPE::ScanRange(const IndexRange &range, Transaction *transaction) -> std::unique_ptr<IndexRangeScan> {
+  // like the bound keys of a B+ tree index, the all-zero RID sorts before every entry of a key and the all-ones RID
+  // after every entry
+  auto bound_key = [this](const Tuple &key, bool is_lower, bool inclusive) {
+    if (is_lower == inclusive) {
+      return MakeTreeKey(key, RID(0, 0));
+    }
+    return MakeTreeKey(key, RID(INVALID_PAGE_ID, std::numeric_limits<uint32_t>::max()));
+  };
+  std::optional<std::string> lower;
+  std::optional<std::string> exclusive_lower;
+  std::optional<std::string> upper;
+  if (range.lower_.has_value()) {
+    lower = bound_key(*range.lower_, true, range.lower_inclusive_);
+    if (!range.lower_inclusive_) {
+      exclusive_lower = lower;
+    }
+  }
+  if (range.upper_.has_value()) {
+    upper = bound_key(*range.upper_, false, range.upper_inclusive_);
+  }
+  auto iter = lower.has_value() ? tree_.LowerBound(*lower) : tree_.ScanPrefix("");
+  using RangeScan = ArtRangeScan<KeyType, ValueType, KeyComparator>;
+  return std::make_unique<RangeScan>(this, std::move(iter), std::move(exclusive_lower), std::move(upper),
+                                     range.upper_inclusive_, range.reverse_);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto ART_INDEX_TYPE::GetStats() -> std::optional<IndexStats> {
+  IndexStats stats;
+  stats.num_entries_ = tree_.Size();
+  return stats;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto ART_INDEX_TYPE::GetNumEntries() -> std::optional<size_t> { return tree_.Size(); }
+
+template class ArtIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class ArtIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class ArtIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class ArtIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class ArtIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class ArtIndex<GenericKey<128>, RID, GenericComparator<128>>;
+template class ArtIndex<GenericKey<256>, RID, GenericComparator<256>>;
+
+}  // namespace bustub
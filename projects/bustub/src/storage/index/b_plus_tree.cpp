@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <optional>
 #include <string>
 
 #include "common/exception.h"
@@ -9,10 +11,11 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, IOObject io_owner)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
+      extent_allocator_(buffer_pool_manager, EXTENT_SIZE, io_owner),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {}
@@ -32,53 +35,407 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_P
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  std::shared_lock<std::shared_mutex> locker(shared_mutex_);
+  Page *page = FindLeafPageRead(key);
 
   /* B+树为空 */
-  if (root_page_id_ == INVALID_PAGE_ID) {
+  if (page == nullptr) {
     return false;
   }
 
-  LeafPage *target_leaf_page = FindLeafPage(key);
+  auto target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = target_leaf_page->GetIndexByKey(key, comparator_);
+  bool found = index < target_leaf_page->GetSize() && comparator_(key, target_leaf_page->KeyAt(index)) == 0;
+  if (found) {
+    /* 查找成功 */
+    result->emplace_back(target_leaf_page->ValueAt(index));
+  }
+
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*
+ * 批量查找一组升序的key：从上一个key所在的叶子页面向右，或从路径上仍覆盖该key的最深的内部页面向下查找，
+ * 避免每个key都从根页面开始下降
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &sorted_keys, std::vector<std::vector<ValueType>> *results,
+                               const std::function<bool(const KeyType &, const KeyType &)> &matches,
+                               Transaction *transaction) {
+  results->assign(sorted_keys.size(), {});
+  /* 持有smo_latch_读锁，路径上的页面不会被合并删除，只可能向右分裂 */
+  smo_latch_.RLock();
+  std::vector<page_id_t> path;
+  Page *leaf_page = nullptr;
+  for (size_t i = 0; i < sorted_keys.size(); i++) {
+    const KeyType &key = sorted_keys[i];
+    /* 重复的key结果相同 */
+    if (i > 0 && comparator_(key, sorted_keys[i - 1]) == 0) {
+      (*results)[i] = (*results)[i - 1];
+      continue;
+    }
+    leaf_page = FindLeafPageForBatch(leaf_page, key, &path);
+    /* B+树为空 */
+    if (leaf_page == nullptr) {
+      break;
+    }
+
+    auto leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    int index = leaf->GetIndexByKey(key, comparator_);
+    while (true) {
+      for (; index < leaf->GetSize(); index++) {
+        const KeyType &entry_key = leaf->KeyAt(index);
+        if (matches ? !matches(key, entry_key) : comparator_(key, entry_key) != 0) {
+          break;
+        }
+        (*results)[i].push_back(leaf->ValueAt(index));
+      }
+      /* 匹配的数据可能延续到右侧的叶子页面 */
+      if (index < leaf->GetSize() || leaf->GetNextPageId() == INVALID_PAGE_ID) {
+        break;
+      }
+      Page *next_page = buffer_pool_manager_->FetchPage(leaf->GetNextPageId());
+      next_page->RLatch();
+      leaf_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+      leaf_page = next_page;
+      leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+      index = 0;
+    }
+  }
+
+  if (leaf_page != nullptr) {
+    leaf_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+  }
+  smo_latch_.RUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageForBatch(Page *leaf_page, const KeyType &key, std::vector<page_id_t> *path)
+    -> Page * {
+  if (leaf_page != nullptr) {
+    /* key升序，当前叶子页面的下界不大于key，只需检查上界 */
+    auto leaf = reinterpret_cast<BPlusTreePage *>(leaf_page->GetData());
+    if (!NeedMoveRight(leaf, key, SearchMode::KEY)) {
+      return leaf_page;
+    }
+    /* 先尝试右侧相邻的叶子页面 */
+    Page *next_page = buffer_pool_manager_->FetchPage(leaf->GetNextPageId());
+    next_page->RLatch();
+    leaf_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    if (!NeedMoveRight(reinterpret_cast<BPlusTreePage *>(next_page->GetData()), key, SearchMode::KEY)) {
+      return next_page;
+    }
+    next_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(next_page->GetPageId(), false);
+
+    /* 已经释放叶子页面，自下而上找到仍覆盖key的内部页面，不会与自上而下的加锁顺序冲突 */
+    while (!path->empty()) {
+      Page *page = buffer_pool_manager_->FetchPage(path->back());
+      path->pop_back();
+      page->RLatch();
+      if (!NeedMoveRight(reinterpret_cast<BPlusTreePage *>(page->GetData()), key, SearchMode::KEY)) {
+        return DescendForBatch(page, key, path);
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+  }
+
+  /* 从根页面开始，根页面可能已经改变 */
+  path->clear();
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  page->RLatch();
+  root_latch_.RUnlock();
+  return DescendForBatch(page, key, path);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendForBatch(Page *page, const KeyType &key, std::vector<page_id_t> *path) -> Page * {
+  while (true) {
+    page = MoveRight(page, key, SearchMode::KEY, false);
+    auto cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (cur_page->IsLeafPage()) {
+      return page;
+    }
+    path->push_back(page->GetPageId());
+    auto internal_page = static_cast<InternalPage *>(cur_page);
+    int child_index = internal_page->GetIndexByKey(key, comparator_);
+    Page *child_page = buffer_pool_manager_->FetchPage(internal_page->ValueAt(child_index));
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, SearchMode mode, std::optional<KeyType> *lower_bound,
+                                      std::vector<std::pair<KeyType, page_id_t>> *right_siblings) -> Page * {
+  root_latch_.RLock();
 
-  for (int i = 0; i < target_leaf_page->GetSize(); i++) {
-    if (comparator_(key, target_leaf_page->KeyAt(i)) == 0) {
-      /* 查找成功 */
-      result->emplace_back(target_leaf_page->ValueAt(i));
-      buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), false);
+  /* B+树为空 */
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  page->RLatch();
+  root_latch_.RUnlock();
+
+  while (true) {
+    /* 读取父页面之后该页面可能已经分裂，沿右链接找到真正覆盖key的页面 */
+    page_id_t page_id = page->GetPageId();
+    page = MoveRight(page, key, mode, false, lower_bound);
+    auto cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (cur_page->IsLeafPage()) {
+      /* 父页面中记录的右侧兄弟已经过时 */
+      if (right_siblings != nullptr && page->GetPageId() != page_id) {
+        right_siblings->clear();
+      }
+      break;
+    }
+    auto internal_page = static_cast<InternalPage *>(cur_page);
+
+    int child_index;
+    switch (mode) {
+      case SearchMode::LEFTMOST:
+        child_index = 0;
+        break;
+      case SearchMode::RIGHTMOST:
+        child_index = internal_page->GetSize() - 1;
+        break;
+      case SearchMode::BEFORE_KEY:
+        child_index = internal_page->GetIndexBeforeKey(key, comparator_);
+        break;
+      default:
+        child_index = internal_page->GetIndexByKey(key, comparator_);
+    }
+    /* 越深的分隔key越紧，孩子子树中所有key都不小于它 */
+    if (lower_bound != nullptr && child_index > 0) {
+      *lower_bound = internal_page->KeyAt(child_index);
+    }
+    /* 只保留叶子页面的父页面中的右侧兄弟 */
+    if (right_siblings != nullptr) {
+      right_siblings->clear();
+      for (int i = child_index + 1; i < internal_page->GetSize(); i++) {
+        right_siblings->emplace_back(internal_page->KeyAt(i), internal_page->ValueAt(i));
+      }
+    }
+
+    /* 先对孩子页面加读锁，再释放当前页面 */
+    Page *child_page = buffer_pool_manager_->FetchPage(internal_page->ValueAt(child_index));
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+  }
+
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::HighKeyOf(const BPlusTreePage *page) const -> const KeyType & {
+  if (page->IsLeafPage()) {
+    return static_cast<const LeafPage *>(page)->GetHighKey();
+  }
+  return static_cast<const InternalPage *>(page)->GetHighKey();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NeedMoveRight(const BPlusTreePage *page, const KeyType &key, SearchMode mode) const -> bool {
+  /* 每层最右侧的页面没有上界 */
+  if (page->GetNextPageId() == INVALID_PAGE_ID) {
+    return false;
+  }
+
+  switch (mode) {
+    case SearchMode::LEFTMOST:
+      return false;
+    case SearchMode::RIGHTMOST:
       return true;
+    case SearchMode::BEFORE_KEY:
+      /* 右侧页面中可能有不小于上界、但小于key的数据 */
+      return comparator_(HighKeyOf(page), key) < 0;
+    default:
+      return comparator_(key, HighKeyOf(page)) >= 0;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MoveRight(Page *page, const KeyType &key, SearchMode mode, bool exclusive,
+                               std::optional<KeyType> *lower_bound) -> Page * {
+  auto cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (NeedMoveRight(cur_page, key, mode)) {
+    /* 与迭代器相同，先对右侧页面加锁再释放当前页面，保持从左到右的加锁顺序 */
+    Page *next_page = buffer_pool_manager_->FetchPage(cur_page->GetNextPageId());
+    if (exclusive) {
+      next_page->WLatch();
+    } else {
+      next_page->RLatch();
     }
+    if (lower_bound != nullptr) {
+      *lower_bound = HighKeyOf(cur_page);
+    }
+    if (exclusive) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+    page = next_page;
+    cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
   }
+  return page;
+}
 
-  /* 查找失败 */
-  buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), false);
-  return false;
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindPrevLeafPage(KeyType key, int *index) -> Page * {
+  while (true) {
+    std::optional<KeyType> lower_bound;
+    Page *page = FindLeafPageRead(key, SearchMode::BEFORE_KEY, &lower_bound);
+    if (page == nullptr) {
+      return nullptr;
+    }
+
+    auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    *index = leaf_page->GetIndexByKey(key, comparator_) - 1;
+    if (*index >= 0) {
+      return page;
+    }
+
+    /* 分隔key可能已经过时，该叶子页面中没有小于key的数据，继续查找更小的下界之前的页面 */
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!lower_bound.has_value()) {
+      return nullptr;
+    }
+    key = *lower_bound;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, std::vector<page_id_t> *path) -> Page * {
+  root_latch_.RLock();
+
+  /* B+树为空 */
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  auto cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  bool is_leaf = cur_page->IsLeafPage();
+  if (is_leaf) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
+
+  while (true) {
+    /* 同一层的页面类型相同，向右移动不改变加锁方式 */
+    page = MoveRight(page, key, SearchMode::KEY, is_leaf);
+    if (is_leaf) {
+      return page;
+    }
+    if (path != nullptr) {
+      path->push_back(page->GetPageId());
+    }
+    auto internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+
+    /* 父页面的读锁保证孩子页面不会被删除，因此可以在加锁前读取孩子页面的类型 */
+    int child_index = internal_page->GetIndexByKey(key, comparator_);
+    Page *child_page = buffer_pool_manager_->FetchPage(internal_page->ValueAt(child_index));
+    is_leaf = reinterpret_cast<BPlusTreePage *>(child_page->GetData())->IsLeafPage();
+    if (is_leaf) {
+      child_page->WLatch();
+    } else {
+      child_page->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key) -> LeafPage * {
+auto BPLUSTREE_TYPE::FindLeafPagePessimistic(const KeyType &key, Transaction *transaction) -> Page * {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);  // nullptr代表root_latch_
+
   /* B+树为空 */
   if (root_page_id_ == INVALID_PAGE_ID) {
     return nullptr;
   }
 
-  auto cur_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
+  /* 调用者持有smo_latch_写锁，不存在进行到一半的分裂，父页面中的分隔key是准确的，无需向右移动 */
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  page->WLatch();
+  while (true) {
+    auto cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+
+    /* 当前页面安全时，祖先页面（以及root_latch_）都不会再被修改，可以提前释放 */
+    if (IsSafe(cur_page, Operation::REMOVE)) {
+      ReleaseWLatches(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+
+    if (cur_page->IsLeafPage()) {
+      return page;
+    }
 
-  while (!cur_page->IsLeafPage()) {
     auto internal_page = static_cast<InternalPage *>(cur_page);
+    page = buffer_pool_manager_->FetchPage(internal_page->ValueAt(internal_page->GetIndexByKey(key, comparator_)));
+    page->WLatch();
+  }
+}
 
-    /* 查找下一层待处理的页面 */
-    int index = 1;
-    while (index < cur_page->GetSize() && comparator_(key, internal_page->KeyAt(index)) >= 0) {
-      index++;
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseWLatches(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+      continue;
     }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  page_set->clear();
+
+  /* 页面解锁并unpin之后才能删除 */
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
 
-    cur_page = reinterpret_cast<BPlusTreePage *>(
-        buffer_pool_manager_->FetchPage(internal_page->ValueAt(index - 1))->GetData());
-    buffer_pool_manager_->UnpinPage(internal_page->GetPageId(), false);
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafe(BPlusTreePage *page, Operation operation) const -> bool {
+  if (operation == Operation::INSERT) {
+    /* 叶子页面插入后达到max_size即分裂，内部页面在已满时插入才分裂 */
+    return page->IsLeafPage() ? page->GetSize() + 1 < page->GetMaxSize() : page->GetSize() < page->GetMaxSize();
   }
 
-  return static_cast<LeafPage *>(cur_page);
+  /* 根页面没有最小值限制，但根叶子页面不能被删空，根内部页面不能只剩一个孩子 */
+  if (page->GetPageId() == root_page_id_) {
+    return page->IsLeafPage() ? page->GetSize() > 1 : page->GetSize() > 2;
+  }
+  return page->IsLeafPage() ? static_cast<LeafPage *>(page)->CanSpareEntry()
+                            : static_cast<InternalPage *>(page)->CanSpareEntry();
 }
 
 /*****************************************************************************
@@ -93,134 +450,340 @@ auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key) -> LeafPage * {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  std::unique_lock<std::shared_mutex> locker(shared_mutex_);
-
-  /* B+树为空 */
-  if (root_page_id_ == INVALID_PAGE_ID) {
-    auto new_root_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(&root_page_id_)->GetData());
+  /* 乐观插入：内部页面只加读锁，叶子页面不会分裂时直接插入 */
+  Page *page = FindLeafPageOptimistic(key);
+  if (page != nullptr) {
+    auto target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    if (IsSafe(target_leaf_page, Operation::INSERT) && target_leaf_page->HasRoomFor(key)) {
+      bool inserted = target_leaf_page->InsertByKey(key, value, comparator_);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+      if (inserted) {
+        num_entries_++;
+      }
+      return inserted;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
 
-    /* 初始化新的根页面 */
-    new_root_page->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
-    new_root_page->InsertByKey(key, value, comparator_);
-    new_root_page->SetNextPageId(INVALID_PAGE_ID);
+  /* 可能分裂：记录下降路径，分裂之后沿路径自底向上插入分隔key，期间不持有祖先页面的锁 */
+  smo_latch_.RLock();
+  std::vector<page_id_t> path;
+  while ((page = FindLeafPageOptimistic(key, &path)) == nullptr) {
+    /* B+树为空 */
+    root_latch_.WLock();
+    if (root_page_id_ == INVALID_PAGE_ID) {
+      auto new_root_page = reinterpret_cast<LeafPage *>(extent_allocator_.NewPage(&root_page_id_)->GetData());
+      new_root_page->Init(root_page_id_, leaf_max_size_);
+      new_root_page->InsertByKey(key, value, comparator_);
+      UpdateRootPageId(true);
+      num_entries_++;
+
+      buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+      root_latch_.WUnlock();
+      smo_latch_.RUnlock();
+      return true;
+    }
+    /* 其他线程抢先建立了根页面，重新查找 */
+    root_latch_.WUnlock();
+  }
 
-    UpdateRootPageId(true);
+  auto target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
 
-    buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+  /* 变长key的页面剩余字节放不下key：先分裂，再把key插入它所属的一半 */
+  if (!target_leaf_page->HasRoomFor(key)) {
+    int index = target_leaf_page->GetIndexByKey(key, comparator_);
+    if (index < target_leaf_page->GetSize() && comparator_(target_leaf_page->KeyAt(index), key) == 0) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      smo_latch_.RUnlock();
+      return false;
+    }
+    MappingType pending{key, value};
+    HandleLeafOverflow(page, &path, &pending);
+    num_entries_++;
+    smo_latch_.RUnlock();
     return true;
   }
 
-  LeafPage *target_leaf_page = FindLeafPage(key);
-
   /* key重复 */
   if (!target_leaf_page->InsertByKey(key, value, comparator_)) {
-    buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), false);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    smo_latch_.RUnlock();
     return false;
   }
+  num_entries_++;
 
   /* 叶子页面上溢 */
   if (target_leaf_page->GetSize() == target_leaf_page->GetMaxSize()) {
-    HandleLeafOverflow(target_leaf_page);
+    HandleLeafOverflow(page, &path);
+  } else {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
   }
 
-  buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), true);
+  smo_latch_.RUnlock();
   return true;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::HandleLeafOverflow(LeafPage *target_page) {
-  if (target_page->IsRootPage()) {
-    page_id_t split_page_id;
-    auto split_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(&split_page_id)->GetData());
-    auto new_root_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(&root_page_id_)->GetData());
-
-    /* 初始化分裂页面 */
-    split_page->Init(split_page_id, root_page_id_, leaf_max_size_);
-    target_page->MoveHalfDataTo(split_page);
-
-    /* 初始化新的根页面 */
-    new_root_page->Init(root_page_id_, INVALID_PAGE_ID, internal_max_size_);
-    new_root_page->SetKeyAt(0, split_page->KeyAt(0));  // 无任何实际意义的填充值
-    new_root_page->SetValueAt(0, target_page->GetPageId());
-    new_root_page->SetKeyAt(1, split_page->KeyAt(0));
-    new_root_page->SetValueAt(1, split_page->GetPageId());
-    new_root_page->IncreaseSize(1);
-    target_page->SetParentPageId(root_page_id_);  // 将新根页面设置为旧根页面的父页面
-
-    UpdateRootPageId(false);
-
-    buffer_pool_manager_->UnpinPage(split_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
-    return;
-  }
-
+void BPLUSTREE_TYPE::HandleLeafOverflow(Page *page, std::vector<page_id_t> *path, const MappingType *pending) {
+  auto target_page = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_t target_page_id = page->GetPageId();
   page_id_t split_page_id;
-  auto split_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(&split_page_id)->GetData());
-  auto parent_page =
-      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(target_page->GetParentPageId())->GetData());
+  auto split_page = reinterpret_cast<LeafPage *>(extent_allocator_.NewPage(&split_page_id)->GetData());
 
-  /* 初始化分裂页面 */
-  split_page->Init(split_page_id, parent_page->GetPageId(), leaf_max_size_);
+  /* 分裂页面在当前页面解锁之前不可见，无需加锁；右链接建立后，读操作无需父页面即可找到它 */
+  split_page->Init(split_page_id, leaf_max_size_);
   target_page->MoveHalfDataTo(split_page);
+  LinkPrevPage(split_page->GetNextPageId(), split_page_id);
+  num_leaf_splits_++;
+  KeyType separator = target_page->GetHighKey();
+  if (pending != nullptr) {
+    LeafPage *half = comparator_(pending->first, separator) < 0 ? target_page : split_page;
+    half->InsertByKey(pending->first, pending->second, comparator_);
+  }
 
-  /* 判断父页面是否上溢 */
-  if (parent_page->GetSize() == parent_page->GetMaxSize()) {
-    HandleInternalOverflow(parent_page, split_page->KeyAt(0), split_page->GetPageId());
-  } else {
-    parent_page->InsertByKey(split_page->KeyAt(0), split_page->GetPageId(), comparator_, buffer_pool_manager_);
+  buffer_pool_manager_->UnpinPage(split_page_id, true);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(target_page_id, true);
+
+  InsertIntoParent(target_page_id, separator, split_page_id, path);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LinkPrevPage(page_id_t page_id, page_id_t prev_page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
   }
 
-  buffer_pool_manager_->UnpinPage(split_page->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  /* 右侧页面在已加锁的页面之后，保持从左到右的加锁顺序 */
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  page->WLatch();
+  reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(prev_page_id);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::HandleInternalOverflow(InternalPage *target_page, const KeyType &key, const page_id_t &value) {
-  if (target_page->IsRootPage()) {
+void BPLUSTREE_TYPE::InsertIntoParent(page_id_t left_page_id, KeyType key, page_id_t right_page_id,
+                                      std::vector<page_id_t> *path) {
+  int level = 1;  // 父页面所在的层，叶子页面为第0层
+  while (true) {
+    if (path->empty()) {
+      root_latch_.WLock();
+      if (root_page_id_ == left_page_id) {
+        /* 分裂的是根页面，建立新的根页面 */
+        auto new_root_page = reinterpret_cast<InternalPage *>(extent_allocator_.NewPage(&root_page_id_)->GetData());
+        new_root_page->Init(root_page_id_, internal_max_size_);
+        new_root_page->InsertByIndex(0, key, left_page_id);  // 首个key无任何实际意义，只是填充值
+        new_root_page->InsertByIndex(1, key, right_page_id);
+        UpdateRootPageId(false);
+
+        buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+        root_latch_.WUnlock();
+        return;
+      }
+      root_latch_.WUnlock();
+
+      /*
+       * 其他线程在下降之后分裂了根页面，树长高了。smo_latch_的读锁保证页面不会被删除，
+       * 重新下降并只保留第level层及以上的路径
+       */
+      Page *leaf = FindLeafPageOptimistic(key, path);
+      leaf->WUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+      path->resize(path->size() - (level - 1));
+      continue;
+    }
+
+    /* 记录的父页面可能已经分裂，分隔key应插入右侧覆盖它的页面 */
+    Page *page = buffer_pool_manager_->FetchPage(path->back());
+    path->pop_back();
+    page->WLatch();
+    page = MoveRight(page, key, SearchMode::KEY, true);
+    auto parent_page = reinterpret_cast<InternalPage *>(page->GetData());
+
+    if (parent_page->GetSize() < parent_page->GetMaxSize() && parent_page->HasRoomFor(key)) {
+      parent_page->InsertByKey(key, right_page_id, comparator_);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return;
+    }
+
+    /* 父页面上溢，分裂后继续向上插入 */
     page_id_t split_page_id;
-    auto split_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(&split_page_id)->GetData());
-    auto new_root_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(&root_page_id_)->GetData());
-
-    /* 初始化分裂页面 */
-    split_page->Init(split_page_id, root_page_id_, internal_max_size_);
-    target_page->MoveHalfDataAndInsertTo(split_page, key, value, comparator_,
-                                         buffer_pool_manager_);  // split_page首个key暂时有效
-
-    /* 初始化新的根页面 */
-    new_root_page->Init(root_page_id_, INVALID_PAGE_ID, internal_max_size_);
-    new_root_page->SetKeyAt(0, split_page->KeyAt(0));  // 无任何实际意义的填充值
-    new_root_page->SetValueAt(0, target_page->GetPageId());
-    new_root_page->SetKeyAt(1, split_page->KeyAt(0));
-    new_root_page->SetValueAt(1, split_page->GetPageId());
-    new_root_page->IncreaseSize(1);
-    target_page->SetParentPageId(root_page_id_);  // 将新根页面设置为旧根页面的父页面
-
-    UpdateRootPageId(false);
-
-    buffer_pool_manager_->UnpinPage(split_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
-    return;
+    auto split_page = reinterpret_cast<InternalPage *>(extent_allocator_.NewPage(&split_page_id)->GetData());
+    split_page->Init(split_page_id, internal_max_size_);
+    parent_page->MoveHalfDataAndInsertTo(split_page, key, right_page_id, comparator_);  // split_page首个key暂时有效
+    num_internal_splits_++;
+
+    left_page_id = parent_page->GetPageId();
+    key = split_page->KeyAt(0);
+    right_page_id = split_page_id;
+    buffer_pool_manager_->UnpinPage(split_page_id, true);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    level++;
   }
+}
 
-  page_id_t split_page_id;
-  auto split_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(&split_page_id)->GetData());
-  auto parent_page =
-      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(target_page->GetParentPageId())->GetData());
-
-  /* 初始化分裂页面 */
-  split_page->Init(split_page_id, target_page->GetParentPageId(), internal_max_size_);
-  target_page->MoveHalfDataAndInsertTo(split_page, key, value, comparator_,
-                                       buffer_pool_manager_);  // split_page首个key暂时有效
-
-  /* 判断父页面是否上溢 */
-  if (parent_page->GetSize() == parent_page->GetMaxSize()) {
-    HandleInternalOverflow(parent_page, split_page->KeyAt(0), split_page->GetPageId());
-  } else {
-    parent_page->InsertByKey(split_page->KeyAt(0), split_page->GetPageId(), comparator_, buffer_pool_manager_);
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build an empty b+ tree bottom-up from entries sorted by key: leaves are
+ * written left to right, and every finished page becomes a child of the level
+ * above it. Each level holds back at least min_size pages (entries for the
+ * leaves) so that its last page never underflows.
+ * @return: false if the tree is not empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor) -> bool {
+  root_latch_.WLock();
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    root_latch_.WUnlock();
+    return false;
+  }
+
+  /* 按填充因子计算每个页面写入的条目数，叶子页面最多保存max_size - 1个条目 */
+  int leaf_min_size = std::max(leaf_max_size_ / 2, 1);
+  int leaf_capacity =
+      std::clamp(static_cast<int>(fill_factor * (leaf_max_size_ - 1)), leaf_min_size, leaf_max_size_ - 1);
+  int internal_min_size = std::max((internal_max_size_ + 1) / 2, 2);
+  int internal_capacity =
+      std::clamp(static_cast<int>(fill_factor * internal_max_size_), internal_min_size, internal_max_size_);
+
+  BulkLoadState state;
+  state.internal_capacity_ = internal_capacity;
+  state.fill_factor_ = fill_factor;
+  std::vector<MappingType> pending;
+  MappingType entry;
+  while (next(&entry)) {
+    /* 与Insert一样，重复的key只保留第一个 */
+    if (!pending.empty() && comparator_(pending.back().first, entry.first) == 0) {
+      continue;
+    }
+    pending.push_back(entry);
+    /* 留下min_size个条目，保证最后一个叶子页面不会下溢 */
+    if (static_cast<int>(pending.size()) == leaf_capacity + leaf_min_size) {
+      int written = BulkLoadLeaf(pending.data(), leaf_capacity, &state);
+      pending.erase(pending.begin(), pending.begin() + written);
+    }
+  }
+
+  /* 剩余条目放不进一个页面时平分到两个页面，变长key的页面字节数不够时继续写出新页面 */
+  while (!pending.empty()) {
+    int remaining = static_cast<int>(pending.size());
+    int count = remaining > leaf_max_size_ - 1 ? remaining - remaining / 2 : remaining;
+    int written = BulkLoadLeaf(pending.data(), count, &state);
+    pending.erase(pending.begin(), pending.begin() + written);
+  }
+  if (state.prev_leaf_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(state.prev_leaf_->GetPageId(), true);
+  }
+
+  /* 自底向上写出每一层剩余的页面，直到某一层只剩一个没有父页面的页面，它就是根页面 */
+  for (size_t level = 0; level < state.children_.size(); level++) {
+    if (state.children_[level].size() == 1 && state.num_parents_[level] == 0) {
+      root_page_id_ = state.children_[level][0].second;
+      UpdateRootPageId(true);
+      break;
+    }
+    /* 写出内部页面会向上一层添加子页面，children_可能扩容，每次重新取这一层 */
+    while (!state.children_[level].empty()) {
+      int remaining = static_cast<int>(state.children_[level].size());
+      BulkLoadInternal(level, remaining > internal_max_size_ ? remaining - remaining / 2 : remaining, &state);
+    }
+  }
+
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadLeaf(const MappingType *entries, int count, BulkLoadState *state) -> int {
+  page_id_t page_id;
+  Page *page = extent_allocator_.NewPage(&page_id);
+  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf_page->Init(page_id, leaf_max_size_);
+  /* 变长key的页面写到填充因子对应的字节数为止，至少写入一个条目 */
+  int written = 0;
+  while (written < count &&
+         (written == 0 || leaf_page->HasRoomFor(entries[written].first, state->fill_factor_))) {
+    leaf_page->InsertByKey(entries[written].first, entries[written].second, comparator_);
+    written++;
+  }
+  num_entries_ += written;
+
+  /* 链接到上一个叶子页面，两个页面之间的分隔key是上一个叶子页面的上界，变长key时截断为最短前缀 */
+  KeyType separator = entries[0].first;
+  if (state->prev_leaf_ != nullptr) {
+    auto prev_leaf_page = reinterpret_cast<LeafPage *>(state->prev_leaf_->GetData());
+    separator = BPlusTreeKeyArray<KeyType, ValueType>::Separator(prev_leaf_page->KeyAt(prev_leaf_page->GetSize() - 1),
+                                                                 entries[0].first);
+    prev_leaf_page->SetNextPageId(page_id);
+    prev_leaf_page->SetHighKey(separator);
+    leaf_page->SetPrevPageId(state->prev_leaf_->GetPageId());
+    buffer_pool_manager_->UnpinPage(state->prev_leaf_->GetPageId(), true);
   }
+  state->prev_leaf_ = page;
 
-  buffer_pool_manager_->UnpinPage(split_page->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  BulkLoadAddChild(0, separator, page_id, state);
+  return written;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadInternal(size_t level, int count, BulkLoadState *state) {
+  page_id_t page_id;
+  Page *page = extent_allocator_.NewPage(&page_id);
+  auto internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+  internal_page->Init(page_id, internal_max_size_);
+
+  auto &children = state->children_[level];
+  int written = 0;
+  while (written < count &&
+         (written == 0 || internal_page->HasRoomFor(children[written].first, state->fill_factor_))) {
+    internal_page->InsertByIndex(written, children[written].first, children[written].second);  // 下标0的key无实际意义
+    written++;
+  }
+
+  /* 链接到同一层的上一个内部页面 */
+  KeyType first_key = children[0].first;
+  if (state->prev_internal_.size() == level) {
+    state->prev_internal_.push_back(INVALID_PAGE_ID);
+  }
+  if (state->prev_internal_[level] != INVALID_PAGE_ID) {
+    auto prev_page =
+        reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(state->prev_internal_[level])->GetData());
+    prev_page->SetNextPageId(page_id);
+    prev_page->SetHighKey(first_key);
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+  }
+  state->prev_internal_[level] = page_id;
+
+  children.erase(children.begin(), children.begin() + written);
+  state->num_parents_[level]++;
+  buffer_pool_manager_->UnpinPage(page_id, true);
+
+  BulkLoadAddChild(level + 1, first_key, page_id, state);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAddChild(size_t level, const KeyType &key, page_id_t page_id, BulkLoadState *state) {
+  if (state->children_.size() == level) {
+    state->children_.emplace_back();
+    state->num_parents_.push_back(0);
+  }
+  state->children_[level].emplace_back(key, page_id);
+
+  /* 同样留下min_size个子页面给这一层的最后一个父页面 */
+  int internal_min_size = std::max((internal_max_size_ + 1) / 2, 2);
+  if (static_cast<int>(state->children_[level].size()) == state->internal_capacity_ + internal_min_size) {
+    BulkLoadInternal(level, state->internal_capacity_, state);
+  }
 }
 
 /*****************************************************************************
@@ -235,50 +798,89 @@ void BPLUSTREE_TYPE::HandleInternalOverflow(InternalPage *target_page, const Key
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  std::unique_lock<std::shared_mutex> locker(shared_mutex_);
+  /* 乐观删除：内部页面只加读锁，叶子页面不会下溢时直接删除 */
+  Page *page = FindLeafPageOptimistic(key);
 
   /* B+树为空 */
-  if (root_page_id_ == INVALID_PAGE_ID) {
+  if (page == nullptr) {
+    return;
+  }
+
+  auto target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  if (IsSafe(target_leaf_page, Operation::REMOVE)) {
+    bool removed = target_leaf_page->RemoveByKey(key, comparator_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+    if (removed) {
+      num_entries_--;
+    }
     return;
   }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
 
-  LeafPage *target_leaf_page = FindLeafPage(key);
+  /* 悲观删除：等待进行中的分裂完成，再从根页面开始重新加写锁 */
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  smo_latch_.WLock();
+  page = FindLeafPagePessimistic(key, transaction);
+
+  /* B+树在此期间被删空 */
+  if (page == nullptr) {
+    ReleaseWLatches(transaction, false);
+    smo_latch_.WUnlock();
+    return;
+  }
+
+  target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
 
   /* key不存在 */
   if (!target_leaf_page->RemoveByKey(key, comparator_)) {
-    buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), false);
+    ReleaseWLatches(transaction, false);
+    smo_latch_.WUnlock();
     return;
   }
+  num_entries_--;
 
-  if ((target_leaf_page->GetSize() < target_leaf_page->GetMinSize())) {
-    if (!target_leaf_page->IsRootPage()) {
+  if (target_leaf_page->IsUnderflow()) {
+    if (target_leaf_page->GetPageId() != root_page_id_) {
       /* 非根叶子页面下溢 */
-      HandleLeafUnderflow(target_leaf_page);
+      HandleLeafUnderflow(target_leaf_page, transaction);
     } else if (target_leaf_page->GetSize() == 0) {
       /* 根节点为空 */
-      buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), true);
-      buffer_pool_manager_->DeletePage(target_leaf_page->GetPageId());
+      transaction->AddIntoDeletedPageSet(target_leaf_page->GetPageId());
       root_page_id_ = INVALID_PAGE_ID;
       UpdateRootPageId(false);
-    } else {
-      buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), true);
     }
-  } else {
-    /* 没有下溢发生 */
-    buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), true);
   }
+
+  ReleaseWLatches(transaction, true);
+  smo_latch_.WUnlock();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::HandleLeafUnderflow(LeafPage *target_page) {
+void BPLUSTREE_TYPE::HandleLeafUnderflow(LeafPage *target_page, Transaction *transaction) {
   int tar_index;
   int bro_index;
-  auto parent_page =
-      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(target_page->GetParentPageId())->GetData());
-  auto bro_page = static_cast<LeafPage *>(GetBrotherPage(parent_page, target_page, tar_index, bro_index));
-
-  /* 从兄弟页面借取 */
-  if (bro_page->GetSize() > bro_page->GetMinSize()) {
+  InternalPage *parent_page = GetParentPage(target_page, transaction);
+  Page *bro = GetBrotherPage(parent_page, target_page, tar_index, bro_index, transaction);
+  auto bro_page = reinterpret_cast<LeafPage *>(bro->GetData());
+
+  /*
+   * 从兄弟页面借取。变长key的页面还要放得下借来的key，父页面也要放得下新的分隔key；
+   * 借不了也合并不了时，页面保持未满的状态
+   */
+  bool can_borrow = bro_page->CanSpareEntry();
+  if (can_borrow && bro_index < tar_index) {
+    KeyType bro_last_key = bro_page->KeyAt(bro_page->GetSize() - 1);
+    can_borrow = target_page->HasRoomFor(bro_last_key) && parent_page->CanReplaceKey(tar_index, bro_last_key);
+  } else if (can_borrow) {
+    can_borrow = bro_page->GetSize() > 1 && target_page->HasRoomFor(bro_page->KeyAt(0)) &&
+                 parent_page->CanReplaceKey(bro_index, bro_page->KeyAt(1));
+  }
+  if (can_borrow) {
     if (bro_index < tar_index) {
       /* 从左兄弟借最后一个数据 */
       KeyType bro_last_key = bro_page->KeyAt(bro_page->GetSize() - 1);
@@ -286,6 +888,7 @@ void BPLUSTREE_TYPE::HandleLeafUnderflow(LeafPage *target_page) {
       bro_page->RemoveByKey(bro_last_key, comparator_);
       target_page->InsertByKey(bro_last_key, bro_last_value, comparator_);
       parent_page->SetKeyAt(tar_index, bro_last_key);
+      bro_page->SetHighKey(bro_last_key);
     } else {
       /* 从右兄弟借第一个数据 */
       KeyType bro_first_key = bro_page->KeyAt(0);
@@ -293,11 +896,12 @@ void BPLUSTREE_TYPE::HandleLeafUnderflow(LeafPage *target_page) {
       bro_page->RemoveByKey(bro_first_key, comparator_);
       target_page->InsertByKey(bro_first_key, bro_first_value, comparator_);
       parent_page->SetKeyAt(bro_index, bro_page->KeyAt(0));
+      target_page->SetHighKey(bro_page->KeyAt(0));
     }
+    num_redistributions_++;
 
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+    bro->WUnlatch();
     buffer_pool_manager_->UnpinPage(bro_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(target_page->GetPageId(), true);
     return;
   }
 
@@ -316,64 +920,76 @@ void BPLUSTREE_TYPE::HandleLeafUnderflow(LeafPage *target_page) {
     des_page = target_page;
     src_index = bro_index;
   }
+  if (!des_page->CanMergeFrom(src_page)) {
+    bro->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bro_page->GetPageId(), false);
+    return;
+  }
 
   src_page->MoveAllDataTo(des_page);
+  LinkPrevPage(des_page->GetNextPageId(), des_page->GetPageId());
+  num_merges_++;
   parent_page->RemoveByIndex(src_index);
-  buffer_pool_manager_->UnpinPage(src_page->GetPageId(), true);
-  buffer_pool_manager_->DeletePage(src_page->GetPageId());
+  transaction->AddIntoDeletedPageSet(src_page->GetPageId());
 
-  if (parent_page->GetSize() < parent_page->GetMinSize()) {
-    if (!parent_page->IsRootPage()) {
+  if (parent_page->IsUnderflow()) {
+    if (parent_page->GetPageId() != root_page_id_) {
       /* 非根内部页面下溢 */
-      HandleInternalUnderflow(parent_page);
+      HandleInternalUnderflow(parent_page, transaction);
     } else if (parent_page->GetSize() == 1) {
       /* parent_page为根且仅有des_page一个孩子 */
       root_page_id_ = des_page->GetPageId();
-      des_page->SetParentPageId(INVALID_PAGE_ID);
       UpdateRootPageId(false);
-      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
-      buffer_pool_manager_->DeletePage(parent_page->GetPageId());
-    } else {
-      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      transaction->AddIntoDeletedPageSet(parent_page->GetPageId());
     }
-  } else {
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
   }
-  buffer_pool_manager_->UnpinPage(des_page->GetPageId(), true);
+
+  bro->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bro_page->GetPageId(), true);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::HandleInternalUnderflow(InternalPage *target_page) {
+void BPLUSTREE_TYPE::HandleInternalUnderflow(InternalPage *target_page, Transaction *transaction) {
   /* 从缓冲池获取兄弟页面及相关下标 */
   int tar_index;
   int bro_index;
-  auto parent_page =
-      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(target_page->GetParentPageId())->GetData());
-  auto bro_page = static_cast<InternalPage *>(GetBrotherPage(parent_page, target_page, tar_index, bro_index));
-
-  /* 从兄弟页面借取 */
-  if (bro_page->GetSize() > bro_page->GetMinSize()) {
+  InternalPage *parent_page = GetParentPage(target_page, transaction);
+  Page *bro = GetBrotherPage(parent_page, target_page, tar_index, bro_index, transaction);
+  auto bro_page = reinterpret_cast<InternalPage *>(bro->GetData());
+
+  /* 从兄弟页面借取，同样要检查变长key的页面放得下移动的key */
+  bool can_borrow = bro_page->CanSpareEntry();
+  if (can_borrow && bro_index < tar_index) {
+    KeyType bro_last_key = bro_page->KeyAt(bro_page->GetSize() - 1);
+    can_borrow = target_page->HasRoomFor(parent_page->KeyAt(tar_index), bro_last_key) &&
+                 parent_page->CanReplaceKey(tar_index, bro_last_key);
+  } else if (can_borrow) {
+    can_borrow = bro_page->GetSize() > 2 && target_page->HasRoomFor(parent_page->KeyAt(bro_index)) &&
+                 parent_page->CanReplaceKey(bro_index, bro_page->KeyAt(1));
+  }
+  if (can_borrow) {
     if (bro_index < tar_index) {
       /* 从左兄弟借最后一个数据 */
       KeyType bro_last_key = bro_page->KeyAt(bro_page->GetSize() - 1);
       page_id_t bro_last_value = bro_page->ValueAt(bro_page->GetSize() - 1);
       bro_page->RemoveByValue(bro_last_value);
       target_page->SetKeyAt(0, parent_page->KeyAt(tar_index));  // 临时填充首个key
-      target_page->InsertByIndex(0, bro_last_key, bro_last_value, comparator_, buffer_pool_manager_);
+      target_page->InsertByIndex(0, bro_last_key, bro_last_value);
       parent_page->SetKeyAt(tar_index, bro_last_key);
+      bro_page->SetHighKey(bro_last_key);
     } else {
       /* 从右兄弟借第一个数据 */
       KeyType bro_first_key = parent_page->KeyAt(bro_index);
       page_id_t bro_first_value = bro_page->ValueAt(0);
       bro_page->RemoveByValue(bro_first_value);
-      target_page->InsertByIndex(target_page->GetSize(), bro_first_key, bro_first_value, comparator_,
-                                 buffer_pool_manager_);
+      target_page->InsertByIndex(target_page->GetSize(), bro_first_key, bro_first_value);
       parent_page->SetKeyAt(bro_index, bro_page->KeyAt(0));
+      target_page->SetHighKey(bro_page->KeyAt(0));
     }
+    num_redistributions_++;
 
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+    bro->WUnlatch();
     buffer_pool_manager_->UnpinPage(bro_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(target_page->GetPageId(), true);
     return;
   }
 
@@ -392,85 +1008,77 @@ void BPLUSTREE_TYPE::HandleInternalUnderflow(InternalPage *target_page) {
     des_page = target_page;
     src_index = bro_index;
   }
+  KeyType middle_key = parent_page->KeyAt(src_index);  // 父页面中的分隔key下移作为src_page的首个key
+  if (!des_page->CanMergeFrom(src_page, middle_key)) {
+    bro->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bro_page->GetPageId(), false);
+    return;
+  }
 
-  src_page->SetKeyAt(0, FindFistKey(src_page));  // 临时填充首个key
-  src_page->MoveAllDataTo(des_page, comparator_, buffer_pool_manager_);
+  src_page->MoveAllDataTo(des_page, middle_key);
+  num_merges_++;
   parent_page->RemoveByIndex(src_index);
-  buffer_pool_manager_->UnpinPage(src_page->GetPageId(), true);
-  buffer_pool_manager_->DeletePage(src_page->GetPageId());
+  transaction->AddIntoDeletedPageSet(src_page->GetPageId());
 
-  if (parent_page->GetSize() < parent_page->GetMinSize()) {
-    if (!parent_page->IsRootPage()) {
+  if (parent_page->IsUnderflow()) {
+    if (parent_page->GetPageId() != root_page_id_) {
       /* 非根内部页面下溢 */
-      HandleInternalUnderflow(parent_page);
+      HandleInternalUnderflow(parent_page, transaction);
     } else if (parent_page->GetSize() == 1) {
       /* parent_page为根且仅有des_page一个孩子 */
       root_page_id_ = des_page->GetPageId();
-      des_page->SetParentPageId(INVALID_PAGE_ID);
       UpdateRootPageId(false);
-      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
-      buffer_pool_manager_->DeletePage(parent_page->GetPageId());
-    } else {
-      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      transaction->AddIntoDeletedPageSet(parent_page->GetPageId());
     }
-  } else {
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
   }
-  buffer_pool_manager_->UnpinPage(des_page->GetPageId(), true);
+
+  bro->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bro_page->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetParentPage(BPlusTreePage *child_page, Transaction *transaction) -> InternalPage * {
+  /* 下溢的页面不安全，下降时它的父页面一定仍在page set中并持有写锁 */
+  auto page_set = transaction->GetPageSet();
+  auto child = std::find_if(page_set->begin(), page_set->end(), [child_page](Page *page) {
+    return page != nullptr && page->GetPageId() == child_page->GetPageId();
+  });
+  assert(child != page_set->end() && child != page_set->begin() && *std::prev(child) != nullptr);
+  return reinterpret_cast<InternalPage *>((*std::prev(child))->GetData());
 }
 
+/*
+ * 获取child_page的兄弟页面并加写锁，左兄弟优先
+ */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetBrotherPage(InternalPage *parent_page, BPlusTreePage *child_page, int &target_index,
-                                    int &bro_index) -> BPlusTreePage * {
+                                    int &bro_index, Transaction *transaction) -> Page * {
   target_index = parent_page->GetIndexByValue(child_page->GetPageId());
 
-  /* 只有左兄弟 */
-  if (target_index == parent_page->GetSize() - 1) {
-    auto bro_page = reinterpret_cast<BPlusTreePage *>(
-        buffer_pool_manager_->FetchPage(parent_page->ValueAt(target_index - 1))->GetData());
-    bro_index = target_index - 1;
-    return bro_page;
-  }
-
   /* 只有右兄弟 */
   if (target_index == 0) {
-    auto bro_page = reinterpret_cast<BPlusTreePage *>(
-        buffer_pool_manager_->FetchPage(parent_page->ValueAt(target_index + 1))->GetData());
     bro_index = target_index + 1;
-    return bro_page;
+    Page *bro = buffer_pool_manager_->FetchPage(parent_page->ValueAt(bro_index));
+    bro->WLatch();
+    return bro;
   }
 
-  /* 既有左兄弟也有右兄弟 */
-  auto lbro_page = reinterpret_cast<BPlusTreePage *>(
-      buffer_pool_manager_->FetchPage(parent_page->ValueAt(target_index - 1))->GetData());
-  auto rbro_page = reinterpret_cast<BPlusTreePage *>(
-      buffer_pool_manager_->FetchPage(parent_page->ValueAt(target_index + 1))->GetData());
-
-  /* 左兄弟优先 */
-  if (rbro_page->GetSize() > rbro_page->GetMinSize() && lbro_page->GetSize() < lbro_page->GetMinSize()) {
-    buffer_pool_manager_->UnpinPage(lbro_page->GetPageId(), false);
-    bro_index = target_index + 1;
-    return rbro_page;
-  }
-  buffer_pool_manager_->UnpinPage(rbro_page->GetPageId(), false);
+  /*
+   * 迭代器从左到右加锁，因此先释放child_page的写锁，对左兄弟加锁后再重新锁住child_page，避免死锁。
+   * 父页面的写锁保证在此期间没有其他写操作能访问child_page
+   */
   bro_index = target_index - 1;
-  return lbro_page;
-}
-
-INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::FindFistKey(InternalPage *target_page) -> KeyType {
-  assert(root_page_id_ != INVALID_PAGE_ID);
-
-  auto cur_page =
-      reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(target_page->ValueAt(0))->GetData());
-
-  while (!cur_page->IsLeafPage()) {
-    auto internal_page = static_cast<InternalPage *>(cur_page);
-    cur_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(internal_page->ValueAt(0))->GetData());
-    buffer_pool_manager_->UnpinPage(internal_page->GetPageId(), false);
-  }
-  buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-  return static_cast<LeafPage *>(cur_page)->KeyAt(0);
+  auto page_set = transaction->GetPageSet();
+  auto child = std::find_if(page_set->begin(), page_set->end(), [child_page](Page *page) {
+    return page != nullptr && page->GetPageId() == child_page->GetPageId();
+  });
+  assert(child != page_set->end());
+
+  (*child)->WUnlatch();
+  Page *bro = buffer_pool_manager_->FetchPage(parent_page->ValueAt(bro_index));
+  bro->WLatch();
+  (*child)->WLatch();
+  return bro;
 }
 
 /*****************************************************************************
@@ -483,25 +1091,14 @@ auto BPLUSTREE_TYPE::FindFistKey(InternalPage *target_page) -> KeyType {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafPageRead(KeyType(), SearchMode::LEFTMOST);
+
   /* B+树为空 */
-  if (root_page_id_ == INVALID_PAGE_ID) {
+  if (page == nullptr) {
     return INDEXITERATOR_TYPE();
   }
 
-  /* 循环寻找最左边的叶子页面 */
-  auto cur_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
-  while (true) {
-    if (cur_page->IsLeafPage()) {
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-      return INDEXITERATOR_TYPE(cur_page->GetPageId(), 0, buffer_pool_manager_);
-    }
-
-    /* 继续查找 */
-    page_id_t next_page_id = static_cast<InternalPage *>(cur_page)->ValueAt(0);
-    auto next_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
-    buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-    cur_page = next_page;
-  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, 0);
 }
 
 /*
@@ -511,20 +1108,212 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafPageRead(key);
+
   /* B+树为空 */
-  if (root_page_id_ == INVALID_PAGE_ID) {
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+
+  auto target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, page, target_leaf_page->GetIndexByKey(key, comparator_));
+}
+
+/*
+ * Input parameter is void, find the rightmost leaf page first, then construct
+ * a reverse index iterator
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE {
+  Page *page = FindLeafPageRead(KeyType(), SearchMode::RIGHTMOST);
+
+  /* B+树为空 */
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+
+  auto target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  return INDEXITERATOR_TYPE(this, buffer_pool_manager_, page, target_leaf_page->GetSize() - 1);
+}
+
+/*
+ * Input parameter is high key, find the leaf page that contains the input key
+ * first, then construct a reverse index iterator starting at the largest key
+ * that is not greater than the input key
+ * @return : reverse index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  KeyRange<KeyType> range;
+  range.upper_ = key;
+  return Begin(range, true);
+}
+
+/*
+ * Input parameter is a key range, find the leaf page that contains its first
+ * key in scan order, then construct an index iterator that stops at the other
+ * end of the range
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const KeyRange<KeyType> &range, bool reverse, std::vector<page_id_t> *upcoming)
+    -> INDEXITERATOR_TYPE {
+  if (reverse) {
+    Page *page = range.upper_.has_value() ? FindLeafPageRead(*range.upper_)
+                                          : FindLeafPageRead(KeyType(), SearchMode::RIGHTMOST);
+    /* B+树为空 */
+    if (page == nullptr) {
+      return INDEXITERATOR_TYPE();
+    }
+
+    auto target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = target_leaf_page->GetSize() - 1;
+    if (range.upper_.has_value()) {
+      index = target_leaf_page->GetIndexByKey(*range.upper_, comparator_);
+      if (index == target_leaf_page->GetSize() || !range.upper_inclusive_ ||
+          comparator_(*range.upper_, target_leaf_page->KeyAt(index)) != 0) {
+        index--;  // 可能为-1，由迭代器跳到前一个页面
+      }
+    }
+    INDEXITERATOR_TYPE iterator(this, buffer_pool_manager_, page, index);
+    if (range.lower_.has_value()) {
+      iterator.SetStopKey(*range.lower_, range.lower_inclusive_, &comparator_);
+    }
+    return iterator;
+  }
+
+  std::vector<std::pair<KeyType, page_id_t>> right_siblings;
+  auto *siblings = upcoming != nullptr ? &right_siblings : nullptr;
+  Page *page = range.lower_.has_value() ? FindLeafPageRead(*range.lower_, SearchMode::KEY, nullptr, siblings)
+                                        : FindLeafPageRead(KeyType(), SearchMode::LEFTMOST, nullptr, siblings);
+  /* B+树为空 */
+  if (page == nullptr) {
     return INDEXITERATOR_TYPE();
   }
 
-  LeafPage *target_leaf_page = FindLeafPage(key);
+  /* 首个叶子页面之后、不超过范围上界的右侧兄弟页面，由调用者预取 */
+  for (const auto &[separator, page_id] : right_siblings) {
+    if (upcoming->size() == static_cast<size_t>(INDEX_PREFETCH_LEAVES) ||
+        (range.upper_.has_value() && comparator_(separator, *range.upper_) > 0)) {
+      break;
+    }
+    upcoming->push_back(page_id);
+  }
+
+  auto target_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = 0;
+  if (range.lower_.has_value()) {
+    index = target_leaf_page->GetIndexByKey(*range.lower_, comparator_);
+    if (!range.lower_inclusive_ && index < target_leaf_page->GetSize() &&
+        comparator_(*range.lower_, target_leaf_page->KeyAt(index)) == 0) {
+      index++;
+    }
+  }
+  INDEXITERATOR_TYPE iterator(buffer_pool_manager_, page, index);
+  if (range.upper_.has_value()) {
+    iterator.SetStopKey(*range.upper_, range.upper_inclusive_, &comparator_);
+  }
+  return iterator;
+}
 
-  int i = 0;
-  while (i < target_leaf_page->GetSize() && comparator_(target_leaf_page->KeyAt(i), key) < 0) {
-    i++;
+/*
+ * Collect the separator keys strictly inside the range one level at a time,
+ * walking each level along the right links, until a level has enough of them
+ * for num_partitions sub-ranges or the next level holds the leaves. Then pick
+ * evenly spaced separators as the boundaries between the sub-ranges
+ * @return : consecutive sub-ranges whose union is the input range
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::PartitionRange(const KeyRange<KeyType> &range, size_t num_partitions)
+    -> std::vector<KeyRange<KeyType>> {
+  auto above_lower = [&](const KeyType &key) {
+    return !range.lower_.has_value() || comparator_(key, *range.lower_) > 0;
+  };
+  auto below_upper = [&](const KeyType &key) {
+    return !range.upper_.has_value() || comparator_(key, *range.upper_) < 0;
+  };
+  KeyType start_key = range.lower_.value_or(KeyType());
+  SearchMode start_mode = range.lower_.has_value() ? SearchMode::KEY : SearchMode::LEFTMOST;
+
+  /* 持有smo_latch_读锁，下一层的页面在释放当前层之后不会被合并删除 */
+  std::vector<KeyType> separators;
+  bool reached_leaves = false;
+  smo_latch_.RLock();
+  page_id_t page_id = GetRootPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    page->RLatch();
+    if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      /* 根页面是叶子页面，没有分隔key */
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      break;
+    }
+    page = MoveRight(page, start_key, start_mode, false);
+    auto internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+    page_id_t child_page_id = internal_page->ValueAt(
+        start_mode == SearchMode::KEY ? internal_page->GetIndexByKey(start_key, comparator_) : 0);
+
+    /* 页面之间的上界也是这一层的分隔key */
+    separators.clear();
+    while (true) {
+      bool past_upper = false;
+      for (int i = 1; i < internal_page->GetSize() && !past_upper; i++) {
+        past_upper = !below_upper(internal_page->KeyAt(i));
+        if (!past_upper && above_lower(internal_page->KeyAt(i))) {
+          separators.push_back(internal_page->KeyAt(i));
+        }
+      }
+      if (past_upper || internal_page->GetNextPageId() == INVALID_PAGE_ID ||
+          !below_upper(internal_page->GetHighKey())) {
+        break;
+      }
+      if (above_lower(internal_page->GetHighKey())) {
+        separators.push_back(internal_page->GetHighKey());
+      }
+      Page *next_page = buffer_pool_manager_->FetchPage(internal_page->GetNextPageId());
+      next_page->RLatch();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = next_page;
+      internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+    /* 孩子页面的类型不会改变，读取时无需加锁 */
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    reached_leaves = reinterpret_cast<BPlusTreePage *>(child_page->GetData())->IsLeafPage();
+    buffer_pool_manager_->UnpinPage(child_page_id, false);
+    if (reached_leaves || separators.size() + 1 >= num_partitions) {
+      break;
+    }
+    page_id = child_page_id;
   }
+  smo_latch_.RUnlock();
 
-  buffer_pool_manager_->UnpinPage(target_leaf_page->GetPageId(), false);
-  return INDEXITERATOR_TYPE(target_leaf_page->GetPageId(), i, buffer_pool_manager_);
+  /* 最底层的分隔key数加一即范围内的叶子页面数，每个子范围至少包含INDEX_PARTITION_MIN_LEAVES个叶子页面 */
+  size_t num_slices = separators.size() + 1;
+  if (reached_leaves) {
+    num_partitions = std::min(num_partitions, num_slices / INDEX_PARTITION_MIN_LEAVES);
+  }
+  num_partitions = std::clamp<size_t>(num_partitions, 1, num_slices);
+
+  std::vector<KeyRange<KeyType>> partitions;
+  KeyRange<KeyType> partition = range;
+  for (size_t i = 1; i < num_partitions; i++) {
+    const KeyType &boundary = separators[i * num_slices / num_partitions - 1];
+    partition.upper_ = boundary;
+    partition.upper_inclusive_ = false;
+    partitions.push_back(partition);
+    partition.lower_ = boundary;
+    partition.lower_inclusive_ = true;
+  }
+  partition.upper_ = range.upper_;
+  partition.upper_inclusive_ = range.upper_inclusive_;
+  partitions.push_back(partition);
+  return partitions;
 }
 
 /*
@@ -535,11 +1324,80 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetNumEntries() const -> size_t { return num_entries_; }
+
 /**
  * @return Page id of the root of this tree
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return root_page_id_; }
+auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
+  root_latch_.RLock();
+  page_id_t root_page_id = root_page_id_;
+  root_latch_.RUnlock();
+  return root_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetStats() -> BPlusTreeStats {
+  BPlusTreeStats stats;
+  stats.num_leaf_splits_ = num_leaf_splits_;
+  stats.num_internal_splits_ = num_internal_splits_;
+  stats.num_merges_ = num_merges_;
+  stats.num_redistributions_ = num_redistributions_;
+  root_latch_.RLock();
+  page_id_t first_page_id = root_page_id_;
+  root_latch_.RUnlock();
+
+  /* 自顶向下逐层统计，每一层从最左侧的页面开始沿右链接遍历 */
+  while (first_page_id != INVALID_PAGE_ID) {
+    stats.height_++;
+    stats.pages_per_level_.push_back(0);
+    Page *page = buffer_pool_manager_->FetchPage(first_page_id);
+    page->RLatch();
+    first_page_id = INVALID_PAGE_ID;
+    while (true) {
+      auto tree_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      stats.pages_per_level_.back()++;
+      if (tree_page->IsLeafPage()) {
+        stats.num_leaf_pages_++;
+        stats.num_entries_ += tree_page->GetSize();
+        stats.leaf_fill_ += static_cast<LeafPage *>(tree_page)->GetFillRatio();
+      } else {
+        auto internal_page = static_cast<InternalPage *>(tree_page);
+        if (first_page_id == INVALID_PAGE_ID) {
+          first_page_id = internal_page->ValueAt(0);
+        }
+        stats.num_internal_pages_++;
+        stats.num_children_ += tree_page->GetSize();
+        stats.internal_fill_ += internal_page->GetFillRatio();
+      }
+
+      /* 先对右侧页面加读锁，再释放当前页面 */
+      page_id_t next_page_id = tree_page->GetNextPageId();
+      Page *next_page = nullptr;
+      if (next_page_id != INVALID_PAGE_ID) {
+        next_page = buffer_pool_manager_->FetchPage(next_page_id);
+        next_page->RLatch();
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      if (next_page == nullptr) {
+        break;
+      }
+      page = next_page;
+    }
+  }
+
+  /* 填充率取所有页面的平均值 */
+  if (stats.num_leaf_pages_ != 0) {
+    stats.leaf_fill_ /= stats.num_leaf_pages_;
+  }
+  if (stats.num_internal_pages_ != 0) {
+    stats.internal_fill_ /= stats.num_internal_pages_;
+  }
+  return stats;
+}
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -555,6 +1413,7 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return root_page_id_; }
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  header_page->WLatch();  // 多个索引共享同一个header page
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -562,6 +1421,7 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -665,12 +1525,6 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
       out << leaf_prefix << leaf->GetPageId() << " -> " << leaf_prefix << leaf->GetNextPageId() << ";\n";
       out << "{rank=same " << leaf_prefix << leaf->GetPageId() << " " << leaf_prefix << leaf->GetNextPageId() << "};\n";
     }
-
-    // Print parent links if there is a parent
-    if (leaf->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << leaf->GetParentPageId() << ":p" << leaf->GetPageId() << " -> " << leaf_prefix
-          << leaf->GetPageId() << ";\n";
-    }
   } else {
     auto *inner = reinterpret_cast<InternalPage *>(page);
     // Print node name
@@ -697,14 +1551,11 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
     out << "</TR>";
     // Print table end
     out << "</TABLE>>];\n";
-    // Print Parent link
-    if (inner->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << inner->GetParentPageId() << ":p" << inner->GetPageId() << " -> " << internal_prefix
-          << inner->GetPageId() << ";\n";
-    }
-    // Print leaves
+    // Print leaves, and the links to them since pages do not know their parents
     for (int i = 0; i < inner->GetSize(); i++) {
       auto child_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i))->GetData());
+      out << internal_prefix << inner->GetPageId() << ":p" << child_page->GetPageId() << " -> "
+          << (child_page->IsLeafPage() ? leaf_prefix : internal_prefix) << child_page->GetPageId() << ";\n";
       ToGraph(child_page, bpm, out);
       if (i > 0) {
         auto sibling_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i - 1))->GetData());
@@ -731,8 +1582,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
   if (page->IsLeafPage()) {
     auto *leaf = reinterpret_cast<LeafPage *>(page);
-    std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
-              << " next: " << leaf->GetNextPageId() << std::endl;
+    std::cout << "Leaf Page: " << leaf->GetPageId() << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
       std::cout << leaf->KeyAt(i) << ",";
     }
@@ -740,7 +1590,7 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
     std::cout << std::endl;
   } else {
     auto *internal = reinterpret_cast<InternalPage *>(page);
-    std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
+    std::cout << "Internal Page: " << internal->GetPageId() << " next: " << internal->GetNextPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
       std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
     }
@@ -758,5 +1608,7 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTree<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
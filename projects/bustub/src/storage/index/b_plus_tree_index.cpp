@@ -11,21 +11,184 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <limits>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
 namespace bustub {
+
+/**
+ * Range scan over a BPlusTree. Every batch descends the tree again from just past the last key of the previous
+ * batch, so that no latch is held while the caller processes a batch.
+ *
+ * A forward scan reads the leaves that follow the first one of a batch into the buffer pool ahead of the iterator.
+ * One background task at a time fetches them, and unpins each right away, so the scan holds no frame it is not
+ * reading. The window of prefetched leaves carries over to the next batch, which only fetches leaves new to it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeRangeScan : public IndexRangeScan {
+ public:
+  BPlusTreeRangeScan(const BPLUSTREE_INDEX_TYPE *index, BPlusTree<KeyType, ValueType, KeyComparator> *tree,
+                     BufferPoolManager *buffer_pool_manager, KeyRange<KeyType> range, bool reverse)
+      : index_(index),
+        tree_(tree),
+        buffer_pool_manager_(buffer_pool_manager),
+        range_(std::move(range)),
+        reverse_(reverse) {}
+
+  auto NextBatch(std::vector<RID> *result, std::vector<Tuple> *entries) -> bool override {
+    if (done_) {
+      return false;
+    }
+
+    std::vector<page_id_t> upcoming;
+    auto iter = tree_->Begin(range_, reverse_, reverse_ ? nullptr : &upcoming);
+    Prefetch(upcoming);
+    size_t count = 0;
+    KeyType last_key;
+    for (; !iter.IsEnd() && count < INDEX_SCAN_BATCH_SIZE; ++iter, ++count) {
+      last_key = (*iter).first;
+      result->push_back((*iter).second);
+      if (entries != nullptr) {
+        entries->push_back(index_->MakeEntryTuple(last_key));
+      }
+    }
+    done_ = iter.IsEnd();
+    if (count == 0) {
+      return false;
+    }
+
+    // the next batch starts right after the last key returned
+    if (reverse_) {
+      range_.upper_ = last_key;
+      range_.upper_inclusive_ = false;
+    } else {
+      range_.lower_ = last_key;
+      range_.lower_inclusive_ = false;
+    }
+    return true;
+  }
+
+ private:
+  // start fetching the leaves of `upcoming` that the last window did not cover, unless that is still being fetched
+  void Prefetch(const std::vector<page_id_t> &upcoming) {
+    if (prefetch_.valid() && prefetch_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return;
+    }
+    std::vector<page_id_t> page_ids;
+    for (auto page_id : upcoming) {
+      if (std::find(window_.begin(), window_.end(), page_id) == window_.end()) {
+        page_ids.push_back(page_id);
+      }
+    }
+    window_ = upcoming;
+    if (page_ids.empty()) {
+      return;
+    }
+    prefetch_ = std::async(std::launch::async, [bpm = buffer_pool_manager_, page_ids = std::move(page_ids)] {
+      for (auto page_id : page_ids) {
+        if (bpm->FetchPage(page_id) != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+
+  const BPLUSTREE_INDEX_TYPE *index_;
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyRange<KeyType> range_;
+  bool reverse_;
+  bool done_{false};
+  // the leaves handed to the last prefetch, and the task fetching them
+  std::vector<page_id_t> window_;
+  std::future<void> prefetch_;
+};
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     IOObject io_owner)
     : Index(std::move(metadata)),
-      comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(GetMetadata()->GetKeySchema(), GetMetadata()->GetPayloadSize()),
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+                 io_owner) {
+  size_t suffix_size = GetMetadata()->GetPayloadSize() + (GetMetadata()->IsUnique() ? 0 : KeyType::RID_SIZE);
+  if (sizeof(KeyType) <= suffix_size) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "key type too small for the RID and the included columns");
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakeIndexKey(const Tuple &key, RID rid, bool *fits) const -> KeyType {
+  const auto *metadata = GetMetadata();
+  KeyType index_key;
+  size_t key_size = sizeof(KeyType) - metadata->GetPayloadSize() - (metadata->IsUnique() ? 0 : KeyType::RID_SIZE);
+  bool key_fits = index_key.SetFromKey(key, GetKeySchema(), key_size);
+  if (fits != nullptr) {
+    *fits = key_fits;
+  }
+  // entries of a non-unique index are told apart, and ordered, by their RID
+  if (!metadata->IsUnique()) {
+    index_key.SetRid(rid, metadata->GetPayloadSize());
+  }
+  return index_key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakeEntryKey(const Tuple &entry, RID rid) const -> KeyType {
+  // the key is sized for the declared length of varchar columns, which values are not held to
+  bool fits;
+  KeyType index_key = MakeIndexKey(entry, rid, &fits);
+  const auto *metadata = GetMetadata();
+  if (!metadata->GetIncludeAttrs().empty()) {
+    // the included columns follow the key columns in the entry tuple
+    std::vector<Value> values;
+    auto num_key_columns = metadata->GetIndexColumnCount();
+    for (uint32_t i = 0; i < metadata->GetIncludeAttrs().size(); i++) {
+      values.push_back(entry.GetValue(metadata->GetEntrySchema(), num_key_columns + i));
+    }
+    fits = index_key.SetPayload(values, metadata->GetPayloadSize()) && fits;
+  }
+  if (!fits) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "value longer than the declared length of its indexed column");
+  }
+  return index_key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakeEntryTuple(const KeyType &index_key) const -> Tuple {
+  const auto *metadata = GetMetadata();
+  std::vector<Value> values;
+  for (uint32_t i = 0; i < metadata->GetIndexColumnCount(); i++) {
+    values.push_back(index_key.ToValue(metadata->GetKeySchema(), i));
+  }
+  for (uint32_t i = 0; i < metadata->GetIncludeAttrs().size(); i++) {
+    values.push_back(index_key.PayloadToValue(metadata->GetIncludeSchema(), i, metadata->GetPayloadSize()));
+  }
+  return {values, metadata->GetEntrySchema()};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakeBoundKey(const Tuple &key, bool is_lower, bool inclusive) const -> KeyType {
+  // the all-zero RID sorts before every entry of the key and the all-ones RID after every entry
+  if (is_lower == inclusive) {
+    return MakeIndexKey(key, RID(0, 0));
+  }
+  return MakeIndexKey(key, RID(INVALID_PAGE_ID, std::numeric_limits<uint32_t>::max()));
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = MakeEntryKey(key, rid);
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -33,21 +196,139 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = MakeIndexKey(key, rid);
 
   container_.Remove(index_key, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
-  // construct scan index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  if (GetMetadata()->IsUnique()) {
+    // construct scan index key
+    KeyType index_key = MakeIndexKey(key, RID());
+    container_.GetValue(index_key, result, transaction);
+    return;
+  }
+
+  // the all-zero RID sorts before every entry of the key, so the scan starts at its first entry
+  KeyType index_key = MakeIndexKey(key, RID(0, 0));
+  auto payload_size = GetMetadata()->GetPayloadSize();
+  for (auto iter = container_.Begin(index_key);
+       !iter.IsEnd() && index_key.EqualsIgnoringRid((*iter).first, payload_size); ++iter) {
+    result->push_back((*iter).second);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                   Transaction *transaction) {
+  // the tree wants the keys in ascending order; remember where each sorted key came from
+  bool unique = GetMetadata()->IsUnique();
+  std::vector<std::pair<KeyType, size_t>> index_keys;
+  index_keys.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys.emplace_back(MakeIndexKey(keys[i], unique ? RID() : RID(0, 0)), i);
+  }
+  std::stable_sort(index_keys.begin(), index_keys.end(),
+                   [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; });
+  std::vector<KeyType> sorted_keys;
+  sorted_keys.reserve(index_keys.size());
+  for (const auto &index_key : index_keys) {
+    sorted_keys.push_back(index_key.first);
+  }
+
+  // like ScanKey, a non-unique key matches every entry of its key columns, which starts at the all-zero RID
+  std::vector<std::vector<RID>> sorted_results;
+  if (unique) {
+    container_.GetValues(sorted_keys, &sorted_results, nullptr, transaction);
+  } else {
+    auto payload_size = GetMetadata()->GetPayloadSize();
+    container_.GetValues(
+        sorted_keys, &sorted_results,
+        [payload_size](const KeyType &key, const KeyType &entry) { return key.EqualsIgnoringRid(entry, payload_size); },
+        transaction);
+  }
 
-  container_.GetValue(index_key, result, transaction);
+  results->assign(keys.size(), {});
+  for (size_t i = 0; i < index_keys.size(); i++) {
+    (*results)[index_keys[i].second] = std::move(sorted_results[i]);
+  }
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &next, Transaction *transaction) {
+  // sort the encoded keys, spilling runs to temporary pages when they do not fit in memory
+  ExternalSorter<KeyType, ValueType, KeyComparator> sorter(buffer_pool_manager_, comparator_);
+  Tuple key;
+  RID rid;
+  while (next(&key, &rid)) {
+    sorter.Add(MakeEntryKey(key, rid), rid);
+  }
+
+  auto next_entry = [&sorter](MappingType *entry) { return sorter.Next(entry); };
+  if (container_.BulkLoad(next_entry)) {
+    return;
+  }
+  // the tree is not empty, fall back to regular inserts
+  MappingType entry;
+  while (next_entry(&entry)) {
+    container_.Insert(entry.first, entry.second, transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakeKeyRange(const IndexRange &range) const -> KeyRange<KeyType> {
+  KeyRange<KeyType> key_range;
+  if (range.lower_.has_value()) {
+    key_range.lower_ = MakeBoundKey(*range.lower_, true, range.lower_inclusive_);
+    key_range.lower_inclusive_ = range.lower_inclusive_;
+  }
+  if (range.upper_.has_value()) {
+    key_range.upper_ = MakeBoundKey(*range.upper_, false, range.upper_inclusive_);
+    key_range.upper_inclusive_ = range.upper_inclusive_;
+  }
+  return key_range;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ScanRange(const IndexRange &range, Transaction *transaction)
+    -> std::unique_ptr<IndexRangeScan> {
+  using RangeScan = BPlusTreeRangeScan<KeyType, ValueType, KeyComparator>;
+  return std::make_unique<RangeScan>(this, &container_, buffer_pool_manager_, MakeKeyRange(range), range.reverse_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ScanRangePartitioned(const IndexRange &range, size_t num_partitions,
+                                                Transaction *transaction)
+    -> std::vector<std::unique_ptr<IndexRangeScan>> {
+  BUSTUB_ASSERT(!range.reverse_, "partitioned scans run forward");
+  using RangeScan = BPlusTreeRangeScan<KeyType, ValueType, KeyComparator>;
+  std::vector<std::unique_ptr<IndexRangeScan>> scans;
+  for (auto &key_range : container_.PartitionRange(MakeKeyRange(range), num_partitions)) {
+    scans.push_back(std::make_unique<RangeScan>(this, &container_, buffer_pool_manager_, std::move(key_range), false));
+  }
+  return scans;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetStats() -> std::optional<IndexStats> {
+  BPlusTreeStats tree_stats = container_.GetStats();
+  IndexStats stats;
+  stats.is_paged_ = true;
+  stats.height_ = tree_stats.height_;
+  stats.pages_per_level_ = std::move(tree_stats.pages_per_level_);
+  stats.num_entries_ = tree_stats.num_entries_;
+  stats.fill_factor_ = tree_stats.leaf_fill_;
+  stats.keys_per_leaf_ = tree_stats.AverageLeafEntries();
+  stats.num_splits_ = tree_stats.num_leaf_splits_ + tree_stats.num_internal_splits_;
+  stats.num_merges_ = tree_stats.num_merges_;
+  stats.num_redistributions_ = tree_stats.num_redistributions_;
+  return stats;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetNumEntries() -> std::optional<size_t> { return container_.GetNumEntries(); }
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
@@ -62,5 +343,7 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeIndex<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
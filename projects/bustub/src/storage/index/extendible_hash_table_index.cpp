@@ -1,25 +1,83 @@
 #include <vector>
 
+#include "common/exception.h"
 #include "storage/index/extendible_hash_table_index.h"
 
 namespace bustub {
+
+/**
+ * Scan over the entries of a single key of an ExtendibleHashTableIndex, returned as one batch.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTablePointScan : public IndexRangeScan {
+ public:
+  ExtendibleHashTablePointScan(const HASH_TABLE_INDEX_TYPE *index,
+                               DiskExtendibleHashTable<KeyType, ValueType, KeyComparator> *container,
+                               Transaction *transaction, KeyType key)
+      : index_(index), container_(container), transaction_(transaction), key_(key) {}
+
+  auto NextBatch(std::vector<RID> *result, std::vector<Tuple> *entries) -> bool override {
+    if (done_) {
+      return false;
+    }
+    done_ = true;
+    std::vector<RID> rids;
+    if (!container_->GetValue(transaction_, key_, &rids)) {
+      return false;
+    }
+    result->insert(result->end(), rids.begin(), rids.end());
+    if (entries != nullptr) {
+      entries->insert(entries->end(), rids.size(), index_->MakeEntryTuple(key_));
+    }
+    return true;
+  }
+
+ private:
+  const HASH_TABLE_INDEX_TYPE *index_;
+  DiskExtendibleHashTable<KeyType, ValueType, KeyComparator> *container_;
+  Transaction *transaction_;
+  KeyType key_;
+  bool done_{false};
+};
+
 /*
  * Constructor
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_INDEX_TYPE::ExtendibleHashTableIndex(std::unique_ptr<IndexMetadata> &&metadata,
                                                 BufferPoolManager *buffer_pool_manager,
-                                                const HashFunction<KeyType> &hash_fn)
+                                                const HashFunction<KeyType> &hash_fn, IOObject io_owner)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn, io_owner) {
+  if (!GetMetadata()->GetIncludeAttrs().empty()) {
+    throw NotImplementedException("hash indexes cannot store included columns");
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_INDEX_TYPE::MakeEntryTuple(const KeyType &index_key) const -> Tuple {
+  const auto *metadata = GetMetadata();
+  std::vector<Value> values;
+  for (uint32_t i = 0; i < metadata->GetIndexColumnCount(); i++) {
+    values.push_back(index_key.ToValue(metadata->GetKeySchema(), i));
+  }
+  return {values, metadata->GetEntrySchema()};
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
-  // construct insert index key
+  // construct insert index key; it is sized for the declared length of varchar columns, which values are not held to
   KeyType index_key;
-  index_key.SetFromKey(key);
+  if (!index_key.SetFromKey(key, GetKeySchema())) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "value longer than the declared length of its indexed column");
+  }
 
+  std::vector<RID> existing;
+  if (GetMetadata()->IsUnique() && container_.GetValue(transaction, index_key, &existing)) {
+    return;
+  }
+  // duplicates of a key beyond what a bucket holds go to overflow pages, so this only fails for a present pair
   container_.Insert(transaction, index_key, rid);
 }
 
@@ -27,7 +85,7 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
   container_.Remove(transaction, index_key, rid);
 }
@@ -36,14 +94,33 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
   container_.GetValue(transaction, index_key, result);
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_INDEX_TYPE::ScanRange(const IndexRange &range, Transaction *transaction)
+    -> std::unique_ptr<IndexRangeScan> {
+  if (!range.lower_.has_value() || !range.upper_.has_value() || !range.lower_inclusive_ || !range.upper_inclusive_) {
+    throw NotImplementedException("hash indexes only support equality lookups");
+  }
+  KeyType lower_key;
+  lower_key.SetFromKey(*range.lower_, GetKeySchema());
+  KeyType upper_key;
+  upper_key.SetFromKey(*range.upper_, GetKeySchema());
+  if (comparator_(lower_key, upper_key) != 0) {
+    throw NotImplementedException("hash indexes only support equality lookups");
+  }
+  return std::make_unique<ExtendibleHashTablePointScan<KeyType, ValueType, KeyComparator>>(this, &container_,
+                                                                                           transaction, lower_key);
+}
 template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExtendibleHashTableIndex<GenericKey<128>, RID, GenericComparator<128>>;
+template class ExtendibleHashTableIndex<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
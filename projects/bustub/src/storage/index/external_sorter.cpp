@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.cpp
+//
+// Identification: src/storage/index/external_sorter.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sorter.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::ExternalSorter(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                     size_t buffer_pages)
+    : buffer_pool_manager_(buffer_pool_manager),
+      temp_allocator_(buffer_pool_manager, EXTENT_SIZE, IOObject::Temp()),
+      comparator_(comparator),
+      buffer_size_(std::max<size_t>(buffer_pages, 1) * ENTRIES_PER_PAGE),
+      heap_([this](size_t lhs, size_t rhs) {
+        // priority_queue pops the largest element, so "less" means "comes out later"
+        const auto &lhs_run = runs_[lhs];
+        const auto &rhs_run = runs_[rhs];
+        int cmp = comparator_(lhs_run.entries_[lhs_run.position_].first, rhs_run.entries_[rhs_run.position_].first);
+        return cmp != 0 ? cmp > 0 : lhs > rhs;
+      }) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORTER_TYPE::~ExternalSorter() {
+  for (const auto &run : runs_) {
+    for (size_t i = run.next_page_; i < run.pages_.size(); i++) {
+      buffer_pool_manager_->DeletePage(run.pages_[i]);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!merging_, "Add() after Next()");
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() == buffer_size_) {
+    SpillBuffer();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::Next(MappingType *entry) -> bool {
+  if (!merging_) {
+    StartMerge();
+  }
+  if (heap_.empty()) {
+    return false;
+  }
+
+  size_t run_index = heap_.top();
+  heap_.pop();
+  auto &run = runs_[run_index];
+  *entry = run.entries_[run.position_++];
+  if (run.position_ < run.entries_.size() || LoadNextPage(&run)) {
+    heap_.push(run_index);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::SortBuffer() {
+  std::stable_sort(buffer_.begin(), buffer_.end(), [this](const MappingType &lhs, const MappingType &rhs) {
+    return comparator_(lhs.first, rhs.first) < 0;
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::SpillBuffer() {
+  SortBuffer();
+
+  Run run;
+  for (size_t offset = 0; offset < buffer_.size(); offset += ENTRIES_PER_PAGE) {
+    page_id_t page_id;
+    Page *page = temp_allocator_.NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill a sorted run");
+    }
+    run.last_page_size_ = std::min(ENTRIES_PER_PAGE, buffer_.size() - offset);
+    std::copy_n(buffer_.begin() + offset, run.last_page_size_, reinterpret_cast<MappingType *>(page->GetData()));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    run.pages_.push_back(page_id);
+  }
+  runs_.push_back(std::move(run));
+  num_spilled_runs_++;
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTERNAL_SORTER_TYPE::LoadNextPage(Run *run) -> bool {
+  if (run->next_page_ == run->pages_.size()) {
+    run->entries_.clear();
+    return false;
+  }
+
+  page_id_t page_id = run->pages_[run->next_page_++];
+  size_t num_entries = run->next_page_ == run->pages_.size() ? run->last_page_size_ : ENTRIES_PER_PAGE;
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to read a sorted run");
+  }
+  auto *page_entries = reinterpret_cast<const MappingType *>(page->GetData());
+  run->entries_.assign(page_entries, page_entries + num_entries);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->DeletePage(page_id);
+  run->position_ = 0;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORTER_TYPE::StartMerge() {
+  merging_ = true;
+
+  // the unspilled tail is the last run, it never touches the disk
+  if (!buffer_.empty()) {
+    SortBuffer();
+    Run run;
+    run.entries_ = std::move(buffer_);
+    runs_.push_back(std::move(run));
+  }
+
+  for (size_t i = 0; i < runs_.size(); i++) {
+    if (!runs_[i].entries_.empty() || LoadNextPage(&runs_[i])) {
+      heap_.push(i);
+    }
+  }
+}
+
+template class ExternalSorter<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSorter<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSorter<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSorter<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSorter<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExternalSorter<GenericKey<128>, RID, GenericComparator<128>>;
+template class ExternalSorter<GenericKey<256>, RID, GenericComparator<256>>;
+
+}  // namespace bustub
@@ -3,6 +3,7 @@
  */
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -15,25 +16,71 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(LeafPage *page, int index, BufferPoolManager *buffer_pool_manager)
-    : page_(page), index_(index), buffer_pool_manager_(buffer_pool_manager) {}
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index)
+    : buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      index_(index) {
+  SkipExhaustedPages();
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(int index, page_id_t page_id, BufferPoolManager *buffer_pool_manager)
-    : index_(index), buffer_pool_manager_(buffer_pool_manager), page_id_(page_id) {}
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree,
+                                  BufferPoolManager *buffer_pool_manager, Page *page, int index)
+    : tree_(tree),
+      buffer_pool_manager_(buffer_pool_manager),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      index_(index) {
+  SkipExhaustedPagesReverse();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : tree_(other.tree_),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(other.page_),
+      leaf_(other.leaf_),
+      index_(other.index_),
+      stop_key_(std::move(other.stop_key_)),
+      stop_inclusive_(other.stop_inclusive_),
+      comparator_(other.comparator_) {
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+  other.index_ = 0;
+}
 
-// INDEX_TEMPLATE_ARGUMENTS
-// INDEXITERATOR_TYPE::IndexIterator(GenericKey key, RID rid, GenericComparator comparator) :
-// key_(key), rid_(rid), comparator_(comparator){}
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> INDEXITERATOR_TYPE & {
+  if (this != &other) {
+    Release();
+    tree_ = other.tree_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    index_ = other.index_;
+    stop_key_ = std::move(other.stop_key_);
+    stop_inclusive_ = other.stop_inclusive_;
+    comparator_ = other.comparator_;
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+    other.index_ = 0;
+  }
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_ == nullptr; }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  assert(!IsEnd());
+  item_ = leaf_->GetItem(index_);
+  return item_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
@@ -41,21 +88,105 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
     return *this;
   }
 
-  /* 如果index_加一之后溢出需要进行跳页处理 */
-  if (++index_ == page_->GetSize()) {
-    page_id_ = page_->GetNextPageId();
-    if (page_id_ == INVALID_PAGE_ID) {
-      buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
-      page_ = nullptr;
-      index_ = -1;
-    } else {
-      buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
-      page_ = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(page_id_)->GetData());
-      index_ = 0;
+  /* 反向迭代器向前一个位置移动 */
+  if (tree_ != nullptr) {
+    index_--;
+    SkipExhaustedPagesReverse();
+  } else {
+    /* 如果index_加一之后溢出需要进行跳页处理 */
+    index_++;
+    SkipExhaustedPages();
+  }
+  CheckStopKey();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetStopKey(const KeyType &key, bool inclusive, const KeyComparator *comparator) {
+  stop_key_ = key;
+  stop_inclusive_ = inclusive;
+  comparator_ = comparator;
+  CheckStopKey();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CheckStopKey() {
+  if (IsEnd() || !stop_key_.has_value()) {
+    return;
+  }
+  int cmp = (*comparator_)(leaf_->KeyAt(index_), *stop_key_);
+  /* 反向迭代器越过终止key的方向相反 */
+  if (tree_ != nullptr) {
+    cmp = -cmp;
+  }
+  if (cmp > 0 || (cmp == 0 && !stop_inclusive_)) {
+    Release();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedPages() {
+  while (page_ != nullptr && index_ >= leaf_->GetSize()) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      Release();
+      return;
     }
+
+    /* 先对下一个页面加读锁再释放当前页面，与其他线程保持从左到右的加锁顺序 */
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    next_page->RLatch();
+    Release();
+    page_ = next_page;
+    leaf_ = reinterpret_cast<LeafPage *>(next_page->GetData());
+    index_ = 0;
   }
+}
 
-  return *this;
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedPagesReverse() {
+  while (page_ != nullptr && index_ < 0) {
+    page_id_t prev_page_id = leaf_->GetPrevPageId();
+    if (prev_page_id == INVALID_PAGE_ID || leaf_->GetSize() == 0) {
+      Release();
+      return;
+    }
+
+    /* 持有当前页面时只能尝试对左侧页面加读锁，否则会与从左到右加锁的线程死锁 */
+    Page *prev_page = buffer_pool_manager_->FetchPage(prev_page_id);
+    if (prev_page->TryRLatch()) {
+      Release();
+      page_ = prev_page;
+      leaf_ = reinterpret_cast<LeafPage *>(prev_page->GetData());
+      index_ = leaf_->GetSize() - 1;
+      continue;
+    }
+
+    /* 加锁失败：放开当前页面，从根重新查找小于当前页面首个key的最大数据 */
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    KeyType first_key = leaf_->KeyAt(0);
+    Release();
+    int index;
+    Page *page = tree_->FindPrevLeafPage(first_key, &index);
+    if (page == nullptr) {
+      return;
+    }
+    page_ = page;
+    leaf_ = reinterpret_cast<LeafPage *>(page->GetData());
+    index_ = index;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  page_ = nullptr;
+  leaf_ = nullptr;
+  index_ = 0;
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
@@ -67,5 +198,7 @@ template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
 template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<GenericKey<128>, RID, GenericComparator<128>>;
+template class IndexIterator<GenericKey<256>, RID, GenericComparator<256>>;
 
 }  // namespace bustub
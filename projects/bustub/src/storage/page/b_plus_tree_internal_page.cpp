@@ -21,16 +21,18 @@ namespace bustub {
  *****************************************************************************/
 /*
  * Init method after creating a new internal page
- * Including set page type, set current size, set page id, set parent id and set
- * max page size
+ * Including set page type, set current size, set page id, set next page id and
+ * set max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetPageId(page_id);
-  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
   SetMaxSize(max_size);
   SetSize(0);
+  /* 页面数据一直延伸到页面末尾 */
+  array_.Init(BUSTUB_PAGE_SIZE - (reinterpret_cast<char *>(&array_) - reinterpret_cast<char *>(this)));
 }
 
 /*
@@ -38,125 +40,93 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  // KeyType key{};
-  return array_[index].first;
-}
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType { return array_.KeyAt(index); }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  array_.SetKeyAt(GetSize(), index, key);
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_.ValueAt(index); }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array_[index].second = value; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array_.SetValueAt(index, value); }
+
+/*
+ * Helper methods to get/set high key, valid only if next page id is valid
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const -> const KeyType & { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &key) { high_key_ = key; }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertByKey(const KeyType &key, const ValueType &value,
-                                                 const KeyComparator &comparator,
-                                                 BufferPoolManager *buffer_pool_manager) {
+                                                 const KeyComparator &comparator) {
   /* 查找插入位置 */
-  int insert_pos = 1;
-  while (insert_pos < GetSize()) {
-    assert(!(comparator(key, array_[insert_pos].first) == 0));  // key不能重复
-
-    if (comparator(key, array_[insert_pos].first) > 0) {
-      insert_pos++;
-    } else {
-      break;
-    }
-  }
+  int insert_pos = GetIndexByKey(key, comparator) + 1;
+  assert(insert_pos == 1 || comparator(key, array_.KeyAt(insert_pos - 1)) != 0);  // key不能重复
 
-  assert(insert_pos > 0);  // 因为第一个key为无效值所以按照key插入时必须保证在array[0]后面插入
-
-  InsertByIndex(insert_pos, key, value, comparator, buffer_pool_manager);
+  InsertByIndex(insert_pos, key, value);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfDataAndInsertTo(B_PLUS_TREE_INTERNAL_PAGE_TYPE *des_page,
                                                              const KeyType &key, const page_id_t &value,
-                                                             const KeyComparator &comparator,
-                                                             BufferPoolManager *buffer_pool_manager) {
-  /* 整合源页面中的数据和待插入的数据 */
-  std::vector<MappingType> tmp_array(GetMaxSize());
-  int i = 1;  // 遍历array
-  int j = 0;  // 遍历tmp_array
-  // [invalid key, 1, 3] & 2 -> [1 2 3]
-  while (i < GetMaxSize() && comparator(array_[i].first, key) < 0) {
-    tmp_array.at(j) = array_[i];
-    i++;
-    j++;
-  }
-  tmp_array.at(j++) = std::make_pair(key, value);
-  while (i < GetMaxSize()) {
-    tmp_array.at(j) = array_[i];
-    i++;
-    j++;
-  }
-
-  /* 将整合后的数据对半分配到两个子页面中 */
-  this->SetSize(1);
-  des_page->SetSize(0);
-  j = 0;
-  for (i = 1; i < GetMinSize(); i++, j++) {
-    array_[i] = tmp_array.at(j);
-    this->IncreaseSize(1);
-
-    auto child_page =
-        reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(tmp_array.at(j).second)->GetData());
-    child_page->SetParentPageId(this->GetPageId());
-    buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
-  }
-  for (i = 0; j < GetMaxSize(); i++, j++) {
-    des_page->array_[i] = tmp_array.at(j);  // 首个key也被赋有效值
-    des_page->IncreaseSize(1);
-
-    auto child_page =
-        reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(tmp_array.at(j).second)->GetData());
-    child_page->SetParentPageId(des_page->GetPageId());
-    buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
-  }
+                                                             const KeyComparator &comparator) {
+  /* 整合源页面中的数据和待插入的数据，[invalid key, 1, 3] & 2 -> [invalid key, 1, 2, 3] */
+  std::vector<MappingType> entries = array_.Entries(GetSize());
+  entries.insert(entries.begin() + GetIndexByKey(key, comparator) + 1, std::make_pair(key, value));
+  int count = static_cast<int>(entries.size());
+
+  /*
+   * 当前页面保留首个孩子和之后的min_size - 1个数据，其余数据移到分裂页面，分裂页面的首个key被赋有效值。
+   * 变长key按字节数对半分
+   */
+  int split_index = 1 + KeyArray::SplitIndex(entries.data() + 1, count - 1, GetMinSize() - 1);
+  des_page->array_.Assign(entries.data() + split_index, count - split_index);
+  des_page->SetSize(count - split_index);
+  array_.Assign(entries.data(), split_index);
+  this->SetSize(split_index);
+
+  /* 孩子页面不记录父页面，只需把分裂页面链接到当前页面右侧，它的首个key即当前页面新的上界 */
+  des_page->SetNextPageId(this->GetNextPageId());
+  des_page->SetHighKey(this->GetHighKey());
+  this->SetNextPageId(des_page->GetPageId());
+  this->SetHighKey(des_page->KeyAt(0));
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveByIndex(int index) {
-  for (int i = index; i < GetSize() - 1; i++) {
-    array_[i] = array_[i + 1];
-  }
-
+  array_.RemoveAt(GetSize(), index);
   DecreaseSize(1);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveByValue(const page_id_t &value) {
-  for (int i = 0; i < GetSize(); i++) {
-    if (array_[i].second == value) {
-      RemoveByIndex(i);
-    }
+  int index = GetIndexByValue(value);
+  if (index != -1) {
+    RemoveByIndex(index);
   }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertByIndex(int index, const KeyType &key, const ValueType &value,
-                                                   const KeyComparator &comparator,
-                                                   BufferPoolManager *buffer_pool_manager) {
-  array_[index].first = key;
-  array_[index].second = value;
-  auto child_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(value)->GetData());
-  child_page->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value, true);
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertByIndex(int index, const KeyType &key, const ValueType &value) {
+  /* 插入位置后面的元素后移并插入 */
+  array_.InsertAt(GetSize(), index, key, value);
+  IncreaseSize(1);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetIndexByValue(const ValueType &value) -> int {
   for (int i = 0; i < GetSize(); i++) {
-    if (array_[i].second == value) {
+    if (array_.ValueAt(i) == value) {
       return i;
     }
   }
@@ -164,19 +134,74 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetIndexByValue(const ValueType &value) ->
   return -1;
 }
 
+/*
+ * 二分查找key所在子树对应的下标，即最后一个满足KeyAt(index) <= key的位置（首个key无效，视为负无穷）
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetIndexByKey(const KeyType &key, const KeyComparator &comparator) const -> int {
+  /* 查找第一个大于key的位置 */
+  return array_.PartitionPoint(1, GetSize(),
+                               [&](const KeyType &entry_key) { return comparator(entry_key, key) <= 0; }) -
+         1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetIndexBeforeKey(const KeyType &key, const KeyComparator &comparator) const
+    -> int {
+  /* 查找第一个不小于key的位置，它左侧的孩子页面包含所有小于key的数据中最大的那些 */
+  return array_.PartitionPoint(1, GetSize(),
+                               [&](const KeyType &entry_key) { return comparator(entry_key, key) < 0; }) -
+         1;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllDataTo(B_PLUS_TREE_INTERNAL_PAGE_TYPE *des_page,
-                                                   const KeyComparator &comparator,
-                                                   BufferPoolManager *buffer_pool_manager) {
-  for (int i = 0, j = des_page->GetSize(); i < GetSize(); i++, j++) {
-    des_page->array_[j] = array_[i];
-    des_page->IncreaseSize(1);
-
-    auto child_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(array_[i].second)->GetData());
-    child_page->SetParentPageId(des_page->GetPageId());
-    buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
-  }
+                                                   const KeyType &middle_key) {
+  std::vector<MappingType> entries = array_.Entries(GetSize());
+  entries[0].first = middle_key;  // 父页面中的分隔key下移作为首个key
+  des_page->array_.Append(des_page->GetSize(), entries);
+  des_page->IncreaseSize(GetSize());
   this->SetSize(0);
+
+  des_page->SetNextPageId(this->GetNextPageId());
+  des_page->SetHighKey(this->GetHighKey());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomFor(const KeyType &key, double fill_factor) const -> bool {
+  return array_.HasRoomFor(GetSize(), key, fill_factor);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomFor(const KeyType &key, const KeyType &other_key) const -> bool {
+  return array_.HasRoomFor(GetSize(), key, other_key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanReplaceKey(int index, const KeyType &key) const -> bool {
+  return array_.HasRoomToReplace(GetSize(), index, key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMergeFrom(const B_PLUS_TREE_INTERNAL_PAGE_TYPE *src_page,
+                                                  const KeyType &middle_key) const -> bool {
+  return GetSize() + src_page->GetSize() <= GetMaxSize() &&
+         array_.HasRoomToMerge(GetSize(), src_page->array_, src_page->GetSize(), &middle_key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const -> bool {
+  return GetSize() < GetMinSize() && array_.IsLessThanHalfFull(GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSpareEntry() const -> bool {
+  return GetSize() > GetMinSize() || array_.CanSpareEntry(GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetFillRatio() const -> double {
+  return array_.FillRatio(GetSize(), GetMaxSize());
 }
 
 // valuetype for internalNode should be page id_t
@@ -185,4 +210,6 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
+template class BPlusTreeInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
 }  // namespace bustub
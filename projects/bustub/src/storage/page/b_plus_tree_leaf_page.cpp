@@ -23,77 +23,75 @@ namespace bustub {
 
 /**
  * Init method after creating a new leaf page
- * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * Including set page type, set current size to zero, set page id, set
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
   SetPageId(page_id);
-  SetParentPageId(parent_id);
   SetMaxSize(max_size);
   SetSize(0);
   SetPageType(IndexPageType::LEAF_PAGE);
   SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
+  /* 页面数据一直延伸到页面末尾 */
+  array_.Init(BUSTUB_PAGE_SIZE - (reinterpret_cast<char *>(&array_) - reinterpret_cast<char *>(this)));
 }
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get high key, valid only if next page id is valid
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const -> const KeyType & { return high_key_; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &key) { high_key_ = key; }
+
+/**
+ * Helper methods to set/get prev page id
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
-  // replace with your own code
-  // KeyType key{};
-  return array_[index].first;
-}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType { return array_.KeyAt(index); }
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_.ValueAt(index); }
+
+/*
+ * Helper method to get the key & value pair associated with input "index"(a.k.a array
+ * offset), used by the index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType {
+  return {array_.KeyAt(index), array_.ValueAt(index)};
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::InsertByKey(const KeyType &key, const ValueType &value,
                                              const KeyComparator &comparator) -> bool {
-  int initial_len = GetSize();  // 插入数据前的长度
-  int insert_pos = 0;           // 插入数据位置
-
-  // 2 -> 1 3
-  // 2 -> 1 2 3
-  // 2 -> 1
-  // 2 -> 3
-  while (insert_pos < initial_len) {
-    if (comparator(key, array_[insert_pos].first) == 0) {
-      return false;  // key不能重复
-    }
-
-    if (comparator(key, array_[insert_pos].first) > 0) {
-      insert_pos++;
-    } else {
-      break;
-    }
-  }
+  int initial_len = GetSize();                      // 插入数据前的长度
+  int insert_pos = GetIndexByKey(key, comparator);  // 插入数据位置
 
-  /* 插入位置后面的元素后移 */
-  IncreaseSize(1);
-  for (int i = initial_len; i > insert_pos; i--) {
-    array_[i] = array_[i - 1];
+  if (insert_pos < initial_len && comparator(key, array_.KeyAt(insert_pos)) == 0) {
+    return false;  // key不能重复
   }
 
-  /* 插入 */
-  array_[insert_pos].first = key;
-  array_[insert_pos].second = value;
+  /* 插入位置后面的元素后移并插入 */
+  array_.InsertAt(initial_len, insert_pos, key, value);
+  IncreaseSize(1);
 
   return true;
 }
@@ -102,51 +100,94 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfDataTo(B_PLUS_TREE_LEAF_PAGE_TYPE *des_page) {
   int initial_len = GetSize();  // 移出数据前的长度
 
-  for (int i = GetMinSize(), j = 0; i < initial_len; i++, j++) {
-    des_page->array_[j] = array_[i];
-    des_page->IncreaseSize(1);
-    this->DecreaseSize(1);
-  }
-
+  /* 定长key按条目数对半分，变长key按字节数对半分；两个页面各自重新计算公共前缀 */
+  std::vector<MappingType> entries = array_.Entries(initial_len);
+  int split_index = KeyArray::SplitIndex(entries.data(), initial_len, GetMinSize());
+  des_page->array_.Assign(entries.data() + split_index, initial_len - split_index);
+  des_page->SetSize(initial_len - split_index);
+  array_.Assign(entries.data(), split_index);
+  SetSize(split_index);
+
+  /*
+   * 原后继页面的前向指针由调用者更新；分裂页面继承上界，当前页面的上界变为两个页面之间的分隔key。
+   * 变长key的分隔key截断为能区分两侧的最短前缀，它也是插入父页面的分隔key
+   */
   des_page->SetNextPageId(this->GetNextPageId());
+  des_page->SetHighKey(this->GetHighKey());
+  des_page->SetPrevPageId(this->GetPageId());
   this->SetNextPageId(des_page->GetPageId());
+  this->SetHighKey(KeyArray::Separator(entries[split_index - 1].first, entries[split_index].first));
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveByIndex(int index) {
-  for (int i = index; i < GetSize() - 1; i++) {
-    array_[i] = array_[i + 1];
-  }
-
+  array_.RemoveAt(GetSize(), index);
   DecreaseSize(1);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveByKey(const KeyType &key, const KeyComparator &comparator) -> bool {
-  for (int i = 0; i < GetSize(); i++) {
-    if (comparator(array_[i].first, key) == 0) {
-      RemoveByIndex(i);
-      return true;
-    }
+  int index = GetIndexByKey(key, comparator);
+  if (index < GetSize() && comparator(array_.KeyAt(index), key) == 0) {
+    RemoveByIndex(index);
+    return true;
   }
 
   return false;
 }
 
+/*
+ * 二分查找第一个不小于key的位置，所有key都小于key时返回GetSize()
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetIndexByKey(const KeyType &key, const KeyComparator &comparator) const -> int {
+  return array_.PartitionPoint(0, GetSize(),
+                               [&](const KeyType &entry_key) { return comparator(entry_key, key) < 0; });
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllDataTo(B_PLUS_TREE_LEAF_PAGE_TYPE *des_page) {
-  for (int i = 0, j = des_page->GetSize(); i < GetSize(); i++, j++) {
-    des_page->array_[j] = array_[i];
-    des_page->IncreaseSize(1);
-  }
+  des_page->array_.Append(des_page->GetSize(), array_.Entries(GetSize()));
+  des_page->IncreaseSize(GetSize());
   this->SetSize(0);
 
   des_page->SetNextPageId(this->GetNextPageId());
+  des_page->SetHighKey(this->GetHighKey());
+}
+
+/*
+ * 定长key的页面只按条目数判断；变长key的页面按字节数判断是否还放得下key，
+ * 只有条目数和字节数都不到一半时才算下溢
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomFor(const KeyType &key, double fill_factor) const -> bool {
+  return array_.HasRoomFor(GetSize(), key, fill_factor);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanMergeFrom(const B_PLUS_TREE_LEAF_PAGE_TYPE *src_page) const -> bool {
+  return GetSize() + src_page->GetSize() < GetMaxSize() &&
+         array_.HasRoomToMerge(GetSize(), src_page->array_, src_page->GetSize(), nullptr);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderflow() const -> bool {
+  return GetSize() < GetMinSize() && array_.IsLessThanHalfFull(GetSize());
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanSpareEntry() const -> bool {
+  return GetSize() > GetMinSize() || array_.CanSpareEntry(GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetFillRatio() const -> double { return array_.FillRatio(GetSize(), GetMaxSize()); }
+
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeLeafPage<GenericKey<256>, RID, GenericComparator<256>>;
 }  // namespace bustub
@@ -18,18 +18,6 @@ namespace bustub {
  * Page type enum class is defined in b_plus_tree_page.h
  */
 auto BPlusTreePage::IsLeafPage() const -> bool { return page_type_ == IndexPageType::LEAF_PAGE; }
-auto BPlusTreePage::IsRootPage() const -> bool {
-  // if root page is leaf page
-  if (page_type_ == IndexPageType::LEAF_PAGE && size_ >= 0 && size_ <= max_size_) {
-    return true;
-  }
-
-  // if root page is internal page
-  if (page_type_ == IndexPageType::INTERNAL_PAGE && size_ >= 1 && size_ <= max_size_) {
-    return true;
-  }
-  return false;
-}
 void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_type; }
 
 /*
@@ -39,7 +27,7 @@ void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_typ
 auto BPlusTreePage::GetSize() const -> int { return size_; }
 void BPlusTreePage::SetSize(int size) { size_ = size; }
 void BPlusTreePage::IncreaseSize(int amount) { size_ += amount; }
-void BPlusTreePage::DecreaseSize(int amount) { size_ += amount; }
+void BPlusTreePage::DecreaseSize(int amount) { size_ -= amount; }
 
 /*
  * Helper methods to get/set max size (capacity) of the page
@@ -64,10 +52,10 @@ auto BPlusTreePage::GetMinSize() const -> int {
 }
 
 /*
- * Helper methods to get/set parent page id
+ * Helper methods to get/set the page id of the right sibling on the same level
  */
-auto BPlusTreePage::GetParentPageId() const -> page_id_t { return parent_page_id_; }
-void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) { parent_page_id_ = parent_page_id; }
+auto BPlusTreePage::GetNextPageId() const -> page_id_t { return next_page_id_; }
+void BPlusTreePage::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
 /*
  * Helper methods to get/set self page id
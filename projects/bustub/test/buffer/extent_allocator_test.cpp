@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator_test.cpp
+//
+// Identification: test/buffer/extent_allocator_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/extent_allocator.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, InterleavedAllocationTest) {
+  const size_t extent_size = 4;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(10, disk_manager.get());
+  ExtentAllocator first(bpm.get(), extent_size);
+  ExtentAllocator second(bpm.get(), extent_size);
+
+  // both objects grow at once, yet each one gets runs of adjacent pages
+  std::vector<page_id_t> first_pages;
+  std::vector<page_id_t> second_pages;
+  for (size_t i = 0; i < 2 * extent_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, first.NewPage(&page_id));
+    first_pages.push_back(page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    ASSERT_NE(nullptr, second.NewPage(&page_id));
+    second_pages.push_back(page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  EXPECT_EQ((std::vector<page_id_t>{0, 1, 2, 3, 8, 9, 10, 11}), first_pages);
+  EXPECT_EQ((std::vector<page_id_t>{4, 5, 6, 7, 12, 13, 14, 15}), second_pages);
+
+  // single-page allocation continues after the reserved extents
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(16, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+}
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, FullBufferPoolTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(2, disk_manager.get());
+  ExtentAllocator allocator(bpm.get(), 8);
+
+  page_id_t page_id;
+  ASSERT_NE(nullptr, allocator.NewPage(&page_id));
+  EXPECT_EQ(0, page_id);
+  ASSERT_NE(nullptr, allocator.NewPage(&page_id));
+  EXPECT_EQ(1, page_id);
+
+  // all frames pinned: the id is not consumed
+  EXPECT_EQ(nullptr, allocator.NewPage(&page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id);
+
+  ASSERT_TRUE(bpm->UnpinPage(0, true));
+  ASSERT_NE(nullptr, allocator.NewPage(&page_id));
+  EXPECT_EQ(2, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(1, false));
+  ASSERT_TRUE(bpm->UnpinPage(2, false));
+}
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, TableHeapTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(10, disk_manager.get());
+  auto txn = std::make_unique<Transaction>(0);
+  TableHeap table_a(bpm.get(), nullptr, nullptr, txn.get());
+  TableHeap table_b(bpm.get(), nullptr, nullptr, txn.get());
+
+  Schema schema({Column{"a", TypeId::VARCHAR, 1000}});
+  Tuple tuple({Value(TypeId::VARCHAR, std::string(1000, 'x'))}, &schema);
+  for (int i = 0; i < 100; i++) {
+    RID rid;
+    ASSERT_TRUE(table_a.InsertTuple(tuple, &rid, txn.get()));
+    ASSERT_TRUE(table_b.InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  // the page chain of each table is one contiguous run
+  for (auto *table : {&table_a, &table_b}) {
+    page_id_t page_id = table->GetFirstPageId();
+    page_id_t expected = page_id;
+    int num_pages = 0;
+    while (page_id != INVALID_PAGE_ID) {
+      EXPECT_EQ(expected++, page_id);
+      auto *page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+      auto next_page_id = page->GetNextPageId();
+      bpm->UnpinPage(page_id, false);
+      page_id = next_page_id;
+      num_pages++;
+    }
+    EXPECT_GT(num_pages, 1);
+    EXPECT_LE(num_pages, EXTENT_SIZE);
+  }
+}
+
+}  // namespace bustub
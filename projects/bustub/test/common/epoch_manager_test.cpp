@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager_test.cpp
+//
+// Identification: test/common/epoch_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/epoch_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(EpochManagerTest, ReclaimTest) {
+  EpochManager epoch_manager;
+  auto object = std::make_shared<int>(1);
+  std::weak_ptr<int> weak_object = object;
+
+  // an object retired while a reader is inside survives any number of later retirements
+  {
+    auto guard = epoch_manager.Enter();
+    epoch_manager.Retire(std::move(object));
+    for (int i = 0; i < 10; i++) {
+      epoch_manager.Retire(std::make_shared<int>(i));
+    }
+    EXPECT_FALSE(weak_object.expired());
+    EXPECT_EQ(11, epoch_manager.NumRetired());
+  }
+
+  // after the reader has left, the next retirement reclaims it
+  epoch_manager.Retire(std::make_shared<int>(0));
+  EXPECT_TRUE(weak_object.expired());
+  epoch_manager.Retire(std::make_shared<int>(0));
+  EXPECT_GE(2, epoch_manager.NumRetired());
+}
+
+// NOLINTNEXTLINE
+TEST(EpochManagerTest, ConcurrentTest) {
+  EpochManager epoch_manager;
+  // readers dereference the published object while one writer keeps replacing and retiring it
+  std::shared_ptr<const int> current = std::make_shared<int>(0);
+  std::atomic<const int *> published{current.get()};
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> readers;
+  for (int thread_itr = 0; thread_itr < 4; thread_itr++) {
+    readers.emplace_back([&]() {
+      while (!done) {
+        auto guard = epoch_manager.Enter();
+        int value = *published.load();
+        ASSERT_GE(value, 0);
+      }
+    });
+  }
+  for (int i = 1; i <= 10000; i++) {
+    std::shared_ptr<const int> next = std::make_shared<int>(i);
+    published.store(next.get());
+    epoch_manager.Retire(std::exchange(current, std::move(next)));
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+}  // namespace bustub
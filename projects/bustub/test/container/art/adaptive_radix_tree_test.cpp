@@ -0,0 +1,257 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_test.cpp
+//
+// Identification: test/container/art/adaptive_radix_tree_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/art/adaptive_radix_tree.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+static auto Lookup(const AdaptiveRadixTree<int> &tree, std::string_view key) -> std::optional<int> {
+  int value;
+  return tree.Get(key, &value) ? std::optional<int>(value) : std::nullopt;
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, PrefixKeysTest) {
+  AdaptiveRadixTree<int> tree;
+  // keys that are prefixes of each other end inside compressed paths and split them
+  EXPECT_TRUE(tree.Insert("abcdef", 1));
+  EXPECT_TRUE(tree.Insert("abc", 2));
+  EXPECT_TRUE(tree.Insert("abcdxy", 3));
+  EXPECT_TRUE(tree.Insert("", 4));
+  EXPECT_TRUE(tree.Insert("b", 5));
+  EXPECT_FALSE(tree.Insert("abc", 6));
+  EXPECT_EQ(5, tree.Size());
+
+  EXPECT_EQ(1, Lookup(tree, "abcdef"));
+  EXPECT_EQ(2, Lookup(tree, "abc"));
+  EXPECT_EQ(3, Lookup(tree, "abcdxy"));
+  EXPECT_EQ(4, Lookup(tree, ""));
+  EXPECT_EQ(5, Lookup(tree, "b"));
+  EXPECT_FALSE(Lookup(tree, "ab").has_value());
+  EXPECT_FALSE(Lookup(tree, "abcd").has_value());
+  EXPECT_FALSE(Lookup(tree, "abcdefg").has_value());
+  EXPECT_FALSE(Lookup(tree, "abcdxz").has_value());
+
+  // removing keys merges the nodes left with a single child back into compressed paths
+  EXPECT_FALSE(tree.Remove("abcd"));
+  EXPECT_TRUE(tree.Remove("abc"));
+  EXPECT_FALSE(tree.Remove("abc"));
+  EXPECT_TRUE(tree.Remove("abcdxy"));
+  EXPECT_EQ(1, Lookup(tree, "abcdef"));
+  EXPECT_TRUE(tree.Remove(""));
+  EXPECT_TRUE(tree.Remove("b"));
+  EXPECT_EQ(1, Lookup(tree, "abcdef"));
+  EXPECT_EQ(1, tree.Size());
+  EXPECT_TRUE(tree.Remove("abcdef"));
+  EXPECT_EQ(0, tree.Size());
+  EXPECT_EQ(0, tree.MemoryUsage());
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, GrowShrinkTest) {
+  AdaptiveRadixTree<int> tree;
+  // every byte value under one node grows it from Node4 through Node16 and Node48 to Node256
+  size_t last_usage = 0;
+  for (int byte = 255; byte >= 0; byte--) {
+    ASSERT_TRUE(tree.Insert(std::string("key") + static_cast<char>(byte), byte));
+    for (int found = 255; found >= byte; found -= 17) {
+      ASSERT_EQ(found, Lookup(tree, std::string("key") + static_cast<char>(found))) << "after inserting " << byte;
+    }
+    EXPECT_GT(tree.MemoryUsage(), last_usage);
+    last_usage = tree.MemoryUsage();
+  }
+  EXPECT_FALSE(Lookup(tree, "key").has_value());
+
+  // removing them shrinks the node back step by step
+  for (int byte = 0; byte < 254; byte++) {
+    ASSERT_TRUE(tree.Remove(std::string("key") + static_cast<char>(byte)));
+    for (int found = 255; found > byte; found -= 13) {
+      ASSERT_EQ(found, Lookup(tree, std::string("key") + static_cast<char>(found))) << "after removing " << byte;
+    }
+    ASSERT_FALSE(Lookup(tree, std::string("key") + static_cast<char>(byte)).has_value());
+  }
+  EXPECT_EQ(2, tree.Size());
+  EXPECT_LT(tree.MemoryUsage(), sizeof(ArtNode16<int>) + 2 * sizeof(ArtNode<int>) + 2 * sizeof(int));
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, RandomTest) {
+  AdaptiveRadixTree<int> tree;
+  std::map<std::string, int> reference;
+  std::mt19937 gen(15445);
+  // a small alphabet and short keys make keys share prefixes and collide often
+  std::uniform_int_distribution<int> char_dist(0, 5);
+  std::uniform_int_distribution<int> len_dist(0, 8);
+  auto random_key = [&]() {
+    std::string key;
+    for (int i = len_dist(gen); i > 0; i--) {
+      key.push_back(static_cast<char>(char_dist(gen) * 51));
+    }
+    return key;
+  };
+
+  for (int i = 0; i < 20000; i++) {
+    std::string key = random_key();
+    if (gen() % 3 == 0) {
+      ASSERT_EQ(reference.erase(key) == 1, tree.Remove(key)) << i;
+    } else {
+      ASSERT_EQ(reference.emplace(key, i).second, tree.Insert(key, i)) << i;
+    }
+    std::string probe = random_key();
+    std::optional<int> value = Lookup(tree, probe);
+    auto it = reference.find(probe);
+    ASSERT_EQ(it == reference.end(), !value.has_value()) << i;
+    if (value.has_value()) {
+      ASSERT_EQ(it->second, *value);
+    }
+  }
+  ASSERT_EQ(reference.size(), tree.Size());
+  for (const auto &[key, value] : reference) {
+    ASSERT_EQ(value, Lookup(tree, key));
+  }
+  for (const auto &[key, value] : reference) {
+    ASSERT_TRUE(tree.Remove(key));
+  }
+  EXPECT_EQ(0, tree.MemoryUsage());
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, ScanTest) {
+  AdaptiveRadixTree<int> tree;
+  std::map<std::string, int> reference;
+  std::mt19937 gen(15445);
+  // bytes above 0x7f make sure labels are ordered as unsigned bytes, the way std::string compares them
+  std::uniform_int_distribution<int> char_dist(0, 5);
+  std::uniform_int_distribution<int> len_dist(0, 6);
+  auto random_key = [&]() {
+    std::string key;
+    for (int i = len_dist(gen); i > 0; i--) {
+      key.push_back(static_cast<char>(char_dist(gen) * 51));
+    }
+    return key;
+  };
+  // enough keys under the same prefix to grow nodes into every layout
+  for (int i = 0; i < 3000; i++) {
+    std::string key = random_key();
+    reference.emplace(key, i);
+    tree.Insert(key, i);
+  }
+  for (int byte = 0; byte < 256; byte += 3) {
+    std::string key = std::string("\x33\x33") + static_cast<char>(byte);
+    reference.emplace(key, byte);
+    tree.Insert(key, byte);
+  }
+
+  for (int i = 0; i < 500; i++) {
+    std::string prefix = random_key().substr(0, 3);
+    std::vector<std::pair<std::string, int>> expected;
+    for (auto it = reference.lower_bound(prefix); it != reference.end(); ++it) {
+      if (it->first.compare(0, prefix.size(), prefix) != 0) {
+        break;
+      }
+      expected.emplace_back(*it);
+    }
+    std::vector<std::pair<std::string, int>> scanned;
+    for (auto it = tree.ScanPrefix(prefix); !it.IsEnd(); ++it) {
+      scanned.emplace_back(it.Key(), it.Value());
+    }
+    ASSERT_EQ(expected, scanned) << "prefix of " << prefix.size() << " bytes";
+
+    // a scan from a key that need not be in the tree starts at the first key not below it
+    std::string from = random_key();
+    auto it = tree.LowerBound(from);
+    for (auto expected_it = reference.lower_bound(from); expected_it != reference.end(); ++expected_it, ++it) {
+      ASSERT_FALSE(it.IsEnd()) << "missing " << expected_it->first.size() << " byte key";
+      ASSERT_EQ(expected_it->first, it.Key());
+      ASSERT_EQ(expected_it->second, it.Value());
+    }
+    ASSERT_TRUE(it.IsEnd());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, VersionTest) {
+  AdaptiveRadixTree<std::shared_ptr<int>> tree;
+  auto value = std::make_shared<int>(1);
+  ASSERT_TRUE(tree.Insert("abc", value));
+  ASSERT_TRUE(tree.Insert("abd", std::make_shared<int>(2)));
+
+  // a reader keeps the version it started in alive, however many versions writers publish meanwhile
+  bool found = tree.Read("abc", [&](const std::shared_ptr<int> &read_value) {
+    ASSERT_TRUE(tree.Remove("abc"));
+    for (int i = 0; i < 100; i++) {
+      ASSERT_TRUE(tree.Insert("key" + std::to_string(i), std::make_shared<int>(i)));
+    }
+    std::shared_ptr<int> current;
+    EXPECT_FALSE(tree.Get("abc", &current));
+    EXPECT_EQ(1, *read_value);
+    EXPECT_EQ(2, value.use_count());
+  });
+  EXPECT_TRUE(found);
+
+  // once it has left, the next writers reclaim the versions it held on to
+  ASSERT_TRUE(tree.Remove("abd"));
+  ASSERT_TRUE(tree.Remove("key0"));
+  EXPECT_EQ(1, value.use_count());
+  EXPECT_EQ(99, tree.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, ConcurrentReadWriteTest) {
+  AdaptiveRadixTree<int> tree;
+  const int num_keys = 1000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(tree.Insert("key/" + std::to_string(i), i));
+  }
+
+  // one writer keeps inserting and removing keys next to the ones readers look up, which must never go missing
+  std::atomic<bool> done{false};
+  std::thread writer([&]() {
+    for (int round = 0; round < 20; round++) {
+      for (int i = 0; i < num_keys; i += 7) {
+        tree.Insert("key/" + std::to_string(i) + "/" + std::to_string(round), round);
+      }
+      for (int i = 0; i < num_keys; i += 7) {
+        tree.Remove("key/" + std::to_string(i) + "/" + std::to_string(round));
+      }
+    }
+    done = true;
+  });
+  std::vector<std::thread> readers;
+  for (int thread_itr = 0; thread_itr < 3; thread_itr++) {
+    readers.emplace_back([&]() {
+      while (!done) {
+        for (int i = 0; i < num_keys; i += 3) {
+          ASSERT_EQ(i, Lookup(tree, "key/" + std::to_string(i)));
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_keys, tree.Size());
+}
+
+}  // namespace bustub
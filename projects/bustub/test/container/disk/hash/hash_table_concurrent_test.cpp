@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_concurrent_test.cpp
+//
+// Identification: test/container/disk/hash/hash_table_concurrent_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/disk/hash/disk_extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+using ConcurrentTestTable = DiskExtendibleHashTable<int, int, IntComparator>;
+
+// helper function to launch multiple threads, each running fn with its thread index
+static void LaunchParallelTest(size_t num_threads, const std::function<void(size_t)> &fn) {
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    threads.emplace_back(fn, thread_itr);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableConcurrentTest, InsertTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  ConcurrentTestTable ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // the threads insert disjoint keys, splitting buckets and doubling the directory as they go
+  const int keys_per_thread = 5000;
+  const size_t num_threads = 4;
+  LaunchParallelTest(num_threads, [&](size_t thread_itr) {
+    for (int i = 0; i < keys_per_thread; i++) {
+      int key = static_cast<int>(thread_itr) * keys_per_thread + i;
+      ASSERT_TRUE(ht.Insert(nullptr, key, key));
+    }
+  });
+
+  ht.VerifyIntegrity();
+  for (int key = 0; key < keys_per_thread * static_cast<int>(num_threads); key++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, key, &res));
+    ASSERT_EQ(std::vector<int>{key}, res);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableConcurrentTest, MixTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  ConcurrentTestTable ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+  const int num_keys = 10000;
+  for (int key = 0; key < num_keys; key++) {
+    ASSERT_TRUE(ht.Insert(nullptr, key, key));
+  }
+
+  // one thread empties the lower half, one fills in new keys and two keep finding the upper half meanwhile
+  LaunchParallelTest(4, [&](size_t thread_itr) {
+    std::vector<int> res;
+    for (int i = 0; i < num_keys / 2; i++) {
+      switch (thread_itr) {
+        case 0:
+          ASSERT_TRUE(ht.Remove(nullptr, i, i));
+          break;
+        case 1:
+          ASSERT_TRUE(ht.Insert(nullptr, num_keys + i, i));
+          break;
+        default:
+          res.clear();
+          ASSERT_TRUE(ht.GetValue(nullptr, num_keys / 2 + i, &res));
+          ASSERT_EQ(1, res.size());
+      }
+    }
+  });
+
+  ht.VerifyIntegrity();
+  for (int key = 0; key < num_keys + num_keys / 2; key++) {
+    std::vector<int> res;
+    EXPECT_EQ(key >= num_keys / 2, ht.GetValue(nullptr, key, &res)) << "key " << key;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableConcurrentTest, DISABLED_ScalingBenchmark) {
+  const int ops_per_thread = 50000;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(256, disk_manager.get());
+    ConcurrentTestTable ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+    // every thread inserts its own keys, then looks each of them up twice
+    auto clock_start = std::chrono::steady_clock::now();
+    LaunchParallelTest(num_threads, [&](size_t thread_itr) {
+      int first_key = static_cast<int>(thread_itr) * ops_per_thread;
+      for (int key = first_key; key < first_key + ops_per_thread / 3; key++) {
+        ht.Insert(nullptr, key, key);
+      }
+      std::vector<int> res;
+      for (int i = 0; i < 2 * ops_per_thread / 3; i++) {
+        res.clear();
+        ht.GetValue(nullptr, first_key + i % (ops_per_thread / 3), &res);
+      }
+    });
+    auto clock_end = std::chrono::steady_clock::now();
+    auto dur = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start);
+    std::cout << "Threads: " << num_threads << ", ops/s: " << num_threads * ops_per_thread * 1000000 / dur.count()
+              << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <memory>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -18,13 +19,14 @@
 #include "container/disk/hash/disk_extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
@@ -117,4 +119,79 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, GrowShrinkTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // the directory doubles as the buckets split
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GE(ht.GetGlobalDepth(), 5);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(std::vector<int>{i}, res);
+  }
+
+  // empty buckets merge with their split images until a single bucket is left
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 0, &res));
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, FullBucketTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // the values of a single key share one bucket, which goes on in overflow pages instead of splitting
+  const int num_values = 2000;
+  for (int i = 0; i < num_values; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, 7, i));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 7, 1500));
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  std::vector<int> res;
+  ht.GetValue(nullptr, 7, &res);
+  EXPECT_EQ(num_values, res.size());
+
+  // other keys are split away from it
+  for (int i = 100; i < 1000; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_LT(0, ht.GetGlobalDepth());
+  for (int i = 100; i < 1000; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+  res.clear();
+  ht.GetValue(nullptr, 7, &res);
+  EXPECT_EQ(num_values, res.size());
+
+  // removing the values frees the overflow pages again
+  for (int i = 0; i < num_values; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, 7, i));
+  }
+  ht.VerifyIntegrity();
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 7, &res));
+  for (int i = 100; i < 1000; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+}
+
 }  // namespace bustub
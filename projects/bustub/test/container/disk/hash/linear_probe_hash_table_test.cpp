@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/disk/hash/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+using LinearProbeTestTable = LinearProbeHashTable<int, int, IntComparator>;
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  LinearProbeTestTable ht("blah", bpm.get(), IntComparator(), 10, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // the table grows several times, every key stays visible while the old table is being drained
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(std::vector<int>{i}, res);
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i / 2, &res)) << "lost " << i / 2 << " after inserting " << i;
+  }
+  EXPECT_GE(ht.GetSize(), 2 * num_keys);
+  EXPECT_GT(ht.GetSize(), initial_size);
+
+  // a key can have several values, but the same pair only once
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+    ASSERT_TRUE(ht.Insert(nullptr, i, -i - 1));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    std::sort(res.begin(), res.end());
+    EXPECT_EQ((std::vector<int>{-i - 1, i}), res);
+  }
+
+  // remove one value of every key and both values of every other key
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, -i - 1));
+    EXPECT_FALSE(ht.Remove(nullptr, i, -i - 1));
+    if (i % 2 == 0) {
+      ASSERT_TRUE(ht.Remove(nullptr, i, i));
+    }
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 != 0, ht.GetValue(nullptr, i, &res)) << "key " << i;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, IncrementalResizeTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  LinearProbeTestTable ht("blah", bpm.get(), IntComparator(), 1000, HashFunction<int>(), 16);
+
+  const int num_keys = 400;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  size_t old_size = ht.GetSize();
+  ht.Resize(old_size);
+  EXPECT_TRUE(ht.IsResizing());
+  EXPECT_GE(ht.GetSize(), 2 * old_size);
+
+  // each insert and remove migrates 16 slots, so the old table lingers for a while and lookups consult both
+  int num_ops = 0;
+  for (int i = 0; ht.IsResizing(); i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, num_keys + i, i));
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+    num_ops += 2;
+    for (int key = i + 1; key <= num_keys + i; key++) {
+      std::vector<int> res;
+      ASSERT_TRUE(ht.GetValue(nullptr, key, &res)) << "key " << key << " after " << num_ops << " operations";
+    }
+    std::vector<int> res;
+    ASSERT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+  EXPECT_GE(static_cast<size_t>(num_ops), old_size / 16);
+  EXPECT_GE(ht.GetSize(), 2 * old_size);
+
+  // a resize that is still in progress is finished before the next one starts
+  ht.Resize(ht.GetSize());
+  ht.Resize(ht.GetSize());
+  EXPECT_TRUE(ht.IsResizing());
+  EXPECT_GE(ht.GetSize(), 8 * old_size);
+  int first_key = num_ops / 2;
+  for (int key = first_key; key < first_key + num_keys; key++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, key, &res)) << "key " << key;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, DISABLED_GrowthLatencyBenchmark) {
+  const int num_keys = 200000;
+  std::cout << "<<< BEGIN" << std::endl;
+  // migrating the whole old table at once, as a one-shot rebuild would, against migrating a few slots per operation
+  for (size_t migrate_slots : {std::numeric_limits<size_t>::max(), static_cast<size_t>(HASH_TABLE_MIGRATE_SLOTS)}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(256, disk_manager.get());
+    LinearProbeTestTable ht("blah", bpm.get(), IntComparator(), 1, HashFunction<int>(), migrate_slots);
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(num_keys);
+    for (int key = 0; key < num_keys; key++) {
+      auto clock_start = std::chrono::steady_clock::now();
+      ht.Insert(nullptr, key, key);
+      auto clock_end = std::chrono::steady_clock::now();
+      latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * (latencies.size() - 1))]; };
+    std::cout << "Migrate slots: "
+              << (migrate_slots == std::numeric_limits<size_t>::max() ? "all" : std::to_string(migrate_slots))
+              << ", insert latency ns p50: " << percentile(0.5) << ", p99: " << percentile(0.99)
+              << ", p99.9: " << percentile(0.999) << ", max: " << latencies.back() << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -2,8 +2,12 @@
  * extendible_hash_test.cpp
  */
 
+#include <chrono>  // NOLINT
+#include <functional>
+#include <iostream>
 #include <memory>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
@@ -264,4 +268,84 @@ TEST(ExtendibleHashTableTest, GetNumBucketsTest1) {
   EXPECT_EQ(8, table->GetNumBuckets());
 }
 
+TEST(ExtendibleHashTableTest, ConcurrentSplitMixTest) {
+  const int num_keys = 20000;
+  auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+  for (int i = 0; i < num_keys; i++) {
+    table->Insert(i, i);
+  }
+
+  // inserts keep splitting buckets and doubling the directory while other threads find and remove entries
+  std::vector<std::thread> threads;
+  threads.emplace_back([&table]() {
+    for (int i = num_keys; i < 3 * num_keys; i++) {
+      table->Insert(i, i);
+    }
+  });
+  threads.emplace_back([&table]() {
+    for (int i = 0; i < num_keys / 2; i++) {
+      EXPECT_TRUE(table->Remove(i));
+    }
+  });
+  for (int tid = 0; tid < 2; tid++) {
+    threads.emplace_back([&table]() {
+      for (int i = num_keys / 2; i < num_keys; i++) {
+        int val;
+        EXPECT_TRUE(table->Find(i, val));
+        EXPECT_EQ(i, val);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < 3 * num_keys; i++) {
+    int val = -1;
+    EXPECT_EQ(i >= num_keys / 2, table->Find(i, val)) << "key " << i;
+    if (i >= num_keys / 2) {
+      EXPECT_EQ(i, val);
+    }
+  }
+  EXPECT_EQ(1 << table->GetGlobalDepth(), table->GetDirectoryNum());
+  for (int i = 0; i < table->GetDirectoryNum(); i++) {
+    EXPECT_LE(table->GetLocalDepth(i), table->GetGlobalDepth());
+  }
+}
+
+TEST(ExtendibleHashTableTest, DISABLED_ThroughputBenchmark) {
+  const int keys_per_thread = 100000;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int num_threads : {1, 2, 4}) {
+    // the buffer pool page table is created with buckets of 4 entries
+    auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+    auto run = [&](const char *name, const std::function<void(int)> &op) {
+      std::vector<std::thread> threads;
+      auto clock_start = std::chrono::steady_clock::now();
+      for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([tid, &op]() {
+          for (int key = tid * keys_per_thread; key < (tid + 1) * keys_per_thread; key++) {
+            op(key);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto clock_end = std::chrono::steady_clock::now();
+      auto dur = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start);
+      std::cout << "Threads: " << num_threads << ", " << name
+                << " ops/s: " << static_cast<int64_t>(num_threads) * keys_per_thread * 1000000 / dur.count()
+                << std::endl;
+    };
+    run("Insert", [&](int key) { table->Insert(key, key); });
+    run("Find", [&](int key) {
+      int val;
+      table->Find(key, val);
+    });
+    run("Remove", [&](int key) { table->Remove(key); });
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
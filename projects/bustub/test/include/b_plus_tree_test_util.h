@@ -0,0 +1,37 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_test_util.h
+//
+// Identification: test/include/b_plus_tree_test_util.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "storage/index/generic_key.h"
+#include "storage/index/index_iterator.h"
+
+namespace bustub {
+
+/** @return the 8-byte key of an integer, as the B+ tree tests index it */
+inline auto MakeIntegerKey(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+/** @return the keys an iterator visits, for trees whose entries store their key as the slot number */
+inline auto CollectKeys(IndexIterator<GenericKey<8>, RID, GenericComparator<8>> iterator) -> std::vector<int64_t> {
+  std::vector<int64_t> keys;
+  for (; !iterator.IsEnd(); ++iterator) {
+    keys.push_back((*iterator).second.GetSlotNum());
+  }
+  return keys;
+}
+
+}  // namespace bustub
@@ -10,12 +10,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <bitset>
+#include <chrono>  // NOLINT
 #include <functional>
+#include <iostream>
 #include <numeric>
 #include <random>
 #include <thread>  // NOLINT
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
 #include "common/exception.h"
 #include "common/logger.h"
 #include "gtest/gtest.h"
@@ -226,4 +234,187 @@ TEST(StarterTrieTest, ConcurrentTest1) {
   threads.clear();
 }
 
+TEST(StarterTrieTest, ScanPrefixTest) {
+  Trie trie;
+  for (const auto &key : {"cab", "ca", "b", "cat", "catalog", "dog", "c", "cb"}) {
+    EXPECT_TRUE(trie.Insert<int>(key, static_cast<int>(std::string(key).size())));
+  }
+  trie.Insert<std::string>("cats", "many");
+
+  auto scan = [&](const std::string &prefix) {
+    std::vector<std::string> keys;
+    for (auto it = trie.ScanPrefix(prefix); !it.IsEnd(); ++it) {
+      keys.push_back(it.Key());
+    }
+    return keys;
+  };
+  EXPECT_EQ((std::vector<std::string>{"c", "ca", "cab", "cat", "catalog", "cats", "cb"}), scan("c"));
+  EXPECT_EQ((std::vector<std::string>{"cat", "catalog", "cats"}), scan("cat"));
+  // a prefix ending within a compressed path
+  EXPECT_EQ((std::vector<std::string>{"catalog"}), scan("cata"));
+  EXPECT_EQ((std::vector<std::string>{"b", "c", "ca", "cab", "cat", "catalog", "cats", "cb", "dog"}), scan(""));
+  EXPECT_TRUE(scan("catz").empty());
+  EXPECT_TRUE(scan("e").empty());
+
+  auto it = trie.ScanPrefix("cats");
+  ASSERT_FALSE(it.IsEnd());
+  EXPECT_EQ("many", std::any_cast<std::string>(it.Value()));
+
+  // the scan keeps seeing the trie as it was when it started
+  it = trie.ScanPrefix("ca");
+  EXPECT_TRUE(trie.Remove("cat"));
+  EXPECT_TRUE(trie.Insert<int>("cab2", 4));
+  std::vector<std::string> keys;
+  for (; !it.IsEnd(); ++it) {
+    keys.push_back(it.Key());
+  }
+  EXPECT_EQ((std::vector<std::string>{"ca", "cab", "cat", "catalog", "cats"}), keys);
+  EXPECT_EQ((std::vector<std::string>{"ca", "cab", "cab2", "catalog", "cats"}), scan("ca"));
+}
+
+#if defined(__SANITIZE_ADDRESS__)
+// declared by <sanitizer/allocator_interface.h>, which not every toolchain ships
+extern "C" auto __sanitizer_get_current_allocated_bytes() -> size_t;  // NOLINT
+#endif
+
+// bytes the process currently has allocated on the heap
+static auto HeapBytes() -> size_t {
+#if defined(__SANITIZE_ADDRESS__)
+  return __sanitizer_get_current_allocated_bytes();
+#elif defined(__GLIBC__)
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+TEST(StarterTrieTest, DISABLED_LookupBenchmark) {
+  constexpr int num_keys = 100000;
+  std::mt19937 gen(15445);
+  std::vector<std::pair<std::string, std::vector<std::string>>> workloads;
+  // random keys share little more than their first character
+  workloads.emplace_back("random", GenerateNRandomString(num_keys));
+  // keys with long shared prefixes, like the paths of a key-value store
+  std::vector<std::string> path_keys;
+  for (int i = 0; i < num_keys; i++) {
+    path_keys.push_back("tenant/" + std::to_string(i % 7) + "/user/" + std::to_string(gen() % 100000000) + "/profile");
+  }
+  workloads.emplace_back("path", std::move(path_keys));
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (auto &[name, keys] : workloads) {
+    size_t heap_before = HeapBytes();
+    auto trie = std::make_unique<Trie>();
+    int num_inserted = 0;
+    for (int i = 0; i < num_keys; i++) {
+      num_inserted += trie->Insert(keys[i], i) ? 1 : 0;
+    }
+    size_t heap_after = HeapBytes();
+
+    std::shuffle(keys.begin(), keys.end(), gen);
+    bool success;
+    int64_t checksum = 0;
+    auto clock_start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 5; round++) {
+      for (const auto &key : keys) {
+        checksum += trie->GetValue<int>(key, &success);
+      }
+    }
+    auto clock_end = std::chrono::steady_clock::now();
+    auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start);
+    std::cout << "Keys: " << name << ", bytes/key: " << (heap_after - heap_before) / num_inserted
+              << ", lookup ns: " << dur.count() / (5 * num_keys) << ", checksum: " << checksum << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+TEST(StarterTrieTest, DISABLED_ReadScalingBenchmark) {
+  constexpr int num_keys = 10000;
+  constexpr int lookups_per_thread = 200000;
+  Trie trie;
+  for (int i = 0; i < num_keys; i++) {
+    trie.Insert("key/" + std::to_string(i), i);
+  }
+
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int num_threads : {1, 2, 4, 8}) {
+    // one writer keeps inserting and removing keys of its own while the readers look up the others
+    std::atomic<bool> stop{false};
+    std::thread writer([&]() {
+      for (int i = 0; !stop; i = (i + 1) % num_keys) {
+        trie.Insert("writer/" + std::to_string(i), i);
+        trie.Remove("writer/" + std::to_string(i));
+      }
+    });
+    std::vector<std::thread> readers;
+    auto clock_start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+      readers.emplace_back([&, tid]() {
+        bool success;
+        for (int i = 0; i < lookups_per_thread; i++) {
+          trie.GetValue<int>("key/" + std::to_string((i * 7919 + tid) % num_keys), &success);
+        }
+      });
+    }
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    auto clock_end = std::chrono::steady_clock::now();
+    stop = true;
+    writer.join();
+    auto dur = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start);
+    std::cout << "Readers: " << num_threads
+              << ", lookups/s: " << static_cast<int64_t>(num_threads) * lookups_per_thread * 1000000 / dur.count()
+              << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+TEST(StarterTrieTest, DISABLED_PrefixScanBenchmark) {
+  constexpr int num_keys = 100000;
+  constexpr int num_prefixes = 2000;
+  Trie trie;
+  for (int i = 0; i < num_keys; i++) {
+    trie.Insert("word/" + std::to_string(i), i);
+  }
+  std::mt19937 gen(15445);
+  std::vector<std::string> prefixes;
+  for (int i = 0; i < num_prefixes; i++) {
+    prefixes.push_back("word/" + std::to_string(1 + gen() % 999));
+  }
+
+  std::cout << "<<< BEGIN" << std::endl;
+  // without a scan, every key that could start with the prefix is generated and looked up
+  int64_t num_found = 0;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (const auto &prefix : prefixes) {
+    std::vector<std::string> candidates{prefix};
+    for (size_t level = 0; level < candidates.size(); level++) {
+      bool success;
+      trie.GetValue<int>(candidates[level], &success);
+      num_found += success ? 1 : 0;
+      if (candidates[level].size() < std::string("word/99999").size()) {
+        for (char digit = '0'; digit <= '9'; digit++) {
+          candidates.push_back(candidates[level] + digit);
+        }
+      }
+    }
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  auto dur = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start);
+  std::cout << "Generated lookups: " << dur.count() / num_prefixes << " us/prefix, found: " << num_found << std::endl;
+
+  num_found = 0;
+  clock_start = std::chrono::steady_clock::now();
+  for (const auto &prefix : prefixes) {
+    for (auto it = trie.ScanPrefix(prefix); !it.IsEnd(); ++it) {
+      num_found++;
+    }
+  }
+  clock_end = std::chrono::steady_clock::now();
+  dur = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start);
+  std::cout << "ScanPrefix: " << dur.count() / num_prefixes << " us/prefix, found: " << num_found << std::endl;
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
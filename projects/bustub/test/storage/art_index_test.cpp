@@ -0,0 +1,261 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index_test.cpp
+//
+// Identification: test/storage/art_index_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/art_index.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+// Collects every batch of a range scan
+auto ScanAll(Index *index, const IndexRange &range, std::vector<Tuple> *entries = nullptr) -> std::vector<RID> {
+  std::vector<RID> result;
+  auto scan = index->ScanRange(range, nullptr);
+  while (scan->NextBatch(&result, entries)) {
+  }
+  return result;
+}
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ArtIndexTest, InsertScanDeleteTest) {
+  Schema schema{{Column{"k", TypeId::BIGINT}}};
+  auto metadata = std::make_unique<IndexMetadata>("k_idx", "t", &schema, std::vector<uint32_t>{0}, false);
+  ArtIndex<GenericKey<16>, RID, GenericComparator<16>> index(std::move(metadata));
+
+  // negative keys too, whose encoding must still sort below the positive ones
+  const int64_t num_keys = 1000;
+  for (int32_t copy = 0; copy < 10; copy++) {
+    for (int64_t key = -num_keys / 2; key < num_keys / 2; key++) {
+      index.InsertEntry(Tuple({Value(TypeId::BIGINT, key)}, &schema), RID(key, copy), nullptr);
+    }
+  }
+  EXPECT_EQ(10 * num_keys, index.GetStats()->num_entries_);
+  for (int64_t key = -num_keys / 2; key < num_keys / 2; key++) {
+    std::vector<RID> result;
+    index.ScanKey(Tuple({Value(TypeId::BIGINT, key)}, &schema), &result, nullptr);
+    ASSERT_EQ(10, result.size()) << "key " << key;
+    for (int32_t copy = 0; copy < 10; copy++) {
+      EXPECT_EQ(RID(key, copy), result[copy]);
+    }
+  }
+
+  // delete the odd copies
+  for (int32_t copy = 1; copy < 10; copy += 2) {
+    for (int64_t key = -num_keys / 2; key < num_keys / 2; key++) {
+      index.DeleteEntry(Tuple({Value(TypeId::BIGINT, key)}, &schema), RID(key, copy), nullptr);
+    }
+  }
+  EXPECT_EQ(5 * num_keys, index.GetStats()->num_entries_);
+  for (int64_t key = -num_keys / 2; key < num_keys / 2; key++) {
+    std::vector<RID> result;
+    index.ScanKey(Tuple({Value(TypeId::BIGINT, key)}, &schema), &result, nullptr);
+    ASSERT_EQ(5, result.size()) << "key " << key;
+    for (const auto &rid : result) {
+      EXPECT_EQ(0, rid.GetSlotNum() % 2);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ArtIndexTest, UniqueIndexTest) {
+  Schema schema{{Column{"k", TypeId::INTEGER}}};
+  auto metadata = std::make_unique<IndexMetadata>("k_idx", "t", &schema, std::vector<uint32_t>{0}, true);
+  ArtIndex<GenericKey<4>, RID, GenericComparator<4>> index(std::move(metadata));
+
+  // the second entry of a key is dropped
+  index.InsertEntry(Tuple({Value(TypeId::INTEGER, 1)}, &schema), RID(1, 0), nullptr);
+  index.InsertEntry(Tuple({Value(TypeId::INTEGER, 1)}, &schema), RID(1, 1), nullptr);
+  std::vector<RID> result;
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, 1)}, &schema), &result, nullptr);
+  EXPECT_EQ(std::vector<RID>{RID(1, 0)}, result);
+  result.clear();
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, 2)}, &schema), &result, nullptr);
+  EXPECT_TRUE(result.empty());
+
+  index.DeleteEntry(Tuple({Value(TypeId::INTEGER, 1)}, &schema), RID(1, 0), nullptr);
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, 1)}, &schema), &result, nullptr);
+  EXPECT_TRUE(result.empty());
+}
+
+// NOLINTNEXTLINE
+TEST(ArtIndexTest, RangeScanTest) {
+  for (bool unique : {true, false}) {
+    Schema schema{{Column{"k", TypeId::INTEGER}}};
+    auto metadata = std::make_unique<IndexMetadata>("k_idx", "t", &schema, std::vector<uint32_t>{0}, unique);
+    ArtIndex<GenericKey<16>, RID, GenericComparator<16>> index(std::move(metadata));
+
+    // more keys than fit in one batch, inserted out of order
+    const int32_t num_keys = 3000;
+    for (int32_t i = 0; i < num_keys; i++) {
+      int32_t key = (i * 7) % num_keys;
+      index.InsertEntry(Tuple({Value(TypeId::INTEGER, key)}, &schema), RID(key, 0), nullptr);
+    }
+
+    auto bound = [&schema](int32_t key) { return Tuple({Value(TypeId::INTEGER, key)}, &schema); };
+    auto expect_keys = [&](const IndexRange &range, int32_t first, int32_t last) {
+      std::vector<Tuple> entries;
+      auto result = ScanAll(&index, range, &entries);
+      ASSERT_EQ(last - first + 1, result.size()) << "unique " << unique;
+      ASSERT_EQ(result.size(), entries.size());
+      for (int32_t i = 0; i <= last - first; i++) {
+        int32_t key = range.reverse_ ? last - i : first + i;
+        ASSERT_EQ(RID(key, 0), result[i]) << "unique " << unique;
+        ASSERT_EQ(key, entries[i].GetValue(&schema, 0).GetAs<int32_t>());
+      }
+    };
+
+    IndexRange range;
+    expect_keys(range, 0, num_keys - 1);
+    range.lower_ = bound(100);
+    range.upper_ = bound(2500);
+    expect_keys(range, 100, 2500);
+    range.lower_inclusive_ = false;
+    range.upper_inclusive_ = false;
+    expect_keys(range, 101, 2499);
+    range.reverse_ = true;
+    expect_keys(range, 101, 2499);
+    range.lower_inclusive_ = true;
+    range.upper_ = std::nullopt;
+    expect_keys(range, 100, num_keys - 1);
+
+    // bounds that are not keys of the index, and an empty range
+    range = IndexRange();
+    range.lower_ = bound(-5);
+    range.upper_ = bound(5);
+    expect_keys(range, 0, 5);
+    range.lower_ = bound(num_keys + 1);
+    range.upper_ = std::nullopt;
+    EXPECT_TRUE(ScanAll(&index, range).empty());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ArtIndexTest, CoveringVarcharTest) {
+  Schema schema{{Column{"name", TypeId::VARCHAR, 16}, Column{"v", TypeId::INTEGER}}};
+  auto metadata = std::make_unique<IndexMetadata>("name_idx", "t", &schema, std::vector<uint32_t>{0}, false,
+                                                  std::vector<uint32_t>{1});
+  ArtIndex<GenericKey<64>, RID, GenericComparator<64>> index(std::move(metadata));
+  const auto *entry_schema = index.GetMetadata()->GetEntrySchema();
+
+  // names that are prefixes of each other keep the order of the strings
+  std::vector<std::string> names{"b", "a", "ab", "abc", "", "ba"};
+  for (size_t i = 0; i < names.size(); i++) {
+    Tuple entry({Value(TypeId::VARCHAR, names[i]), Value(TypeId::INTEGER, static_cast<int32_t>(i))}, entry_schema);
+    index.InsertEntry(entry, RID(0, i), nullptr);
+  }
+
+  std::vector<Tuple> entries;
+  auto result = ScanAll(&index, IndexRange(), &entries);
+  ASSERT_EQ(names.size(), result.size());
+  std::vector<std::string> sorted = names;
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); i++) {
+    auto position = std::find(names.begin(), names.end(), sorted[i]) - names.begin();
+    EXPECT_EQ(sorted[i], entries[i].GetValue(entry_schema, 0).ToString());
+    EXPECT_EQ(position, entries[i].GetValue(entry_schema, 1).GetAs<int32_t>());
+    EXPECT_EQ(RID(0, position), result[i]);
+  }
+
+  result.clear();
+  index.ScanKey(Tuple({Value(TypeId::VARCHAR, "ab")}, index.GetKeySchema()), &result, nullptr);
+  EXPECT_EQ(std::vector<RID>{RID(0, 2)}, result);
+}
+
+// NOLINTNEXTLINE
+TEST(ArtIndexTest, OptimizerTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(k int, v int);", noop_writer);
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 1000; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i % 100), Value(TypeId::INTEGER, i)}, &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  // the index is filled from the table heap when it is created
+  bustub->ExecuteSql("CREATE INDEX t_k_art ON t USING ART (k);", noop_writer);
+  auto *art_index = bustub->catalog_->GetIndex("t_k_art", "t");
+  ASSERT_NE(nullptr, art_index);
+  EXPECT_EQ(IndexType::ArtIndex, art_index->index_type_);
+  EXPECT_EQ(1000, art_index->index_->GetStats()->num_entries_);
+
+  // point lookups, ranges and orders are all served by the tree
+  std::stringstream explain;
+  auto explain_writer = SimpleStreamWriter(explain, true);
+  bustub->ExecuteSql("EXPLAIN SELECT * FROM t WHERE k = 42;", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("IndexScan { index_oid=0, range=[42, 42] }")) << explain.str();
+  explain.str("");
+  bustub->ExecuteSql("EXPLAIN SELECT * FROM t WHERE k > 42;", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("IndexScan { index_oid=0, range=(42, +inf] }")) << explain.str();
+  explain.str("");
+  bustub->ExecuteSql("EXPLAIN SELECT * FROM t ORDER BY k;", explain_writer);
+  auto optimized = explain.str().substr(explain.str().find("=== OPTIMIZER ==="));
+  EXPECT_NE(std::string::npos, optimized.find("IndexScan")) << optimized;
+  EXPECT_EQ(std::string::npos, optimized.find("Sort")) << optimized;
+
+  std::stringstream result;
+  auto result_writer = SimpleStreamWriter(result, true, ",");
+  bustub->ExecuteSql("SELECT * FROM t WHERE k = 42;", result_writer);
+  auto rows = result.str();
+  EXPECT_EQ(10, std::count(rows.begin(), rows.end(), '\n')) << rows;
+  result.str("");
+  bustub->ExecuteSql("SELECT * FROM t WHERE k >= 95 AND k < 98;", result_writer);
+  rows = result.str();
+  EXPECT_EQ(30, std::count(rows.begin(), rows.end(), '\n')) << rows;
+
+  // without a USING clause the index is still a B+ tree
+  bustub->ExecuteSql("CREATE INDEX t_v ON t(v);", noop_writer);
+  EXPECT_EQ(IndexType::BPlusTreeIndex, bustub->catalog_->GetIndex("t_v", "t")->index_type_);
+}
+
+// NOLINTNEXTLINE
+TEST(ArtIndexTest, LikePrefixTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE users(name varchar(16), v int);", noop_writer);
+  auto *table_info = bustub->catalog_->GetTable("users");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 300; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::VARCHAR, "user" + std::to_string(i)), Value(TypeId::INTEGER, i)},
+                &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX users_name ON users USING ART (name);", noop_writer);
+
+  // a LIKE prefix becomes a range of the tree
+  std::stringstream explain;
+  auto explain_writer = SimpleStreamWriter(explain, true);
+  bustub->ExecuteSql("EXPLAIN SELECT * FROM users WHERE name LIKE 'user12%';", explain_writer);
+  auto optimized = explain.str().substr(explain.str().find("=== OPTIMIZER ==="));
+  EXPECT_NE(std::string::npos, optimized.find("IndexScan")) << optimized;
+
+  std::stringstream result;
+  auto result_writer = SimpleStreamWriter(result, true, ",");
+  bustub->ExecuteSql("SELECT * FROM users WHERE name LIKE 'user12%';", result_writer);
+  auto rows = result.str();
+  // user12 and user120..user129
+  EXPECT_EQ(11, std::count(rows.begin(), rows.end(), '\n')) << rows;
+}
+
+}  // namespace bustub
@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_blink_test.cpp
+//
+// Identification: test/storage/b_plus_tree_blink_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BLinkTestTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using BLinkLeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using BLinkInternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+// Walk every level of the tree along the right links: each page's keys are below its high key, which is not above
+// the first key of the next page, and every level ends with a page that has no next page.
+// Returns the number of leaves.
+static auto CheckLinks(BufferPoolManager *bpm, page_id_t root_page_id) -> int {
+  int num_leaves = 0;
+  page_id_t first_page_id = root_page_id;
+  while (first_page_id != INVALID_PAGE_ID) {
+    page_id_t page_id = first_page_id;
+    first_page_id = INVALID_PAGE_ID;
+    std::optional<int64_t> prev_high_key;
+    while (page_id != INVALID_PAGE_ID) {
+      auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+      int64_t first_key;
+      int64_t last_key;
+      int64_t high_key;
+      if (page->IsLeafPage()) {
+        auto *leaf = reinterpret_cast<BLinkLeafPage *>(page);
+        first_key = leaf->KeyAt(0).ToString();
+        last_key = leaf->KeyAt(leaf->GetSize() - 1).ToString();
+        high_key = leaf->GetHighKey().ToString();
+        num_leaves++;
+      } else {
+        auto *internal = reinterpret_cast<BLinkInternalPage *>(page);
+        if (first_page_id == INVALID_PAGE_ID) {
+          first_page_id = internal->ValueAt(0);
+        }
+        // the first key of an internal page is ignored by searches
+        first_key = internal->KeyAt(1).ToString();
+        last_key = internal->KeyAt(internal->GetSize() - 1).ToString();
+        high_key = internal->GetHighKey().ToString();
+      }
+      if (prev_high_key.has_value()) {
+        EXPECT_LE(*prev_high_key, first_key);
+      }
+      prev_high_key = std::nullopt;
+      if (page->GetNextPageId() != INVALID_PAGE_ID) {
+        EXPECT_LT(last_key, high_key);
+        prev_high_key = high_key;
+      }
+      page_id_t next_page_id = page->GetNextPageId();
+      bpm->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+  }
+  return num_leaves;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBLinkTest, ConcurrentSplitTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(256, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  BLinkTestTree tree("foo_pk", bpm.get(), comparator, 3, 4);
+
+  // multiples of 4 are in the tree before the writers start and must stay visible to readers throughout
+  const int64_t num_keys = 2000;
+  for (int64_t key = 0; key < num_keys; key += 4) {
+    ASSERT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+  }
+
+  // every writer inserts its own residue class in random order, so splits run concurrently all over the tree
+  std::atomic<int> running_writers{3};
+  std::vector<std::thread> threads;
+  for (int64_t residue = 1; residue <= 3; residue++) {
+    threads.emplace_back([&, residue] {
+      std::vector<int64_t> keys;
+      for (int64_t key = residue; key < num_keys; key += 4) {
+        keys.push_back(key);
+      }
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(residue));
+      for (auto key : keys) {
+        EXPECT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+      }
+      running_writers--;
+    });
+  }
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&] {
+      std::vector<RID> result;
+      do {
+        for (int64_t key = 0; key < num_keys; key += 4) {
+          result.clear();
+          ASSERT_TRUE(tree.GetValue(MakeIntegerKey(key), &result)) << "lost key " << key;
+          ASSERT_EQ(key, result[0].GetSlotNum());
+        }
+      } while (running_writers > 0);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t expected = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    ASSERT_EQ(expected, (*it).first.ToString());
+    expected++;
+  }
+  EXPECT_EQ(num_keys, expected);
+  EXPECT_GT(CheckLinks(bpm.get(), tree.GetRootPageId()), 1);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBLinkTest, ConcurrentSplitMergeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(256, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  BLinkTestTree tree("foo_pk", bpm.get(), comparator, 4, 3);
+
+  // even keys stay; each writer inserts and removes its own odd keys, so merges interleave with splits
+  const int64_t num_keys = 1200;
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    ASSERT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+  }
+
+  std::atomic<int> running_writers{2};
+  std::vector<std::thread> threads;
+  for (int64_t residue = 1; residue <= 3; residue += 2) {
+    threads.emplace_back([&, residue] {
+      std::mt19937 gen(residue);
+      std::vector<int64_t> keys;
+      for (int64_t key = residue; key < num_keys; key += 4) {
+        keys.push_back(key);
+      }
+      for (int round = 0; round < 3; round++) {
+        std::shuffle(keys.begin(), keys.end(), gen);
+        for (auto key : keys) {
+          EXPECT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+        }
+        std::shuffle(keys.begin(), keys.end(), gen);
+        for (auto key : keys) {
+          tree.Remove(MakeIntegerKey(key));
+        }
+      }
+      running_writers--;
+    });
+  }
+  threads.emplace_back([&] {
+    std::vector<RID> result;
+    do {
+      for (int64_t key = 0; key < num_keys; key += 2) {
+        result.clear();
+        ASSERT_TRUE(tree.GetValue(MakeIntegerKey(key), &result)) << "lost key " << key;
+      }
+    } while (running_writers > 0);
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t expected = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    ASSERT_EQ(expected, (*it).first.ToString());
+    expected += 2;
+  }
+  EXPECT_EQ(num_keys, expected);
+  CheckLinks(bpm.get(), tree.GetRootPageId());
+}
+
+}  // namespace bustub
@@ -0,0 +1,245 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+// Check the structure below `page_id` and return its height; every non-root page must be at least half full, and
+// every page must link to `next_page_id` with the separator of that page as its high key.
+static auto CheckSubtree(BufferPoolManager *bpm, page_id_t page_id, bool is_root, page_id_t next_page_id,
+                         std::optional<int64_t> high_key) -> int {
+  auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  EXPECT_EQ(next_page_id, page->GetNextPageId());
+  if (!is_root) {
+    EXPECT_GE(page->GetSize(), page->GetMinSize());
+  }
+  int height = 1;
+  if (page->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page);
+    EXPECT_LT(leaf->GetSize(), leaf->GetMaxSize());
+    if (high_key.has_value()) {
+      EXPECT_EQ(*high_key, leaf->GetHighKey().ToString());
+      EXPECT_LT(leaf->KeyAt(leaf->GetSize() - 1).ToString(), *high_key);
+    }
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(page);
+    EXPECT_LE(internal->GetSize(), internal->GetMaxSize());
+    EXPECT_GE(internal->GetSize(), 2);
+    if (high_key.has_value()) {
+      EXPECT_EQ(*high_key, internal->GetHighKey().ToString());
+    }
+
+    // the last child links to the first child of the next page on this level
+    page_id_t last_child_next = INVALID_PAGE_ID;
+    if (next_page_id != INVALID_PAGE_ID) {
+      last_child_next = reinterpret_cast<InternalPage *>(bpm->FetchPage(next_page_id)->GetData())->ValueAt(0);
+      bpm->UnpinPage(next_page_id, false);
+    }
+    std::vector<int> heights;
+    for (int i = 0; i < internal->GetSize(); i++) {
+      bool is_last = i + 1 == internal->GetSize();
+      heights.push_back(
+          CheckSubtree(bpm, internal->ValueAt(i), false, is_last ? last_child_next : internal->ValueAt(i + 1),
+                       is_last ? high_key : std::optional<int64_t>(internal->KeyAt(i + 1).ToString())));
+    }
+    EXPECT_EQ(heights.front(), *std::min_element(heights.begin(), heights.end()));
+    EXPECT_EQ(heights.front(), *std::max_element(heights.begin(), heights.end()));
+    height += heights.front();
+  }
+  bpm->UnpinPage(page_id, false);
+  return height;
+}
+
+static void BulkLoadKeys(Tree *tree, const std::vector<int64_t> &keys, double fill_factor) {
+  size_t next = 0;
+  ASSERT_TRUE(tree->BulkLoad(
+      [&](std::pair<GenericKey<8>, RID> *entry) {
+        if (next == keys.size()) {
+          return false;
+        }
+        entry->first.SetFromInteger(keys[next]);
+        entry->second.Set(static_cast<int32_t>(keys[next] >> 32), static_cast<int32_t>(next));
+        next++;
+        return true;
+      },
+      fill_factor));
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, StructureTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto [leaf_max_size, internal_max_size] : std::vector<std::pair<int, int>>{{2, 3}, {3, 3}, {5, 4}, {16, 9}}) {
+    for (double fill_factor : {0.0, 0.7, 1.0}) {
+      for (int64_t num_keys : {0, 1, 2, 3, 7, 50, 333}) {
+        auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+        auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+        page_id_t header_page_id;
+        bpm->NewPage(&header_page_id);
+        bpm->UnpinPage(header_page_id, true);
+        Tree tree("foo_pk", bpm.get(), comparator, leaf_max_size, internal_max_size);
+
+        // sorted keys, every fifth one duplicated; only its first occurrence is kept
+        std::vector<int64_t> keys;
+        for (int64_t key = 0; key < num_keys; key++) {
+          keys.push_back(key * 2);
+          if (key % 5 == 0) {
+            keys.push_back(key * 2);
+          }
+        }
+        BulkLoadKeys(&tree, keys, fill_factor);
+        SCOPED_TRACE(testing::Message() << leaf_max_size << "/" << internal_max_size << " fill " << fill_factor
+                                        << " keys " << num_keys);
+
+        if (num_keys == 0) {
+          EXPECT_TRUE(tree.IsEmpty());
+          continue;
+        }
+        CheckSubtree(bpm.get(), tree.GetRootPageId(), true, INVALID_PAGE_ID, std::nullopt);
+
+        int64_t expected = 0;
+        for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+          EXPECT_EQ(expected * 2, (*it).first.ToString());
+          expected++;
+        }
+        EXPECT_EQ(num_keys, expected);
+
+        // a bulk-loaded tree keeps working as a regular tree
+        GenericKey<8> index_key;
+        std::vector<RID> result;
+        for (int64_t key = 0; key < num_keys; key++) {
+          index_key.SetFromInteger(key * 2 + 1);
+          EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key))));
+          index_key.SetFromInteger(key * 2);
+          result.clear();
+          EXPECT_TRUE(tree.GetValue(index_key, &result));
+        }
+        for (int64_t key = 0; key < num_keys; key++) {
+          index_key.SetFromInteger(key * 2);
+          tree.Remove(index_key);
+        }
+        // splits and merges keep the right links and high keys in place
+        CheckSubtree(bpm.get(), tree.GetRootPageId(), true, INVALID_PAGE_ID, std::nullopt);
+        expected = 0;
+        for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+          EXPECT_EQ(expected * 2 + 1, (*it).first.ToString());
+          expected++;
+        }
+        EXPECT_EQ(num_keys, expected);
+
+        // only an empty tree can be bulk loaded
+        EXPECT_FALSE(tree.BulkLoad([](std::pair<GenericKey<8>, RID> *entry) { return false; }));
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, ExternalSorterTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(10, disk_manager.get());
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 5000; key++) {
+    keys.push_back(key / 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  // one page of entries per run, so most of the input spills
+  ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(bpm.get(), comparator, 1);
+  for (size_t i = 0; i < keys.size(); i++) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(keys[i]);
+    sorter.Add(index_key, RID(0, static_cast<uint32_t>(i)));
+  }
+  EXPECT_GT(sorter.GetNumSpilledRuns(), 10);
+
+  std::pair<GenericKey<8>, RID> entry;
+  std::pair<GenericKey<8>, RID> prev;
+  size_t count = 0;
+  while (sorter.Next(&entry)) {
+    if (count > 0) {
+      ASSERT_LE(prev.first.ToString(), entry.first.ToString());
+      if (prev.first.ToString() == entry.first.ToString()) {
+        // equal keys keep their insertion order
+        ASSERT_LT(prev.second.GetSlotNum(), entry.second.GetSlotNum());
+      }
+    }
+    prev = entry;
+    count++;
+  }
+  EXPECT_EQ(keys.size(), count);
+
+  // all temporary pages have been released
+  for (int i = 0; i < 10; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, CreateIndexTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  Schema schema{{Column{"a", TypeId::BIGINT}, Column{"b", TypeId::INTEGER}}};
+  auto *table_info = catalog->CreateTable(txn.get(), "t", schema);
+  const int64_t num_rows = 3000;
+  for (int64_t i = 0; i < num_rows; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::BIGINT, (i * 7919) % num_rows), Value(TypeId::INTEGER, static_cast<int32_t>(i))},
+                &schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  Schema key_schema{{Column{"a", TypeId::BIGINT}}};
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn.get(), "t_a", "t", schema, key_schema, {0}, 8, HashFunction<GenericKey<8>>{});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  for (int64_t key = 0; key < num_rows; key++) {
+    std::vector<RID> result;
+    index_info->index_->ScanKey(Tuple({Value(TypeId::BIGINT, key)}, &key_schema), &result, txn.get());
+    ASSERT_EQ(1, result.size());
+    Tuple tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(result[0], &tuple, txn.get()));
+    EXPECT_EQ(key, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+  }
+}
+
+}  // namespace bustub
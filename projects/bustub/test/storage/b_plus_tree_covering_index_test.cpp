@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_covering_index_test.cpp
+//
+// Identification: test/storage/b_plus_tree_covering_index_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeCoveringIndexTest, IncludedColumnsTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  // table (k int, v bigint, w int), a non-unique index on k that includes w and v
+  Schema schema{{Column{"k", TypeId::INTEGER}, Column{"v", TypeId::BIGINT}, Column{"w", TypeId::INTEGER}}};
+  auto metadata = std::make_unique<IndexMetadata>("k_idx", "t", &schema, std::vector<uint32_t>{0}, false,
+                                                  std::vector<uint32_t>{2, 1});
+  ASSERT_EQ(12, metadata->GetPayloadSize());
+  BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>> index(std::move(metadata), bpm.get());
+  const auto *entry_schema = index.GetMetadata()->GetEntrySchema();
+
+  // every key appears twice, the included values differ between the copies
+  const int32_t num_keys = 200;
+  for (int copy = 0; copy < 2; copy++) {
+    for (int32_t key = 0; key < num_keys; key++) {
+      Tuple entry({Value(TypeId::INTEGER, key), Value(TypeId::INTEGER, -key - copy),
+                   Value(TypeId::BIGINT, int64_t{key} * 1000000000 + copy)},
+                  entry_schema);
+      index.InsertEntry(entry, RID(key, copy), nullptr);
+    }
+  }
+
+  // the payload is not part of the key: lookups and deletes only need the key columns and the RID
+  Schema key_schema{{Column{"k", TypeId::INTEGER}}};
+  std::vector<RID> rids;
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, 7)}, &key_schema), &rids, nullptr);
+  EXPECT_EQ((std::vector<RID>{RID(7, 0), RID(7, 1)}), rids);
+  index.DeleteEntry(Tuple({Value(TypeId::INTEGER, 7)}, &key_schema), RID(7, 0), nullptr);
+  rids.clear();
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, 7)}, &key_schema), &rids, nullptr);
+  EXPECT_EQ((std::vector<RID>{RID(7, 1)}), rids);
+
+  // a range scan hands out the included values with every entry
+  IndexRange range;
+  range.lower_ = Tuple({Value(TypeId::INTEGER, 100)}, &key_schema);
+  range.upper_ = Tuple({Value(TypeId::INTEGER, 149)}, &key_schema);
+  auto scan = index.ScanRange(range, nullptr);
+  std::vector<Tuple> entries;
+  rids.clear();
+  while (scan->NextBatch(&rids, &entries)) {
+  }
+  ASSERT_EQ(100, entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    int32_t key = 100 + i / 2;
+    int copy = i % 2;
+    EXPECT_EQ(RID(key, copy), rids[i]);
+    EXPECT_EQ(key, entries[i].GetValue(entry_schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(-key - copy, entries[i].GetValue(entry_schema, 1).GetAs<int32_t>());
+    EXPECT_EQ(int64_t{key} * 1000000000 + copy, entries[i].GetValue(entry_schema, 2).GetAs<int64_t>());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeCoveringIndexTest, IndexOnlyScanTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(k int, v int, w int);", noop_writer);
+
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 1000; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::INTEGER, i * 2), Value(TypeId::INTEGER, i * 3)},
+                &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_k ON t(k) WITH (include = 'v');", noop_writer);
+
+  auto explain = [&](const std::string &sql) {
+    std::stringstream result;
+    auto writer = SimpleStreamWriter(result, true);
+    bustub->ExecuteSql("EXPLAIN " + sql, writer);
+    return result.str();
+  };
+  // k and v are in the index, w is not
+  EXPECT_NE(std::string::npos, explain("SELECT v FROM t WHERE k BETWEEN 10 AND 20;").find("IndexOnlyScan"));
+  EXPECT_NE(std::string::npos, explain("SELECT k FROM t WHERE k < 20 AND v > 5;").find("IndexOnlyScan"));
+  EXPECT_EQ(std::string::npos, explain("SELECT w FROM t WHERE k BETWEEN 10 AND 20;").find("IndexOnlyScan"));
+  EXPECT_EQ(std::string::npos, explain("SELECT k FROM t WHERE k < 20 AND w > 5;").find("IndexOnlyScan"));
+
+  std::stringstream result;
+  auto result_writer = SimpleStreamWriter(result, true, ",");
+  bustub->ExecuteSql("SELECT v, k + 1 FROM t WHERE k >= 995 AND v < 1996;", result_writer);
+  EXPECT_EQ("1990,996,\n1992,997,\n1994,998,\n", result.str());
+}
+
+}  // namespace bustub
@@ -11,11 +11,14 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
 #include <random>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
 
@@ -199,4 +202,50 @@ TEST(BPlusTreeTests, InsertTest3) {
   remove("test.db");
   remove("test.log");
 }
+
+// Point lookups on full-size pages, with every page cached so that the time is spent searching within pages.
+TEST(BPlusTreeTests, DISABLED_PointLookupBenchmark) {  // NOLINT
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(1000, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_keys = 20000;
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  GenericKey<8> index_key;
+  RID rid;
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+  }
+
+  auto clock_start = std::chrono::steady_clock::now();
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start);
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "Point lookups: " << num_keys << ", ns per lookup: " << dur.count() / num_keys << std::endl;
+  std::cout << ">>> END" << std::endl;
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_multi_get_test.cpp
+//
+// Identification: test/storage/b_plus_tree_multi_get_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "execution/execution_engine.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using MultiGetTestTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeMultiGetTest, GetValuesTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  MultiGetTestTree tree("foo_pk", bpm.get(), comparator, 4, 5);
+
+  std::vector<std::vector<RID>> results;
+  tree.GetValues({MakeIntegerKey(1)}, &results);
+  ASSERT_EQ(1, results.size());
+  EXPECT_TRUE(results[0].empty());
+
+  // even keys 0..1998
+  for (int64_t key = 0; key < 2000; key += 2) {
+    ASSERT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+  }
+
+  // present and missing keys, repeated ones, neighbours in the same leaf and keys far apart
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int64_t> dist(-10, 2010);
+  std::vector<int64_t> keys{-5, 0, 0, 1, 2, 4, 6, 7, 1998, 1998, 1999, 3000};
+  for (int i = 0; i < 300; i++) {
+    keys.push_back(dist(gen));
+  }
+  std::sort(keys.begin(), keys.end());
+  std::vector<GenericKey<8>> sorted_keys;
+  for (auto key : keys) {
+    sorted_keys.push_back(MakeIntegerKey(key));
+  }
+  tree.GetValues(sorted_keys, &results);
+  ASSERT_EQ(keys.size(), results.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<RID> expected;
+    tree.GetValue(sorted_keys[i], &expected);
+    EXPECT_EQ(expected, results[i]) << "key " << keys[i];
+  }
+
+  // a matcher collects runs of entries that span several leaves: all keys of the same hundred
+  std::vector<GenericKey<8>> hundreds{MakeIntegerKey(0), MakeIntegerKey(500), MakeIntegerKey(1900)};
+  tree.GetValues(hundreds, &results, [](const GenericKey<8> &key, const GenericKey<8> &entry) {
+    return key.ToString() / 100 == entry.ToString() / 100;
+  });
+  for (size_t i = 0; i < hundreds.size(); i++) {
+    ASSERT_EQ(50, results[i].size());
+    for (int64_t j = 0; j < 50; j++) {
+      EXPECT_EQ(hundreds[i].ToString() + 2 * j, results[i][j].GetSlotNum());
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeMultiGetTest, ScanKeysTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  Schema schema{{Column{"k", TypeId::INTEGER}}};
+  auto metadata = std::make_unique<IndexMetadata>("k_idx", "t", &schema, std::vector<uint32_t>{0}, false);
+  BPlusTreeIndex<NonUniqueIntegerKeyType, RID, NonUniqueIntegerComparatorType> index(std::move(metadata), bpm.get());
+
+  // every multiple of 3 below 300 appears 20 times
+  for (int copy = 0; copy < 20; copy++) {
+    for (int32_t key = 0; key < 300; key += 3) {
+      index.InsertEntry(Tuple({Value(TypeId::INTEGER, key)}, &schema), RID(key, copy), nullptr);
+    }
+  }
+
+  // unsorted and repeated keys come back in the order they were asked for
+  std::vector<Tuple> keys;
+  for (int32_t key : {150, 3, 4, 297, 150, 0, 299, 90, 3}) {
+    keys.emplace_back(std::vector<Value>{Value(TypeId::INTEGER, key)}, &schema);
+  }
+  std::vector<std::vector<RID>> results;
+  index.ScanKeys(keys, &results, nullptr);
+  ASSERT_EQ(keys.size(), results.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<RID> expected;
+    index.ScanKey(keys[i], &expected, nullptr);
+    EXPECT_EQ(expected, results[i]) << "key " << keys[i].GetValue(&schema, 0).GetAs<int32_t>();
+  }
+  EXPECT_EQ(20, results[0].size());
+  EXPECT_TRUE(results[2].empty());
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeMultiGetTest, IndexJoinTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE outer_t(a int);", noop_writer);
+  bustub->ExecuteSql("CREATE TABLE inner_t(k int, v int);", noop_writer);
+
+  // outer keys 0..999, inner keys are the even numbers below 1200, twice each
+  auto *outer_info = bustub->catalog_->GetTable("outer_t");
+  auto *inner_info = bustub->catalog_->GetTable("inner_t");
+  auto txn = std::make_unique<Transaction>(0);
+  const int32_t num_outer = 1000;
+  RID rid;
+  for (int32_t i = 0; i < num_outer; i++) {
+    ASSERT_TRUE(outer_info->table_->InsertTuple(Tuple({Value(TypeId::INTEGER, i)}, &outer_info->schema_), &rid,
+                                                txn.get()));
+  }
+  for (int32_t copy = 0; copy < 2; copy++) {
+    for (int32_t k = 0; k < 1200; k += 2) {
+      Tuple tuple({Value(TypeId::INTEGER, k), Value(TypeId::INTEGER, copy)}, &inner_info->schema_);
+      ASSERT_TRUE(inner_info->table_->InsertTuple(tuple, &rid, txn.get()));
+    }
+  }
+  bustub->ExecuteSql("CREATE INDEX outer_a ON outer_t(a);", noop_writer);
+  bustub->ExecuteSql("CREATE INDEX inner_k ON inner_t(k);", noop_writer);
+  auto *inner_index = bustub->catalog_->GetIndex("inner_k", "inner_t");
+
+  // more outer tuples than one batch, read in key order through the outer index
+  std::vector<Column> columns = outer_info->schema_.GetColumns();
+  for (const auto &column : inner_info->schema_.GetColumns()) {
+    columns.push_back(column);
+  }
+  auto outer_scan = std::make_shared<IndexScanPlanNode>(std::make_shared<Schema>(outer_info->schema_),
+                                                        bustub->catalog_->GetIndex("outer_a", "outer_t")->index_oid_);
+  auto join = std::make_shared<NestedIndexJoinPlanNode>(
+      std::make_shared<Schema>(columns), outer_scan, std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER),
+      inner_info->oid_, inner_index->index_oid_, "inner_k", "inner_t", std::make_shared<Schema>(inner_info->schema_),
+      JoinType::LEFT);
+  ExecutorContext exec_ctx(txn.get(), bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                           bustub->lock_manager_);
+  std::vector<Tuple> result;
+  ASSERT_TRUE(bustub->execution_engine_->Execute(join, &result, txn.get(), &exec_ctx));
+
+  // even outer keys match both copies, odd ones are padded with NULLs
+  const auto &output_schema = join->OutputSchema();
+  size_t row = 0;
+  for (int32_t a = 0; a < num_outer; a++) {
+    int num_matches = a % 2 == 0 ? 2 : 1;
+    for (int match = 0; match < num_matches; match++) {
+      ASSERT_LT(row, result.size());
+      EXPECT_EQ(a, result[row].GetValue(&output_schema, 0).GetAs<int32_t>());
+      if (a % 2 == 0) {
+        EXPECT_EQ(a, result[row].GetValue(&output_schema, 1).GetAs<int32_t>());
+      } else {
+        EXPECT_TRUE(result[row].GetValue(&output_schema, 1).IsNull());
+      }
+      row++;
+    }
+  }
+  EXPECT_EQ(row, result.size());
+}
+
+}  // namespace bustub
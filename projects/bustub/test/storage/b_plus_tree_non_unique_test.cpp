@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_non_unique_test.cpp
+//
+// Identification: test/storage/b_plus_tree_non_unique_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeNonUniqueTest, DuplicateKeyTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  Schema schema{{Column{"status", TypeId::INTEGER}}};
+  auto metadata = std::make_unique<IndexMetadata>("status_idx", "t", &schema, std::vector<uint32_t>{0}, false);
+  BPlusTreeIndex<NonUniqueIntegerKeyType, RID, NonUniqueIntegerComparatorType> index(std::move(metadata), bpm.get());
+
+  // 4 distinct values, each with many RIDs inserted in random order
+  const int num_values = 4;
+  const int num_rids = 500;
+  std::vector<std::pair<int32_t, RID>> entries;
+  for (int32_t value = 0; value < num_values; value++) {
+    for (int i = 0; i < num_rids; i++) {
+      entries.emplace_back(value - 1, RID(i % 37, static_cast<uint32_t>(i)));
+    }
+  }
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(15445));
+  for (const auto &[value, rid] : entries) {
+    index.InsertEntry(Tuple({Value(TypeId::INTEGER, value)}, &schema), rid, nullptr);
+  }
+
+  for (int32_t value = -1; value < num_values - 1; value++) {
+    std::vector<RID> result;
+    index.ScanKey(Tuple({Value(TypeId::INTEGER, value)}, &schema), &result, nullptr);
+    ASSERT_EQ(num_rids, result.size());
+    // the matches come out in RID order
+    EXPECT_TRUE(std::is_sorted(result.begin(), result.end(), [](const RID &lhs, const RID &rhs) {
+      return std::make_pair(lhs.GetPageId(), lhs.GetSlotNum()) < std::make_pair(rhs.GetPageId(), rhs.GetSlotNum());
+    }));
+  }
+  std::vector<RID> result;
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, num_values)}, &schema), &result, nullptr);
+  EXPECT_TRUE(result.empty());
+
+  // deleting removes exactly the given (key, RID) entry
+  for (int i = 0; i < num_rids; i += 2) {
+    index.DeleteEntry(Tuple({Value(TypeId::INTEGER, 0)}, &schema), RID(i % 37, static_cast<uint32_t>(i)), nullptr);
+  }
+  result.clear();
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, 0)}, &schema), &result, nullptr);
+  ASSERT_EQ(num_rids / 2, result.size());
+  for (const auto &rid : result) {
+    EXPECT_EQ(1, rid.GetSlotNum() % 2);
+  }
+  result.clear();
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, 1)}, &schema), &result, nullptr);
+  EXPECT_EQ(num_rids, result.size());
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeNonUniqueTest, CreateIndexTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  Schema schema{{Column{"id", TypeId::INTEGER}, Column{"tenant_id", TypeId::INTEGER}}};
+  auto *table_info = catalog->CreateTable(txn.get(), "t", schema);
+  const int32_t num_rows = 2000;
+  const int32_t num_tenants = 3;
+  for (int32_t i = 0; i < num_rows; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::INTEGER, i % num_tenants)}, &schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  Schema key_schema{{Column{"tenant_id", TypeId::INTEGER}}};
+  auto *index_info = catalog->CreateIndex<NonUniqueIntegerKeyType, RID, NonUniqueIntegerComparatorType>(
+      txn.get(), "t_tenant", "t", schema, key_schema, {1}, NON_UNIQUE_INTEGER_SIZE,
+      NonUniqueIntegerHashFunctionType{}, false);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  size_t total = 0;
+  for (int32_t tenant = 0; tenant < num_tenants; tenant++) {
+    std::vector<RID> result;
+    index_info->index_->ScanKey(Tuple({Value(TypeId::INTEGER, tenant)}, &key_schema), &result, txn.get());
+    for (const auto &rid : result) {
+      Tuple tuple;
+      ASSERT_TRUE(table_info->table_->GetTuple(rid, &tuple, txn.get()));
+      EXPECT_EQ(tenant, tuple.GetValue(&schema, 1).GetAs<int32_t>());
+    }
+    total += result.size();
+  }
+  EXPECT_EQ(num_rows, total);
+}
+
+}  // namespace bustub
@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_page_test.cpp
+//
+// Identification: test/storage/b_plus_tree_page_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+// NOLINTNEXTLINE
+TEST(BPlusTreePageTest, DecreaseSizeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  alignas(8) char data[BUSTUB_PAGE_SIZE]{};
+  auto *leaf = reinterpret_cast<LeafPage *>(data);
+  leaf->Init(1, 10);
+
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= 5; key++) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(leaf->InsertByKey(index_key, RID(0, key), comparator));
+  }
+  EXPECT_EQ(5, leaf->GetSize());
+
+  // removing shrinks the page rather than growing it
+  index_key.SetFromInteger(3);
+  ASSERT_TRUE(leaf->RemoveByKey(index_key, comparator));
+  EXPECT_EQ(4, leaf->GetSize());
+  leaf->DecreaseSize(2);
+  EXPECT_EQ(2, leaf->GetSize());
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreePageTest, InsertByIndexTest) {
+  alignas(8) char data[BUSTUB_PAGE_SIZE]{};
+  auto *internal = reinterpret_cast<InternalPage *>(data);
+  internal->Init(1, 10);
+
+  GenericKey<8> index_key;
+  for (int64_t key : {0, 10, 30}) {
+    index_key.SetFromInteger(key);
+    internal->InsertByIndex(internal->GetSize(), index_key, static_cast<page_id_t>(key + 100));
+  }
+
+  // inserting into the middle shifts the later entries instead of overwriting one
+  index_key.SetFromInteger(20);
+  internal->InsertByIndex(2, index_key, 120);
+  ASSERT_EQ(4, internal->GetSize());
+  std::vector<page_id_t> children;
+  for (int i = 0; i < internal->GetSize(); i++) {
+    children.push_back(internal->ValueAt(i));
+  }
+  EXPECT_EQ((std::vector<page_id_t>{100, 110, 120, 130}), children);
+  GenericKey<8> expected;
+  expected.SetFromInteger(30);
+  EXPECT_EQ(0, memcmp(expected.data_, internal->KeyAt(3).data_, sizeof(expected.data_)));
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreePageTest, MergeSeparatorTest) {
+  alignas(8) char left_data[BUSTUB_PAGE_SIZE]{};
+  alignas(8) char right_data[BUSTUB_PAGE_SIZE]{};
+  auto *left = reinterpret_cast<InternalPage *>(left_data);
+  auto *right = reinterpret_cast<InternalPage *>(right_data);
+  left->Init(1, 10);
+  right->Init(2, 10);
+
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(0);
+  left->InsertByIndex(0, index_key, 100);
+  index_key.SetFromInteger(10);
+  left->InsertByIndex(1, index_key, 110);
+  // the right page's first key is a filler, here the first key of its leftmost subtree
+  index_key.SetFromInteger(25);
+  right->InsertByIndex(0, index_key, 120);
+  index_key.SetFromInteger(30);
+  right->InsertByIndex(1, index_key, 130);
+
+  // the separator pulled down from the parent, not the filler, keys the moved leftmost child
+  GenericKey<8> separator;
+  separator.SetFromInteger(20);
+  right->MoveAllDataTo(left, separator);
+  ASSERT_EQ(4, left->GetSize());
+  EXPECT_EQ(0, right->GetSize());
+  EXPECT_EQ(120, left->ValueAt(2));
+  EXPECT_EQ(0, memcmp(separator.data_, left->KeyAt(2).data_, sizeof(separator.data_)));
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreePageTest, RootTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  auto root = [&]() {
+    auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(tree.GetRootPageId())->GetData());
+    bpm->UnpinPage(page->GetPageId(), false);
+    return page;
+  };
+
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= 3; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key), transaction);
+  }
+  // the first split makes a root with two children
+  ASSERT_FALSE(root()->IsLeafPage());
+  EXPECT_EQ(2, root()->GetSize());
+
+  for (int64_t key = 4; key <= 20; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key), transaction);
+  }
+  // underfull pages below the root merge, whatever their size, until a single leaf is left as the root
+  for (int64_t key = 20; key >= 2; key--) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(root()->IsLeafPage());
+  EXPECT_EQ(1, root()->GetSize());
+  std::vector<RID> rids;
+  index_key.SetFromInteger(1);
+  EXPECT_TRUE(tree.GetValue(index_key, &rids));
+
+  tree.Remove(index_key, transaction);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,425 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_range_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_range_scan_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "execution/execution_engine.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using RangeTestTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, BoundsTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  RangeTestTree tree("foo_pk", bpm.get(), comparator, 4, 5);
+
+  // keys 0, 3, 6, ..., 297
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 300; key += 3) {
+    keys.push_back(key);
+    ASSERT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+  }
+
+  auto expect_range = [&](std::optional<int64_t> lower, bool lower_inclusive, std::optional<int64_t> upper,
+                          bool upper_inclusive) {
+    std::vector<int64_t> expected;
+    for (auto key : keys) {
+      bool above = !lower.has_value() || key > *lower || (lower_inclusive && key == *lower);
+      bool below = !upper.has_value() || key < *upper || (upper_inclusive && key == *upper);
+      if (above && below) {
+        expected.push_back(key);
+      }
+    }
+    KeyRange<GenericKey<8>> range;
+    if (lower.has_value()) {
+      range.lower_ = MakeIntegerKey(*lower);
+    }
+    range.lower_inclusive_ = lower_inclusive;
+    if (upper.has_value()) {
+      range.upper_ = MakeIntegerKey(*upper);
+    }
+    range.upper_inclusive_ = upper_inclusive;
+    EXPECT_EQ(expected, CollectKeys(tree.Begin(range)));
+    std::reverse(expected.begin(), expected.end());
+    EXPECT_EQ(expected, CollectKeys(tree.Begin(range, true)));
+  };
+
+  // bounds on and between keys, inclusive and exclusive, open on either side, empty and out of range
+  for (bool lower_inclusive : {true, false}) {
+    for (bool upper_inclusive : {true, false}) {
+      expect_range(30, lower_inclusive, 60, upper_inclusive);
+      expect_range(31, lower_inclusive, 59, upper_inclusive);
+      expect_range(std::nullopt, lower_inclusive, 100, upper_inclusive);
+      expect_range(200, lower_inclusive, std::nullopt, upper_inclusive);
+      expect_range(45, lower_inclusive, 45, upper_inclusive);
+      expect_range(50, lower_inclusive, 40, upper_inclusive);
+      expect_range(-10, lower_inclusive, 1000, upper_inclusive);
+      expect_range(500, lower_inclusive, 1000, upper_inclusive);
+    }
+  }
+
+  // the leaves after the first one of a forward scan are handed out for prefetching, up to the upper bound
+  KeyRange<GenericKey<8>> range;
+  range.lower_ = MakeIntegerKey(0);
+  std::vector<page_id_t> upcoming;
+  EXPECT_EQ(keys, CollectKeys(tree.Begin(range, false, &upcoming)));
+  EXPECT_FALSE(upcoming.empty());
+  EXPECT_LE(upcoming.size(), INDEX_PREFETCH_LEAVES);
+  range.upper_ = MakeIntegerKey(0);
+  upcoming.clear();
+  EXPECT_EQ(std::vector<int64_t>{0}, CollectKeys(tree.Begin(range, false, &upcoming)));
+  EXPECT_TRUE(upcoming.empty());
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, PartitionRangeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  RangeTestTree tree("foo_pk", bpm.get(), comparator, 4, 5);
+
+  KeyRange<GenericKey<8>> everything;
+  EXPECT_EQ(1, tree.PartitionRange(everything, 4).size());
+  for (int64_t key = 0; key < 3000; key++) {
+    ASSERT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+  }
+
+  auto check_partitions = [&](const KeyRange<GenericKey<8>> &range, size_t num_partitions) -> size_t {
+    auto partitions = tree.PartitionRange(range, num_partitions);
+    EXPECT_GE(num_partitions, partitions.size());
+    // consecutive sub-ranges meet at a key that belongs to the right one, the outer bounds are those of the range
+    EXPECT_EQ(range.lower_.has_value(), partitions.front().lower_.has_value());
+    EXPECT_EQ(range.upper_.has_value(), partitions.back().upper_.has_value());
+    for (size_t i = 0; i + 1 < partitions.size(); i++) {
+      bool bounded = partitions[i].upper_.has_value() && partitions[i + 1].lower_.has_value();
+      EXPECT_TRUE(bounded);
+      if (bounded) {
+        EXPECT_EQ(partitions[i].upper_->ToString(), partitions[i + 1].lower_->ToString());
+      }
+      EXPECT_FALSE(partitions[i].upper_inclusive_);
+      EXPECT_TRUE(partitions[i + 1].lower_inclusive_);
+    }
+    std::vector<int64_t> keys;
+    for (const auto &partition : partitions) {
+      auto partition_keys = CollectKeys(tree.Begin(partition));
+      EXPECT_FALSE(partition_keys.empty());
+      keys.insert(keys.end(), partition_keys.begin(), partition_keys.end());
+    }
+    EXPECT_EQ(CollectKeys(tree.Begin(range)), keys);
+    return partitions.size();
+  };
+
+  EXPECT_EQ(4, check_partitions(everything, 4));
+  EXPECT_EQ(16, check_partitions(everything, 16));
+  KeyRange<GenericKey<8>> range;
+  range.lower_ = MakeIntegerKey(100);
+  range.lower_inclusive_ = false;
+  range.upper_ = MakeIntegerKey(2000);
+  EXPECT_EQ(4, check_partitions(range, 4));
+  EXPECT_EQ(1, check_partitions(range, 1));
+
+  // a range over a few leaves is not worth splitting
+  range.lower_ = MakeIntegerKey(500);
+  range.upper_ = MakeIntegerKey(510);
+  EXPECT_EQ(1, check_partitions(range, 4));
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, IndexScanRangeTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  Schema schema{{Column{"k", TypeId::INTEGER}}};
+  auto metadata = std::make_unique<IndexMetadata>("k_idx", "t", &schema, std::vector<uint32_t>{0}, false);
+  BPlusTreeIndex<NonUniqueIntegerKeyType, RID, NonUniqueIntegerComparatorType> index(std::move(metadata), bpm.get());
+
+  // every key 0..99 appears 30 times, more than one batch of entries in total
+  const int num_keys = 100;
+  const int num_copies = 30;
+  for (int copy = 0; copy < num_copies; copy++) {
+    for (int32_t key = 0; key < num_keys; key++) {
+      index.InsertEntry(Tuple({Value(TypeId::INTEGER, key)}, &schema), RID(key, copy), nullptr);
+    }
+  }
+
+  auto scan = [&](int32_t lower, bool lower_inclusive, int32_t upper, bool upper_inclusive, bool reverse) {
+    IndexRange range;
+    range.lower_ = Tuple({Value(TypeId::INTEGER, lower)}, &schema);
+    range.lower_inclusive_ = lower_inclusive;
+    range.upper_ = Tuple({Value(TypeId::INTEGER, upper)}, &schema);
+    range.upper_inclusive_ = upper_inclusive;
+    range.reverse_ = reverse;
+    auto range_scan = index.ScanRange(range, nullptr);
+    std::vector<RID> rids;
+    while (range_scan->NextBatch(&rids)) {
+    }
+    return rids;
+  };
+
+  // all duplicates of an inclusive bound are in the range, none of an exclusive one
+  auto rids = scan(10, true, 60, false, false);
+  ASSERT_EQ(50 * num_copies, rids.size());
+  for (size_t i = 0; i < rids.size(); i++) {
+    EXPECT_EQ(RID(static_cast<page_id_t>(10 + i / num_copies), i % num_copies), rids[i]);
+  }
+  rids = scan(10, false, 60, true, true);
+  ASSERT_EQ(50 * num_copies, rids.size());
+  EXPECT_EQ(RID(60, num_copies - 1), rids.front());
+  EXPECT_EQ(RID(11, 0), rids.back());
+  EXPECT_TRUE(scan(20, false, 20, true, false).empty());
+
+  // a scan abandoned after its first batch leaves no page pinned, prefetched or not
+  {
+    IndexRange range;
+    range.lower_ = Tuple({Value(TypeId::INTEGER, 0)}, &schema);
+    auto range_scan = index.ScanRange(range, nullptr);
+    std::vector<RID> rids;
+    ASSERT_TRUE(range_scan->NextBatch(&rids));
+    EXPECT_EQ(INDEX_SCAN_BATCH_SIZE, rids.size());
+  }
+  std::vector<page_id_t> page_ids(bpm->GetPoolSize());
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  for (auto page_id : page_ids) {
+    bpm->UnpinPage(page_id, false);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, IndexScanExecutorTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(k int, v int);", noop_writer);
+
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 1000; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, (i * 7) % 1000), Value(TypeId::INTEGER, i)}, &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_k ON t(k);", noop_writer);
+
+  std::stringstream explain;
+  auto explain_writer = SimpleStreamWriter(explain, true);
+  bustub->ExecuteSql("EXPLAIN SELECT k FROM t WHERE k BETWEEN 10 AND 20 AND v > 5;", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("IndexScan { index_oid=0, range=[10, 20] }")) << explain.str();
+
+  std::stringstream result;
+  auto result_writer = SimpleStreamWriter(result, true, ",");
+  bustub->ExecuteSql("SELECT k FROM t WHERE k > 990 AND 995 >= k;", result_writer);
+  EXPECT_EQ("991,\n992,\n993,\n994,\n995,\n", result.str());
+
+  // the sort is folded into a reverse scan of the range
+  result.str("");
+  bustub->ExecuteSql("SELECT * FROM t WHERE k BETWEEN 3 AND 6 ORDER BY k DESC;", result_writer);
+  EXPECT_EQ("6,858,\n5,715,\n4,572,\n3,429,\n", result.str());
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, ParallelIndexScanTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(k int, v int);", noop_writer);
+
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  const int32_t num_rows = 5000;
+  for (int32_t i = 0; i < num_rows; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, (i * 7) % num_rows), Value(TypeId::INTEGER, i)}, &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_k ON t(k);", noop_writer);
+
+  std::stringstream explain;
+  auto explain_writer = SimpleStreamWriter(explain, true);
+  bustub->ExecuteSql("EXPLAIN SELECT COUNT(*) FROM t WHERE k BETWEEN 10 AND 5000;", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("IndexOnlyScan { index_oid=0, range=[10, 5000], parallel=4 }"))
+      << explain.str();
+
+  // the sub-ranges are scanned concurrently but their tuples come out in key order, none missing
+  auto index_scan = std::make_shared<IndexScanPlanNode>(
+      std::make_shared<Schema>(table_info->schema_), 0, false,
+      std::make_shared<ConstantValueExpression>(Value(TypeId::INTEGER, 10)), true,
+      std::make_shared<ConstantValueExpression>(Value(TypeId::INTEGER, num_rows - 10)), false);
+  index_scan->parallelism_ = 4;
+  ExecutorContext exec_ctx(txn.get(), bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                           bustub->lock_manager_);
+  std::vector<Tuple> result;
+  ASSERT_TRUE(bustub->execution_engine_->Execute(index_scan, &result, txn.get(), &exec_ctx));
+  ASSERT_EQ(num_rows - 20, result.size());
+  for (int32_t i = 0; i < num_rows - 20; i++) {
+    ASSERT_EQ(10 + i, result[i].GetValue(&table_info->schema_, 0).GetAs<int32_t>());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, LikePrefixTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(name varchar(16), v int);", noop_writer);
+
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  std::vector<std::string> names{"us", "admin", "a_b", "axb"};
+  for (int32_t i = 0; i < 200; i++) {
+    names.push_back("user" + std::to_string(i));
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::VARCHAR, names[i]), Value(TypeId::INTEGER, static_cast<int32_t>(i))},
+                &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_name ON t(name);", noop_writer);
+
+  auto optimized_plan = [&](const std::string &predicate) {
+    std::stringstream explain;
+    auto explain_writer = SimpleStreamWriter(explain, true);
+    bustub->ExecuteSql("EXPLAIN SELECT * FROM t WHERE " + predicate + ";", explain_writer);
+    return explain.str().substr(explain.str().find("=== OPTIMIZER ==="));
+  };
+  auto count_rows = [&](const std::string &predicate) {
+    std::stringstream result;
+    auto result_writer = SimpleStreamWriter(result, true, ",");
+    bustub->ExecuteSql("SELECT name FROM t WHERE " + predicate + ";", result_writer);
+    return std::count(std::istreambuf_iterator<char>(result), std::istreambuf_iterator<char>(), '\n');
+  };
+
+  // a pattern that is a literal prefix followed by % is answered by the index range alone
+  std::string plan = optimized_plan("name LIKE 'user1%'");
+  EXPECT_NE(std::string::npos, plan.find("IndexScan { index_oid=0, range=[user1, user2) }")) << plan;
+  EXPECT_EQ(std::string::npos, plan.find("Filter")) << plan;
+  EXPECT_EQ(111, count_rows("name LIKE 'user1%'"));
+
+  // other wildcards after the prefix are still checked by a filter over the range
+  plan = optimized_plan("name LIKE 'user1_'");
+  EXPECT_NE(std::string::npos, plan.find("IndexScan { index_oid=0, range=[user1, user2) }")) << plan;
+  EXPECT_NE(std::string::npos, plan.find("Filter { predicate=(#0.0 LIKE user1_) }")) << plan;
+  EXPECT_EQ(10, count_rows("name LIKE 'user1_'"));
+  EXPECT_EQ(10, count_rows("name LIKE 'user1_%' AND v < 30"));
+
+  // without wildcards the pattern is an equality, an escaped wildcard is a literal character
+  plan = optimized_plan("name LIKE 'us'");
+  EXPECT_NE(std::string::npos, plan.find("IndexScan { index_oid=0, range=[us, us] }")) << plan;
+  EXPECT_EQ(1, count_rows("name LIKE 'us'"));
+  EXPECT_EQ(1, count_rows("name LIKE 'a\\_b%'"));
+  EXPECT_EQ(2, count_rows("name LIKE 'a_b%'"));
+
+  // patterns without a literal prefix and NOT LIKE need the whole table
+  EXPECT_EQ(std::string::npos, optimized_plan("name LIKE '%9'").find("IndexScan"));
+  EXPECT_EQ(std::string::npos, optimized_plan("name NOT LIKE 'user%'").find("IndexScan"));
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, NullKeyTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(k int, name varchar(16));", noop_writer);
+
+  // every third row has NULL keys, which the index sorts before all values
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 30; i++) {
+    RID rid;
+    bool null_key = i % 3 == 0;
+    Tuple tuple({null_key ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : Value(TypeId::INTEGER, i),
+                 null_key ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                          : Value(TypeId::VARCHAR, "n" + std::to_string(i))},
+                &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_k ON t(k);", noop_writer);
+  bustub->ExecuteSql("CREATE INDEX t_name ON t USING ART (name);", noop_writer);
+
+  auto query = [&](const std::string &sql) {
+    std::stringstream result;
+    auto result_writer = SimpleStreamWriter(result, true, ",");
+    bustub->ExecuteSql(sql, result_writer);
+    return result.str();
+  };
+
+  // a range open below starts after the NULL keys, in both scan directions and in both kinds of tree
+  EXPECT_NE(std::string::npos, query("EXPLAIN SELECT * FROM t WHERE k < 5;").find("range=(integer_null, 5)"));
+  EXPECT_EQ("1,n1,\n2,n2,\n4,n4,\n", query("SELECT * FROM t WHERE k < 5;"));
+  EXPECT_EQ("5,n5,\n4,n4,\n2,n2,\n1,n1,\n", query("SELECT * FROM t WHERE k <= 5 ORDER BY k DESC;"));
+  EXPECT_EQ("1,n1,\n10,n10,\n", query("SELECT * FROM t WHERE name < 'n11';"));
+
+  // a comparison with NULL holds for no row, so it never becomes a range
+  EXPECT_EQ(std::string::npos, query("EXPLAIN SELECT * FROM t WHERE k = NULL;").find("IndexScan"));
+  EXPECT_EQ("", query("SELECT * FROM t WHERE k < 5 AND k = NULL;"));
+}
+
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, ConstantCastTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(k int, v int);", noop_writer);
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 10; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::INTEGER, i * 10)}, &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_k ON t(k);", noop_writer);
+
+  auto query = [&](const std::string &sql) {
+    std::stringstream result;
+    auto result_writer = SimpleStreamWriter(result, true, ",");
+    bustub->ExecuteSql(sql, result_writer);
+    return result.str();
+  };
+
+  // a constant that casts to the key type exactly becomes a bound
+  EXPECT_NE(std::string::npos, query("EXPLAIN SELECT * FROM t WHERE k = '5';").find("IndexScan"));
+  EXPECT_EQ("5,50,\n", query("SELECT * FROM t WHERE k = '5';"));
+
+  // one the key type cannot hold stays with the filter rather than failing the scan
+  EXPECT_EQ(std::string::npos, query("EXPLAIN SELECT * FROM t WHERE k < '99999999999';").find("IndexScan"));
+  EXPECT_EQ(std::string::npos, query("EXPLAIN SELECT * FROM t WHERE k = 'abc';").find("IndexScan"));
+  EXPECT_EQ(std::string::npos, query("EXPLAIN SELECT * FROM t WHERE k = '05';").find("IndexScan"));
+}
+
+}  // namespace bustub
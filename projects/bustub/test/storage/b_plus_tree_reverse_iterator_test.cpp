@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_reverse_iterator_test.cpp
+//
+// Identification: test/storage/b_plus_tree_reverse_iterator_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using ReverseTestTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeReverseIteratorTest, ReverseScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  ReverseTestTree tree("foo_pk", bpm.get(), comparator, 4, 5);
+
+  EXPECT_TRUE(tree.RBegin().IsEnd());
+  EXPECT_TRUE(tree.RBegin(MakeIntegerKey(1)).IsEnd());
+
+  // even keys 0..398, inserted in random order so that leaves split everywhere
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 400; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    ASSERT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+  }
+
+  // remove every fourth key so that leaves also merge
+  std::vector<int64_t> expected;
+  for (int64_t key = 398; key >= 0; key -= 2) {
+    if (key % 8 == 0) {
+      tree.Remove(MakeIntegerKey(key));
+    } else {
+      expected.push_back(key);
+    }
+  }
+  EXPECT_EQ(expected, CollectKeys(tree.RBegin()));
+
+  // start at an existing key, between two keys, above and below all keys
+  auto from = [&](int64_t key) {
+    std::vector<int64_t> result;
+    std::copy_if(expected.begin(), expected.end(), std::back_inserter(result), [key](int64_t k) { return k <= key; });
+    return result;
+  };
+  for (int64_t key : {-1, 0, 1, 2, 7, 8, 9, 10, 101, 202, 397, 398, 1000}) {
+    EXPECT_EQ(from(key), CollectKeys(tree.RBegin(MakeIntegerKey(key)))) << "start key " << key;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeReverseIteratorTest, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(50, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  ReverseTestTree tree("foo_pk", bpm.get(), comparator, 6, 5);
+
+  const int64_t num_keys = 1000;
+  int64_t next_key = 0;
+  ASSERT_TRUE(tree.BulkLoad([&](std::pair<GenericKey<8>, RID> *entry) {
+    if (next_key == num_keys) {
+      return false;
+    }
+    *entry = {MakeIntegerKey(next_key), RID(0, next_key)};
+    next_key++;
+    return true;
+  }));
+
+  auto keys = CollectKeys(tree.RBegin());
+  ASSERT_EQ(num_keys, keys.size());
+  for (int64_t i = 0; i < num_keys; i++) {
+    EXPECT_EQ(num_keys - 1 - i, keys[i]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeReverseIteratorTest, ConcurrentTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  ReverseTestTree tree("foo_pk", bpm.get(), comparator, 4, 5);
+
+  // even keys stay in the tree, odd keys come and go while readers scan backwards
+  const int64_t num_keys = 600;
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    ASSERT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+  }
+
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    std::mt19937 gen(15445);
+    for (int round = 0; round < 4; round++) {
+      std::vector<int64_t> odd_keys;
+      for (int64_t key = 1; key < num_keys; key += 2) {
+        odd_keys.push_back(key);
+      }
+      std::shuffle(odd_keys.begin(), odd_keys.end(), gen);
+      auto txn = std::make_unique<Transaction>(0);
+      for (auto key : odd_keys) {
+        tree.Insert(MakeIntegerKey(key), RID(0, key), txn.get());
+      }
+      std::shuffle(odd_keys.begin(), odd_keys.end(), gen);
+      for (auto key : odd_keys) {
+        tree.Remove(MakeIntegerKey(key), txn.get());
+      }
+    }
+    done = true;
+  });
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back([&] {
+      do {
+        auto keys = CollectKeys(tree.RBegin());
+        // strictly descending, and no stable key is ever skipped
+        ASSERT_TRUE(std::adjacent_find(keys.begin(), keys.end(), std::less_equal<>()) == keys.end());
+        std::vector<int64_t> even_keys;
+        std::copy_if(keys.begin(), keys.end(), std::back_inserter(even_keys), [](int64_t k) { return k % 2 == 0; });
+        ASSERT_EQ(num_keys / 2, even_keys.size());
+      } while (!done);
+    });
+  }
+
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  auto keys = CollectKeys(tree.RBegin());
+  ASSERT_EQ(num_keys / 2, keys.size());
+  EXPECT_EQ(num_keys - 2, keys.front());
+  EXPECT_EQ(0, keys.back());
+}
+
+}  // namespace bustub
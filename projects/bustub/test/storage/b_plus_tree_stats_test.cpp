@@ -0,0 +1,172 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_stats_test.cpp
+//
+// Identification: test/storage/b_plus_tree_stats_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeStatsTest, StructureTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm.get(), comparator, 4, 4);
+
+  BPlusTreeStats stats = tree.GetStats();
+  EXPECT_EQ(0, stats.height_);
+  EXPECT_TRUE(stats.pages_per_level_.empty());
+
+  ASSERT_TRUE(tree.Insert(MakeIntegerKey(0), RID(0, 0)));
+  stats = tree.GetStats();
+  EXPECT_EQ(1, stats.height_);
+  EXPECT_EQ(std::vector<size_t>{1}, stats.pages_per_level_);
+  EXPECT_DOUBLE_EQ(0.25, stats.leaf_fill_);
+
+  // ascending inserts split every leaf once it is full, leaving the leaves behind it half full
+  const int64_t num_keys = 200;
+  for (int64_t key = 1; key < num_keys; key++) {
+    ASSERT_TRUE(tree.Insert(MakeIntegerKey(key), RID(0, key)));
+  }
+  // a duplicate key is not counted
+  EXPECT_FALSE(tree.Insert(MakeIntegerKey(0), RID(0, 0)));
+  stats = tree.GetStats();
+  EXPECT_EQ(num_keys, stats.num_entries_);
+  EXPECT_EQ(num_keys, tree.GetNumEntries());
+  ASSERT_EQ(stats.height_, stats.pages_per_level_.size());
+  EXPECT_GE(stats.height_, 4);
+  EXPECT_EQ(1, stats.pages_per_level_.front());
+  EXPECT_EQ(stats.num_leaf_pages_, stats.pages_per_level_.back());
+  EXPECT_EQ(stats.num_leaf_pages_ + stats.num_internal_pages_,
+            std::accumulate(stats.pages_per_level_.begin(), stats.pages_per_level_.end(), size_t{0}));
+  // every page of a level but the root is a child of a page on the level above
+  for (size_t level = 1; level < stats.pages_per_level_.size(); level++) {
+    EXPECT_LT(stats.pages_per_level_[level - 1], stats.pages_per_level_[level]);
+  }
+  EXPECT_EQ(stats.num_leaf_pages_ + stats.num_internal_pages_ - 1, stats.num_children_);
+  EXPECT_EQ(stats.num_leaf_pages_ - 1, stats.num_leaf_splits_);
+  // the other internal pages were each added as a new root
+  EXPECT_EQ(stats.num_internal_pages_ - (stats.height_ - 1), stats.num_internal_splits_);
+  EXPECT_DOUBLE_EQ(static_cast<double>(num_keys) / stats.num_leaf_pages_, stats.AverageLeafEntries());
+  EXPECT_GT(stats.leaf_fill_, 0.4);
+  EXPECT_LE(stats.leaf_fill_, 1.0);
+  EXPECT_EQ(0, stats.num_merges_);
+  EXPECT_EQ(0, stats.num_redistributions_);
+
+  // removing most keys shrinks the tree again; a missing key is not counted
+  for (int64_t key = 0; key < num_keys; key++) {
+    if (key % 8 != 0) {
+      tree.Remove(MakeIntegerKey(key));
+    }
+  }
+  tree.Remove(MakeIntegerKey(num_keys));
+  BPlusTreeStats shrunk_stats = tree.GetStats();
+  EXPECT_EQ(num_keys / 8, shrunk_stats.num_entries_);
+  EXPECT_EQ(num_keys / 8, tree.GetNumEntries());
+  EXPECT_LT(shrunk_stats.num_leaf_pages_, stats.num_leaf_pages_);
+  EXPECT_LE(shrunk_stats.height_, stats.height_);
+  EXPECT_GT(shrunk_stats.num_merges_, 0);
+  EXPECT_GT(shrunk_stats.num_redistributions_, 0);
+  EXPECT_EQ(stats.num_leaf_splits_, shrunk_stats.num_leaf_splits_);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeStatsTest, DisplayIndicesTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(a int, b varchar(40));", noop_writer);
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 1000; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, "row-" + std::to_string(i))}, &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_a ON t(a);", noop_writer);
+  bustub->ExecuteSql("CREATE INDEX t_b ON t(b);", noop_writer);
+
+  for (const auto *index_info : bustub->catalog_->GetTableIndexes("t")) {
+    auto stats = index_info->index_->GetStats();
+    ASSERT_TRUE(stats.has_value()) << index_info->name_;
+    EXPECT_EQ(1000, stats->num_entries_);
+    EXPECT_EQ(stats->height_, stats->pages_per_level_.size());
+    EXPECT_GT(stats->keys_per_leaf_, 1);
+    EXPECT_GT(stats->fill_factor_, 0);
+    EXPECT_EQ(1000, index_info->index_->GetNumEntries());
+  }
+  bustub->ExecuteSql("CREATE INDEX t_hash ON t USING HASH (a);", noop_writer);
+  bustub->ExecuteSql("CREATE INDEX t_art ON t USING ART (b);", noop_writer);
+
+  // one row per index, with its statistics after the key columns
+  std::stringstream result;
+  auto writer = SimpleStreamWriter(result, true, ",");
+  bustub->ExecuteSql("\\di", writer);
+  auto t_a_stats = *bustub->catalog_->GetIndex("t_a", "t")->index_->GetStats();
+  std::string pages_per_level;
+  for (auto pages : t_a_stats.pages_per_level_) {
+    pages_per_level += (pages_per_level.empty() ? "" : "/") + std::to_string(pages);
+  }
+  auto row = result.str().substr(result.str().find("t_a,"));
+  EXPECT_NE(std::string::npos, row.find("," + std::to_string(t_a_stats.height_) + "," + pages_per_level + ",1000,"))
+      << result.str();
+  EXPECT_NE(std::string::npos, result.str().find("t_b,")) << result.str();
+  // a hash index keeps no statistics, and only the number of entries applies to an in-memory index
+  EXPECT_NE(std::string::npos, result.str().find(",t_hash,(a:INTEGER),hash,,,,,,,,,\n")) << result.str();
+  EXPECT_NE(std::string::npos, result.str().find(",t_art,(b:VARCHAR),art,,,1000,,,,,,\n")) << result.str();
+}
+
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeStatsTest, ParallelScanCardinalityTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  auto txn = std::make_unique<Transaction>(0);
+  for (const auto &[table_name, num_rows] : {std::make_pair("small", 1000), std::make_pair("big", 5000)}) {
+    bustub->ExecuteSql(std::string("CREATE TABLE ") + table_name + "(a int);", noop_writer);
+    auto *table_info = bustub->catalog_->GetTable(table_name);
+    for (int32_t i = 0; i < num_rows; i++) {
+      RID rid;
+      ASSERT_TRUE(table_info->table_->InsertTuple(Tuple({Value(TypeId::INTEGER, i)}, &table_info->schema_), &rid,
+                                                  txn.get()));
+    }
+    bustub->ExecuteSql(std::string("CREATE INDEX ") + table_name + "_a ON " + table_name + "(a);", noop_writer);
+  }
+
+  auto optimized_plan = [&](const std::string &table_name) {
+    std::stringstream explain;
+    auto explain_writer = SimpleStreamWriter(explain, true);
+    bustub->ExecuteSql("EXPLAIN SELECT COUNT(*) FROM " + table_name + " WHERE a > 10;", explain_writer);
+    return explain.str().substr(explain.str().find("=== OPTIMIZER ==="));
+  };
+
+  // the entry count of the index decides whether the table is worth splitting among the scan workers
+  EXPECT_NE(std::string::npos, optimized_plan("small").find("IndexOnlyScan"));
+  EXPECT_EQ(std::string::npos, optimized_plan("small").find("parallel="));
+  EXPECT_NE(std::string::npos, optimized_plan("big").find("parallel=4"));
+}
+
+}  // namespace bustub
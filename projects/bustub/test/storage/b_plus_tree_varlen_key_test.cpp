@@ -0,0 +1,331 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_varlen_key_test.cpp
+//
+// Identification: test/storage/b_plus_tree_varlen_key_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+template <size_t KeySize>
+static auto MakeStringKey(const std::string &str, Schema *key_schema) -> GenericKey<KeySize> {
+  GenericKey<KeySize> index_key;
+  index_key.SetFromKey(Tuple({Value(TypeId::VARCHAR, str)}, key_schema), key_schema);
+  return index_key;
+}
+
+// Walk the leaf level from the leftmost leaf; returns the number of leaves.
+template <size_t KeySize>
+static auto CountLeaves(BufferPoolManager *bpm, page_id_t root_page_id) -> int {
+  using InternalPage = BPlusTreeInternalPage<GenericKey<KeySize>, page_id_t, GenericComparator<KeySize>>;
+  page_id_t page_id = root_page_id;
+  while (true) {
+    auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+    if (page->IsLeafPage()) {
+      bpm->UnpinPage(page_id, false);
+      break;
+    }
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(page)->ValueAt(0);
+    bpm->UnpinPage(page_id, false);
+    page_id = child_page_id;
+  }
+  int num_leaves = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    num_leaves++;
+  }
+  return num_leaves;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenKeyTest, PrefixCompressionTest) {
+  auto key_schema = ParseCreateStatement("a varchar(60)");
+  GenericComparator<64> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", bpm.get(), comparator);
+
+  // urls sharing a long prefix, inserted in random order
+  const int num_keys = 3000;
+  std::vector<int> ids(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(15445));
+  auto url = [](int id) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "https://www.example.com/catalog/item-%05d", id);
+    return std::string(buf);
+  };
+  for (int id : ids) {
+    ASSERT_TRUE(tree.Insert(MakeStringKey<64>(url(id), key_schema.get()), RID(0, id)));
+  }
+  EXPECT_FALSE(tree.Insert(MakeStringKey<64>(url(7), key_schema.get()), RID(0, 7)));
+
+  int expected = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    ASSERT_EQ(expected, (*it).second.GetSlotNum());
+    ASSERT_EQ(url(expected), (*it).first.ToValue(key_schema.get(), 0).ToString());
+    expected++;
+  }
+  EXPECT_EQ(num_keys, expected);
+
+  // in place a leaf would hold fewer than LEAF_PAGE_SIZE = 55 of these keys; sharing the prefix, far more fit
+  int num_leaves = CountLeaves<64>(bpm.get(), tree.GetRootPageId());
+  EXPECT_GT(num_keys / num_leaves, 2 * 55) << num_leaves << " leaves";
+
+  // removing most keys merges the leaves back
+  for (int id : ids) {
+    if (id % 10 != 0) {
+      tree.Remove(MakeStringKey<64>(url(id), key_schema.get()));
+    }
+  }
+  for (int id = 0; id < num_keys; id++) {
+    std::vector<RID> result;
+    ASSERT_EQ(id % 10 == 0, tree.GetValue(MakeStringKey<64>(url(id), key_schema.get()), &result)) << url(id);
+  }
+  EXPECT_LT(CountLeaves<64>(bpm.get(), tree.GetRootPageId()), num_leaves);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenKeyTest, LongKeyTest) {
+  auto key_schema = ParseCreateStatement("a varchar(250)");
+  GenericComparator<256> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  BPlusTree<GenericKey<256>, RID, GenericComparator<256>> tree("foo_pk", bpm.get(), comparator);
+
+  // strings from 1 to 250 characters, so pages split and merge by bytes rather than by number of entries
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int> length_dist(1, 250);
+  std::uniform_int_distribution<int> char_dist('a', 'd');
+  std::map<std::string, int> expected;
+  for (int i = 0; i < 4000; i++) {
+    std::string str(length_dist(gen), ' ');
+    for (auto &c : str) {
+      c = static_cast<char>(char_dist(gen));
+    }
+    bool inserted = expected.emplace(str, i).second;
+    ASSERT_EQ(inserted, tree.Insert(MakeStringKey<256>(str, key_schema.get()), RID(0, i)));
+  }
+
+  // remove every other key, then insert some new ones again
+  int i = 0;
+  for (auto it = expected.begin(); it != expected.end(); i++) {
+    if (i % 2 == 0) {
+      tree.Remove(MakeStringKey<256>(it->first, key_schema.get()));
+      it = expected.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (int j = 0; j < 1000; j++) {
+    std::string str(length_dist(gen), 'e');
+    str[0] = static_cast<char>(char_dist(gen));
+    bool inserted = expected.emplace(str, 4000 + j).second;
+    ASSERT_EQ(inserted, tree.Insert(MakeStringKey<256>(str, key_schema.get()), RID(0, 4000 + j)));
+  }
+
+  auto it = tree.Begin();
+  for (const auto &[str, id] : expected) {
+    ASSERT_FALSE(it.IsEnd());
+    ASSERT_EQ(str, (*it).first.ToValue(key_schema.get(), 0).ToString());
+    ASSERT_EQ(id, (*it).second.GetSlotNum());
+    ++it;
+  }
+  EXPECT_TRUE(it.IsEnd());
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenKeyTest, SuffixTruncationTest) {
+  auto key_schema = ParseCreateStatement("a varchar(80),b bigint");
+  GenericComparator<128> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  using Tree = BPlusTree<GenericKey<128>, RID, GenericComparator<128>>;
+  Tree tree("foo_pk", bpm.get(), comparator);
+  Tree bulk_tree("bar_pk", bpm.get(), comparator);
+
+  // composite keys whose leading column differs early but carries a long random tail
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int> char_dist('a', 'z');
+  auto make_key = [&](int id) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%06d/", id);
+    std::string str(buf);
+    while (str.size() < 60) {
+      str += static_cast<char>(char_dist(gen));
+    }
+    GenericKey<128> index_key;
+    index_key.SetFromKey(Tuple({Value(TypeId::VARCHAR, str), Value(TypeId::BIGINT, int64_t{id})}, key_schema.get()),
+                         key_schema.get());
+    return index_key;
+  };
+  const int num_keys = 6000;
+  std::vector<GenericKey<128>> keys;
+  for (int id = 0; id < num_keys; id++) {
+    keys.push_back(make_key(id));
+  }
+  std::vector<int> ids(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), gen);
+  for (int id : ids) {
+    ASSERT_TRUE(tree.Insert(keys[id], RID(0, id)));
+  }
+  int next_id = 0;
+  ASSERT_TRUE(bulk_tree.BulkLoad([&](std::pair<GenericKey<128>, RID> *entry) {
+    if (next_id == num_keys) {
+      return false;
+    }
+    *entry = {keys[next_id], RID(0, next_id)};
+    next_id++;
+    return true;
+  }));
+
+  // separators only keep the leading digits, so an internal page holds many more of them than full keys
+  int fixed_fanout = (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(GenericKey<128>) + sizeof(page_id_t));
+  for (auto *t : {&tree, &bulk_tree}) {
+    BPlusTreeStats stats = t->GetStats();
+    EXPECT_EQ(num_keys, stats.num_entries_);
+    EXPECT_EQ(2, stats.height_);
+    EXPECT_EQ(1, stats.num_internal_pages_);
+    EXPECT_EQ(stats.num_leaf_pages_, stats.num_children_);
+    EXPECT_GT(stats.AverageFanout(), 2 * fixed_fanout);
+    for (int id = 0; id < num_keys; id += 7) {
+      std::vector<RID> result;
+      ASSERT_TRUE(t->GetValue(keys[id], &result));
+      ASSERT_EQ(id, result[0].GetSlotNum());
+    }
+    int expected = 0;
+    for (auto it = t->Begin(); !it.IsEnd(); ++it) {
+      ASSERT_EQ(expected, (*it).second.GetSlotNum());
+      expected++;
+    }
+    EXPECT_EQ(num_keys, expected);
+  }
+
+  // removing keys on both sides of the separators keeps every remaining key reachable
+  for (int id = 0; id < num_keys; id++) {
+    if (id % 3 != 0) {
+      tree.Remove(keys[id]);
+    }
+  }
+  for (int id = 0; id < num_keys; id++) {
+    std::vector<RID> result;
+    ASSERT_EQ(id % 3 == 0, tree.GetValue(keys[id], &result));
+  }
+  EXPECT_EQ((num_keys + 2) / 3, tree.GetStats().num_entries_);
+  EXPECT_EQ(BPlusTreeStats{}.height_, Tree("empty", bpm.get(), comparator).GetStats().height_);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenKeyTest, VarcharIndexTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(name varchar(100), id int);", noop_writer);
+
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 1000; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::VARCHAR, "customer-" + std::to_string(i % 500)), Value(TypeId::INTEGER, i)},
+                &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_name ON t(name);", noop_writer);
+  bustub->ExecuteSql("CREATE INDEX t_name_id ON t(name, id);", noop_writer);
+  EXPECT_EQ(2, bustub->catalog_->GetTableIndexes("t").size());
+
+  std::stringstream explain;
+  auto explain_writer = SimpleStreamWriter(explain, true);
+  bustub->ExecuteSql("EXPLAIN SELECT id FROM t WHERE name = 'customer-42';", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("IndexScan")) << explain.str();
+
+  std::stringstream result;
+  auto result_writer = SimpleStreamWriter(result, true, ",");
+  bustub->ExecuteSql("SELECT id FROM t WHERE name = 'customer-42';", result_writer);
+  EXPECT_EQ("42,\n542,\n", result.str());
+
+  // a key wider than any index entry is refused
+  bustub->ExecuteSql("CREATE TABLE wide(s varchar(300));", noop_writer);
+  EXPECT_THROW(bustub->ExecuteSqlTxn("CREATE INDEX wide_s ON wide(s);", noop_writer, txn.get()),
+               NotImplementedException);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeVarlenKeyTest, OverlongValueTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(name varchar(4), id int);", noop_writer);
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  RID rid;
+  Tuple tuple({Value(TypeId::VARCHAR, "abcd"), Value(TypeId::INTEGER, 0)}, &table_info->schema_);
+  ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  bustub->ExecuteSql("CREATE INDEX t_btree ON t(name);", noop_writer);
+  bustub->ExecuteSql("CREATE INDEX t_hash ON t USING HASH (name);", noop_writer);
+  bustub->ExecuteSql("CREATE INDEX t_art ON t USING ART (name);", noop_writer);
+  ASSERT_EQ(3, bustub->catalog_->GetTableIndexes("t").size());
+
+  // the keys are sized for varchar(4), which values are not held to: a longer value would be truncated to a key it
+  // shares with every value of the same prefix, so it is refused
+  for (auto *index_info : bustub->catalog_->GetTableIndexes("t")) {
+    auto *index = index_info->index_.get();
+    auto make_key = [&](const std::string &str) {
+      return Tuple({Value(TypeId::VARCHAR, str)}, &index_info->key_schema_);
+    };
+    EXPECT_THROW(index->InsertEntry(make_key("abcdefgh"), RID(1, 0), txn.get()), Exception) << index_info->name_;
+    index->InsertEntry(make_key("wxyz"), RID(1, 1), txn.get());
+
+    std::vector<RID> result;
+    index->ScanKey(make_key("wxyz"), &result, txn.get());
+    EXPECT_EQ(std::vector<RID>{RID(1, 1)}, result) << index_info->name_;
+    // looking up a longer value with the prefix of a stored one finds nothing
+    result.clear();
+    index->ScanKey(make_key("abcdefgh"), &result, txn.get());
+    EXPECT_TRUE(result.empty()) << index_info->name_;
+  }
+
+  // nor can an index be created over a table that holds such a value
+  tuple = Tuple({Value(TypeId::VARCHAR, "abcdefgh"), Value(TypeId::INTEGER, 1)}, &table_info->schema_);
+  ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  EXPECT_THROW(bustub->ExecuteSqlTxn("CREATE INDEX t_long ON t(name);", noop_writer, txn.get()), Exception);
+  EXPECT_EQ(nullptr, bustub->catalog_->GetIndex("t_long", "t"));
+}
+
+}  // namespace bustub
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated_test.cpp
+//
+// Identification: test/storage/disk_manager_simulated_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_simulated.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DiskManagerSimulatedTest, ReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  DiskManagerUnlimitedMemory memory;
+  DiskManagerSimulated dm(&memory, SimulatedDiskOptions{});
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  std::memset(buf, 0, sizeof(buf));
+  dm.WritePage(5, data);
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  EXPECT_EQ(dm.GetNumWrites(), 2);
+  EXPECT_EQ(dm.GetNumReads(), 2);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerSimulatedTest, LatencyTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  DiskManagerUnlimitedMemory memory;
+  SimulatedDiskOptions options;
+  options.read_latency_ = {LatencyDistribution::UNIFORM, std::chrono::microseconds(2000),
+                           std::chrono::microseconds(500)};
+  options.write_latency_ = {LatencyDistribution::FIXED, std::chrono::microseconds(1000), {}};
+  DiskManagerSimulated dm(&memory, options);
+
+  const int rounds = 10;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    dm.WritePage(i, data);
+    dm.ReadPage(i, data);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // every request completes no earlier than its lower bound
+  EXPECT_GE(dm.GetSimulatedWriteTime(), rounds * 1000);
+  EXPECT_GE(dm.GetSimulatedReadTime(), rounds * 1500);
+  EXPECT_GE(elapsed, std::chrono::microseconds(rounds * 2500));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerSimulatedTest, QueueDepthTest) {
+  DiskManagerUnlimitedMemory memory;
+  SimulatedDiskOptions options;
+  options.read_latency_ = {LatencyDistribution::FIXED, std::chrono::microseconds(5000), {}};
+  options.queue_depth_ = 2;
+  DiskManagerSimulated dm(&memory, options);
+
+  const int num_threads = 8;
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  for (int i = 0; i < num_threads; i++) {
+    memory.WritePage(i, data);
+  }
+
+  // 8 concurrent reads through 2 slots take at least 4 service times
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&dm, i] {
+      char buf[BUSTUB_PAGE_SIZE];
+      dm.ReadPage(i, buf);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(dm.GetNumReads(), num_threads);
+  EXPECT_GE(elapsed, std::chrono::microseconds(4 * 5000));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerSimulatedTest, BandwidthTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  DiskManagerUnlimitedMemory memory;
+  SimulatedDiskOptions options;
+  // one page per millisecond
+  options.bandwidth_bytes_per_sec_ = BUSTUB_PAGE_SIZE * 1000;
+  DiskManagerSimulated dm(&memory, options);
+
+  const int rounds = 20;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    dm.WritePage(i, data);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_GE(elapsed, std::chrono::microseconds(rounds * 1000));
+}
+
+}  // namespace bustub
@@ -72,6 +72,46 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, IOStatsTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char log[16] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  dm.RegisterExtent(0, 4, IOObject::Table(1));
+  dm.RegisterExtent(4, 4, IOObject::Index(2));
+
+  dm.WritePage(0, buf);
+  dm.WritePage(3, buf);
+  dm.ReadPage(3, buf);
+  dm.WritePage(5, buf);
+  dm.WritePage(8, buf);  // not part of any extent
+  dm.WriteLog(log, sizeof(log));
+
+  auto stats = dm.GetIOStats();
+  ASSERT_EQ(stats.size(), 4);
+  EXPECT_EQ(stats[0].first, IOObject{});
+  EXPECT_EQ(stats[0].second.writes_, 1);
+  EXPECT_EQ(stats[1].first, IOObject::Table(1));
+  EXPECT_EQ(stats[1].second.writes_, 2);
+  EXPECT_EQ(stats[1].second.reads_, 1);
+  EXPECT_EQ(stats[1].second.bytes_written_, 2 * BUSTUB_PAGE_SIZE);
+  EXPECT_EQ(stats[1].second.bytes_read_, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ(stats[2].first, IOObject::Index(2));
+  EXPECT_EQ(stats[2].second.writes_, 1);
+  EXPECT_EQ(stats[3].first.type_, IOObjectType::LOG);
+  EXPECT_EQ(stats[3].second.bytes_written_, sizeof(log));
+
+  uint64_t requests = 0;
+  for (auto count : stats[1].second.latency_histogram_) {
+    requests += count;
+  }
+  EXPECT_EQ(requests, 3);
+  EXPECT_GT(stats[1].second.LatencyPercentile(0.99), 0);
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,244 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_index_test.cpp
+//
+// Identification: test/storage/extendible_hash_index_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/bustub_instance.h"
+#include "execution/execution_engine.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/extendible_hash_table_index.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashIndexTest, InsertScanDeleteTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(64, disk_manager.get());
+  Schema schema{{Column{"k", TypeId::BIGINT}}};
+  auto metadata = std::make_unique<IndexMetadata>("k_idx", "t", &schema, std::vector<uint32_t>{0}, false);
+  ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>> index(std::move(metadata), bpm.get(),
+                                                                           HashFunction<GenericKey<8>>());
+
+  // 1000 keys with 10 entries each fill dozens of buckets
+  const int64_t num_keys = 1000;
+  for (int32_t copy = 0; copy < 10; copy++) {
+    for (int64_t key = 0; key < num_keys; key++) {
+      index.InsertEntry(Tuple({Value(TypeId::BIGINT, key)}, &schema), RID(key, copy), nullptr);
+    }
+  }
+  for (int64_t key = 0; key < num_keys; key++) {
+    std::vector<RID> result;
+    index.ScanKey(Tuple({Value(TypeId::BIGINT, key)}, &schema), &result, nullptr);
+    ASSERT_EQ(10, result.size()) << "key " << key;
+    for (const auto &rid : result) {
+      EXPECT_EQ(key, rid.GetPageId());
+    }
+  }
+
+  // a range of a single key is one lookup, any other range is refused
+  IndexRange range;
+  range.lower_ = Tuple({Value(TypeId::BIGINT, 42)}, &schema);
+  range.upper_ = range.lower_;
+  std::vector<RID> result;
+  std::vector<Tuple> entries;
+  auto scan = index.ScanRange(range, nullptr);
+  ASSERT_TRUE(scan->NextBatch(&result, &entries));
+  EXPECT_EQ(10, result.size());
+  ASSERT_EQ(10, entries.size());
+  EXPECT_EQ(42, entries[0].GetValue(&schema, 0).GetAs<int64_t>());
+  EXPECT_FALSE(scan->NextBatch(&result, &entries));
+  range.upper_ = Tuple({Value(TypeId::BIGINT, 43)}, &schema);
+  EXPECT_THROW(index.ScanRange(range, nullptr), NotImplementedException);
+
+  // delete the odd copies
+  for (int32_t copy = 1; copy < 10; copy += 2) {
+    for (int64_t key = 0; key < num_keys; key++) {
+      index.DeleteEntry(Tuple({Value(TypeId::BIGINT, key)}, &schema), RID(key, copy), nullptr);
+    }
+  }
+  for (int64_t key = 0; key < num_keys; key++) {
+    result.clear();
+    index.ScanKey(Tuple({Value(TypeId::BIGINT, key)}, &schema), &result, nullptr);
+    ASSERT_EQ(5, result.size()) << "key " << key;
+    for (const auto &rid : result) {
+      EXPECT_EQ(0, rid.GetSlotNum() % 2);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashIndexTest, LowCardinalityTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(flag int, v int);", noop_writer);
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 3000; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i % 2), Value(TypeId::INTEGER, i)}, &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  // each of the two keys has far more entries than a bucket holds
+  bustub->ExecuteSql("CREATE INDEX t_flag ON t USING HASH (flag);", noop_writer);
+  auto *index_info = bustub->catalog_->GetIndex("t_flag", "t");
+  ASSERT_NE(nullptr, index_info);
+  for (int32_t flag = 0; flag < 2; flag++) {
+    std::vector<RID> result;
+    index_info->index_->ScanKey(Tuple({Value(TypeId::INTEGER, flag)}, &index_info->key_schema_), &result, nullptr);
+    EXPECT_EQ(1500, result.size());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashIndexTest, UniqueIndexTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(16, disk_manager.get());
+  Schema schema{{Column{"k", TypeId::INTEGER}}};
+  auto metadata = std::make_unique<IndexMetadata>("k_idx", "t", &schema, std::vector<uint32_t>{0}, true);
+  ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>> index(std::move(metadata), bpm.get(),
+                                                                           HashFunction<GenericKey<4>>());
+
+  // the second entry of a key is dropped
+  index.InsertEntry(Tuple({Value(TypeId::INTEGER, 1)}, &schema), RID(1, 0), nullptr);
+  index.InsertEntry(Tuple({Value(TypeId::INTEGER, 1)}, &schema), RID(1, 1), nullptr);
+  std::vector<RID> result;
+  index.ScanKey(Tuple({Value(TypeId::INTEGER, 1)}, &schema), &result, nullptr);
+  EXPECT_EQ(std::vector<RID>{RID(1, 0)}, result);
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashIndexTest, OptimizerTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE t(k int, v int);", noop_writer);
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto txn = std::make_unique<Transaction>(0);
+  for (int32_t i = 0; i < 1000; i++) {
+    RID rid;
+    Tuple tuple({Value(TypeId::INTEGER, i % 100), Value(TypeId::INTEGER, i)}, &table_info->schema_);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+  bustub->ExecuteSql("CREATE INDEX t_k_hash ON t USING HASH (k);", noop_writer);
+  auto *hash_index = bustub->catalog_->GetIndex("t_k_hash", "t");
+  ASSERT_NE(nullptr, hash_index);
+  EXPECT_EQ(IndexType::HashTableIndex, hash_index->index_type_);
+
+  // an equality predicate is a lookup in the hash index, other bounds on the column stay in the filter
+  std::stringstream explain;
+  auto explain_writer = SimpleStreamWriter(explain, true);
+  bustub->ExecuteSql("EXPLAIN SELECT v FROM t WHERE k > 10 AND k = 42;", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("IndexScan { index_oid=0, range=[42, 42] }")) << explain.str();
+  EXPECT_NE(std::string::npos, explain.str().find("Filter { predicate=(#0.0>10) }")) << explain.str();
+
+  std::stringstream result;
+  auto result_writer = SimpleStreamWriter(result, true, ",");
+  bustub->ExecuteSql("SELECT v FROM t WHERE k = 42 AND v < 500;", result_writer);
+  auto rows = result.str();
+  EXPECT_EQ(5, std::count(rows.begin(), rows.end(), '\n')) << rows;
+
+  // ranges and orders need a tree index
+  explain.str("");
+  bustub->ExecuteSql("EXPLAIN SELECT v FROM t WHERE k > 42;", explain_writer);
+  EXPECT_EQ(std::string::npos, explain.str().find("IndexScan")) << explain.str();
+  bustub->ExecuteSql("CREATE INDEX t_k ON t(k);", noop_writer);
+  bustub->ExecuteSql("EXPLAIN SELECT v FROM t WHERE k > 42;", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("IndexScan { index_oid=1, range=(42, +inf] }")) << explain.str();
+  explain.str("");
+  bustub->ExecuteSql("EXPLAIN SELECT v FROM t WHERE k = 42;", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("IndexScan { index_oid=0, range=[42, 42] }")) << explain.str();
+
+  // included columns cannot be stored in a hash index
+  bustub->ExecuteSql("CREATE TABLE u(a int, b int);", noop_writer);
+  auto create_txn = std::make_unique<Transaction>(1);
+  EXPECT_THROW(bustub->ExecuteSqlTxn("CREATE INDEX u_a ON u USING HASH (a) WITH (include = 'b');", noop_writer,
+                                     create_txn.get()),
+               NotImplementedException);
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashIndexTest, IndexJoinTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  auto noop_writer = NoopWriter();
+  bustub->ExecuteSql("CREATE TABLE outer_t(a int);", noop_writer);
+  bustub->ExecuteSql("CREATE TABLE inner_t(k int, v int);", noop_writer);
+
+  // outer keys 0..499, inner keys are the even numbers below 600, twice each
+  auto *outer_info = bustub->catalog_->GetTable("outer_t");
+  auto *inner_info = bustub->catalog_->GetTable("inner_t");
+  auto txn = std::make_unique<Transaction>(0);
+  const int32_t num_outer = 500;
+  RID rid;
+  for (int32_t i = 0; i < num_outer; i++) {
+    ASSERT_TRUE(outer_info->table_->InsertTuple(Tuple({Value(TypeId::INTEGER, i)}, &outer_info->schema_), &rid,
+                                                txn.get()));
+  }
+  for (int32_t copy = 0; copy < 2; copy++) {
+    for (int32_t k = 0; k < 600; k += 2) {
+      Tuple tuple({Value(TypeId::INTEGER, k), Value(TypeId::INTEGER, copy)}, &inner_info->schema_);
+      ASSERT_TRUE(inner_info->table_->InsertTuple(tuple, &rid, txn.get()));
+    }
+  }
+  bustub->ExecuteSql("CREATE INDEX outer_a ON outer_t(a);", noop_writer);
+  bustub->ExecuteSql("CREATE INDEX inner_k ON inner_t USING HASH (k);", noop_writer);
+  auto *inner_index = bustub->catalog_->GetIndex("inner_k", "inner_t");
+
+  std::stringstream explain;
+  auto explain_writer = SimpleStreamWriter(explain, true);
+  bustub->ExecuteSql("EXPLAIN SELECT * FROM outer_t INNER JOIN inner_t ON outer_t.a = inner_t.k;", explain_writer);
+  EXPECT_NE(std::string::npos, explain.str().find("index=inner_k, index_table=inner_t"))
+      << explain.str();
+
+  // the outer tuples are read through the tree index, every one of them is looked up in the hash index
+  std::vector<Column> columns = outer_info->schema_.GetColumns();
+  for (const auto &column : inner_info->schema_.GetColumns()) {
+    columns.push_back(column);
+  }
+  auto outer_scan = std::make_shared<IndexScanPlanNode>(std::make_shared<Schema>(outer_info->schema_),
+                                                        bustub->catalog_->GetIndex("outer_a", "outer_t")->index_oid_);
+  auto join = std::make_shared<NestedIndexJoinPlanNode>(
+      std::make_shared<Schema>(columns), outer_scan, std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER),
+      inner_info->oid_, inner_index->index_oid_, "inner_k", "inner_t", std::make_shared<Schema>(inner_info->schema_),
+      JoinType::INNER);
+  ExecutorContext exec_ctx(txn.get(), bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                           bustub->lock_manager_);
+  std::vector<Tuple> result;
+  ASSERT_TRUE(bustub->execution_engine_->Execute(join, &result, txn.get(), &exec_ctx));
+
+  // the even outer keys match both copies; the hash index returns them in no particular order
+  const auto &output_schema = join->OutputSchema();
+  ASSERT_EQ(num_outer, result.size());
+  for (size_t row = 0; row < result.size(); row += 2) {
+    int32_t a = result[row].GetValue(&output_schema, 0).GetAs<int32_t>();
+    EXPECT_EQ(0, a % 2);
+    EXPECT_EQ(static_cast<int32_t>(row), a);
+    int32_t copies = 0;
+    for (size_t match = row; match < row + 2; match++) {
+      EXPECT_EQ(a, result[match].GetValue(&output_schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(a, result[match].GetValue(&output_schema, 1).GetAs<int32_t>());
+      copies |= 1 << result[match].GetValue(&output_schema, 2).GetAs<int32_t>();
+    }
+    EXPECT_EQ(3, copies);
+  }
+}
+
+}  // namespace bustub
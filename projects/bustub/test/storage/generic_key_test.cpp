@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+// Compare two tuples column by column with Value comparisons, NULL first.
+static auto CompareValues(const Tuple &lhs, const Tuple &rhs, const Schema *schema) -> int {
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    Value lhs_value = lhs.GetValue(schema, i);
+    Value rhs_value = rhs.GetValue(schema, i);
+    if (lhs_value.IsNull() || rhs_value.IsNull()) {
+      if (lhs_value.IsNull() != rhs_value.IsNull()) {
+        return lhs_value.IsNull() ? -1 : 1;
+      }
+      continue;
+    }
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static auto Sign(int x) -> int { return static_cast<int>(x > 0) - static_cast<int>(x < 0); }
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, OrderPreservingTest) {
+  auto key_schema = ParseCreateStatement("a integer,b double,c varchar(8),d smallint");
+  GenericComparator<64> comparator(key_schema.get());
+
+  std::vector<Tuple> tuples;
+  for (int32_t a : {-100000, -1, 0, 1, 70000}) {
+    for (double b : {-2.5, -0.0, 1e-9, 3.25}) {
+      for (const char *c : {"", "a", "ab", "b"}) {
+        for (int16_t d : {int16_t{-300}, int16_t{0}, int16_t{5}}) {
+          tuples.emplace_back(std::vector<Value>{Value(TypeId::INTEGER, a), Value(TypeId::DECIMAL, b),
+                                                 Value(TypeId::VARCHAR, c), Value(TypeId::SMALLINT, d)},
+                              key_schema.get());
+        }
+      }
+    }
+  }
+  // NULLs sort before every other value of their column
+  tuples.emplace_back(std::vector<Value>{ValueFactory::GetNullValueByType(TypeId::INTEGER),
+                                         Value(TypeId::DECIMAL, 0.0), Value(TypeId::VARCHAR, "a"),
+                                         Value(TypeId::SMALLINT, static_cast<int16_t>(0))},
+                      key_schema.get());
+  tuples.emplace_back(std::vector<Value>{Value(TypeId::INTEGER, 0), Value(TypeId::DECIMAL, 0.0),
+                                         ValueFactory::GetNullValueByType(TypeId::VARCHAR),
+                                         Value(TypeId::SMALLINT, static_cast<int16_t>(0))},
+                      key_schema.get());
+
+  std::vector<GenericKey<64>> keys(tuples.size());
+  for (size_t i = 0; i < tuples.size(); i++) {
+    keys[i].SetFromKey(tuples[i], key_schema.get());
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    for (size_t j = 0; j < tuples.size(); j++) {
+      ASSERT_EQ(CompareValues(tuples[i], tuples[j], key_schema.get()), Sign(comparator(keys[i], keys[j])))
+          << tuples[i].ToString(key_schema.get()) << " vs " << tuples[j].ToString(key_schema.get());
+    }
+  }
+
+  // the encoding can be decoded back into the key values
+  for (size_t i = 0; i < tuples.size(); i++) {
+    for (uint32_t col = 0; col < key_schema->GetColumnCount(); col++) {
+      Value expected = tuples[i].GetValue(key_schema.get(), col);
+      Value actual = keys[i].ToValue(key_schema.get(), col);
+      ASSERT_EQ(expected.IsNull(), actual.IsNull());
+      if (!expected.IsNull()) {
+        ASSERT_EQ(CmpBool::CmpTrue, expected.CompareEquals(actual));
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, IntegerKeyTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  std::vector<int64_t> values{INT64_MIN + 1, -(int64_t{1} << 40), -256, -1, 0, 1, 255, 256, int64_t{1} << 40,
+                              INT64_MAX};
+  for (size_t i = 0; i < values.size(); i++) {
+    GenericKey<8> lhs;
+    lhs.SetFromInteger(values[i]);
+    EXPECT_EQ(values[i], lhs.ToString());
+
+    // SetFromInteger agrees with the encoding of a BIGINT key tuple
+    GenericKey<8> from_tuple;
+    from_tuple.SetFromKey(Tuple({Value(TypeId::BIGINT, values[i])}, key_schema.get()), key_schema.get());
+    EXPECT_EQ(0, comparator(lhs, from_tuple));
+
+    for (size_t j = 0; j < values.size(); j++) {
+      GenericKey<8> rhs;
+      rhs.SetFromInteger(values[j]);
+      EXPECT_EQ(Sign(static_cast<int>(i) - static_cast<int>(j)), comparator(lhs, rhs));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, TruncationTest) {
+  auto key_schema = ParseCreateStatement("a varchar(8)");
+  GenericComparator<8> comparator(key_schema.get());
+  auto make_tuple = [&](const std::string &str) { return Tuple({Value(TypeId::VARCHAR, str)}, key_schema.get()); };
+
+  // a varchar takes a marker byte and a two byte terminator: five characters exactly fill a GenericKey<8>
+  GenericKey<8> fits;
+  EXPECT_TRUE(fits.SetFromKey(make_tuple("abcde"), key_schema.get()));
+  EXPECT_EQ("abcde", fits.ToValue(key_schema.get(), 0).ToString());
+  GenericKey<8> empty;
+  EXPECT_TRUE(empty.SetFromKey(make_tuple(""), key_schema.get()));
+  // an escaped '\0' takes two bytes
+  EXPECT_FALSE(empty.SetFromKey(make_tuple(std::string("abcd\0", 5)), key_schema.get()));
+
+  // one more character loses the terminator; strings that fill the key with the same prefix get the same key
+  GenericKey<8> truncated;
+  EXPECT_FALSE(truncated.SetFromKey(make_tuple("abcdef"), key_schema.get()));
+  truncated.SetFromKey(make_tuple("abcdefg"), key_schema.get());
+  GenericKey<8> other;
+  EXPECT_FALSE(other.SetFromKey(make_tuple("abcdefgh"), key_schema.get()));
+  EXPECT_EQ(0, comparator(truncated, other));
+  // but a truncated key never equals a key that fits
+  EXPECT_NE(0, comparator(truncated, fits));
+
+  // with room left for a RID after the key columns, the key columns only get the first key_size bytes
+  GenericKey<16> with_rid;
+  EXPECT_TRUE(with_rid.SetFromKey(make_tuple("abcde"), key_schema.get(), 16 - GenericKey<16>::RID_SIZE));
+  EXPECT_FALSE(with_rid.SetFromKey(make_tuple("abcdef"), key_schema.get(), 16 - GenericKey<16>::RID_SIZE));
+
+  // the payload of included columns reports truncation the same way
+  GenericKey<16> with_payload;
+  EXPECT_TRUE(with_payload.SetPayload({Value(TypeId::VARCHAR, "abcde")}, 8));
+  EXPECT_EQ("abcde", with_payload.PayloadToValue(key_schema.get(), 0, 8).ToString());
+  EXPECT_FALSE(with_payload.SetPayload({Value(TypeId::VARCHAR, "abcdef")}, 8));
+}
+
+}  // namespace bustub